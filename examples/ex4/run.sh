@@ -0,0 +1,3 @@
+#!/bin/sh
+cd ../../build/examples
+./ex4.exe
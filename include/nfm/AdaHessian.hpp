@@ -0,0 +1,65 @@
+#ifndef NFM_ADAHESSIAN_HPP
+#define NFM_ADAHESSIAN_HPP
+
+#include "nfm/NoisyFunMin.hpp"
+
+#include <cstdint>
+
+namespace nfm
+{
+
+// AdaHessian algorithm, based on https://arxiv.org/abs/2006.00719
+//
+// Works like Adam, but instead of squared gradients the second moment is accumulated
+// from an estimate of the Hessian diagonal, which is more reliable under heavy noise.
+// The diagonal is estimated by Hutchinson's method, i.e. diag(H) ~ mean_p z_p * (H z_p)
+// for random Rademacher vectors z_p (entries +-1).
+//
+// NOTE: The target function must be a NoisyFunctionWithHessVec. All probes of a step
+//       are requested by a single hessVecBatch call, which may be overwritten to compute
+//       them in parallel. With spatial averaging (blockSize > 1), the absolute diagonal
+//       estimates are averaged over consecutive blocks of blockSize parameters.
+class AdaHessian: public NFM
+{
+protected:
+    int _nprobes; // number of Hutchinson probes per step
+    double _alpha; // step size
+    double _beta1 = 0.9, _beta2 = 0.999; // decay rates in [0, 1)
+    double _epsilon = 1.e-8; // offset to stabilize division in update
+    double _hessPower = 1.; // power k applied to the root of the second moment, in [0, 1]
+    int _blockSize = 1; // spatial averaging block size
+    uint64_t _seed = 1337; // seed for the probe vectors
+
+    NoisyFunctionWithHessVec * _hfun{}; // the casted target function (valid during findMin)
+
+    // --- Internal methods
+    void _estimateDiagonal(const std::vector<std::vector<double>> &zs, std::vector<NoisyGradient> &Hzs, std::vector<double> &D) const;
+    void _findMin() override;
+
+public:
+    explicit AdaHessian(int ndim, int nprobes = 1, double alpha = 0.1);
+    ~AdaHessian() override = default;
+
+    // Getters
+    int getNProbes() const { return _nprobes; }
+    double getAlpha() const { return _alpha; }
+    double getBeta1() const { return _beta1; }
+    double getBeta2() const { return _beta2; }
+    double getEpsilon() const { return _epsilon; }
+    double getHessPower() const { return _hessPower; }
+    int getBlockSize() const { return _blockSize; }
+    uint64_t getSeed() const { return _seed; }
+
+    // Setters
+    void setNProbes(int nprobes) { _nprobes = std::max(1, nprobes); }
+    void setAlpha(double alpha) { _alpha = std::max(0., alpha); }
+    void setBeta1(double beta1) { _beta1 = std::max(0., std::min(1., beta1)); }
+    void setBeta2(double beta2) { _beta2 = std::max(0., std::min(1., beta2)); }
+    void setEpsilon(double epsilon) { _epsilon = std::max(0., epsilon); }
+    void setHessPower(double hessPower) { _hessPower = std::max(0., std::min(1., hessPower)); }
+    void setBlockSize(int blockSize) { _blockSize = std::max(1, blockSize); }
+    void setSeed(uint64_t seed) { _seed = seed; }
+};
+} // namespace nfm
+
+#endif
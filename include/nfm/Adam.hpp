@@ -3,6 +3,8 @@
 
 #include "nfm/NoisyFunMin.hpp"
 
+#include <memory>
+
 namespace nfm
 {
 
@@ -12,25 +14,76 @@ namespace nfm
 // methods provided by the DynamicDescent class. However,
 // Adam has a more complex update scheme involving second
 // order momentum and it provides an inherent averaging method.
+//
+// Lazy updates: For targets with sparse gradients (NoisyFunctionWithSparseGradient),
+// only the coordinates with non-zero gradient are updated on each step. The decay of
+// the moments (and of the averaged position) during the skipped steps is caught up
+// when a coordinate is touched again, such that the cost per step (including the
+// stopping criteria) scales with the number of non-zeros. NOTE: As in other "lazy Adam"
+// variants, the position doesn't move along the decaying momentum during skipped steps,
+// i.e. this is an approximation.
+//
+// The moments are stored with the precision set by setStatePrecision() (except in lazy mode,
+// which always uses double precision). The running average for averaging is stored at least
+// in float precision, because it directly becomes the result.
+//
+// Factored second moments: If enabled, the second moments of the matrix blocks declared
+// via setParamLayout() are approximated Adafactor-style (https://arxiv.org/abs/1804.04235)
+// by an outer product of exponentially averaged row and column means of the squared
+// gradient, which needs only O(rows + cols) memory per block. The other blocks use the
+// usual full second moments (always in double precision).
+//
+// Checkpoints and continuation (see NFM::setCheckpointing() and NFM::setContinuation()) are
+// supported, except in lazy and factored mode. On continuation, the decay is applied to the
+// moments and to their bias corrections, i.e. the moments keep their magnitude, but the old
+// gradients get the reduced weight decay relative to the new ones.
+// The same holds for the ask/tell interface (see NFM::begin()).
 class Adam: public NFM
 {
 private:
     bool _useAveraging; // use automatic exponential decaying (beta2) parameter averaging, as proposed in the end of Adam paper
-    bool _useAMSGrad; // use the second order momentum update rule of AMSGrad
+    bool _useAMSGrad = false; // use the second order momentum update rule of AMSGrad
+    bool _useLazyUpdates = false; // use lazy sparse updates (requires NoisyFunctionWithSparseGradient)
+    bool _useFactoredV = false; // use factored second moments for matrix blocks of the parameter layout
     double _alpha; // stepsize, default 0.001
     double _beta1 = 0.9, _beta2 = 0.999; // decay rates in [0, 1)
     double _epsilon = 1.e-8; // offset to stabilize division in update
 
+    // Minimization state
+    class FactoredSecondMoment; // see Adam.cpp
+    StateBuffer _m; // first moment
+    StateBuffer _v; // second raw moment
+    StateBuffer _xavg; // running average of the positions (if averaging)
+    std::unique_ptr<FactoredSecondMoment> _fv; // factored second moments (if enabled)
+    double _beta1t = 1., _beta2t = 1.; // stores beta1^t and beta2^t
+    int _iter = 0; // iteration count
+    bool _flag_finalEval = false; // waiting for the value at the averaged position
+
+    // --- Checkpoints / continuation
+    bool _supportsCheckpoints() const override { return !_useLazyUpdates && !_useFactoredV; }
+    void _writeState(StateWriter &out) const override;
+    void _readState(StateReader &in) override;
+    void _decayState(double decay) override;
+    bool _isStateConsistent() const; // does the state fit the configuration?
+    StatePrecision _avgPrecision() const; // precision of the running average (at least float, it becomes the result)
+
     // --- Minimization
+    bool _supportsAskTell() const override { return !_useLazyUpdates; }
+    void _atBegin() override;
+    void _atResult() override;
+    void _requestNextStep(); // count the iteration and request the next evaluation
+    void _findMinLazy();
     void _findMin() override;
 
 public:
     explicit Adam(int ndim, bool useAveraging = false, double alpha = 0.001);
-    ~Adam() override = default;
+    ~Adam() override;
 
     // Getters
     bool usesAveraging() const { return _useAveraging; }
     bool usesAMSGrad() const { return _useAMSGrad; }
+    bool usesLazyUpdates() const { return _useLazyUpdates; }
+    bool usesFactoredSecondMoment() const { return _useFactoredV; }
     double getAlpha() const { return _alpha; }
     double getBeta1() const { return _beta1; }
     double getBeta2() const { return _beta2; }
@@ -39,6 +92,8 @@ public:
     // Setters
     void setAveraging(bool useAveraging) { _useAveraging = useAveraging; }
     void setAMSGrad(bool useAMSGrad) { _useAMSGrad = useAMSGrad; }
+    void setLazyUpdates(bool useLazyUpdates) { _useLazyUpdates = useLazyUpdates; }
+    void setFactoredSecondMoment(bool useFactoredV) { _useFactoredV = useFactoredV; } // not with AMSGrad or lazy updates
     void setAlpha(double alpha) { _alpha = std::max(0., alpha); }
     void setBeta1(double beta1) { _beta1 = std::max(0., std::min(1., beta1)); }
     void setBeta2(double beta2) { _beta2 = std::max(0., std::min(1., beta2)); }
@@ -0,0 +1,84 @@
+#ifndef NFM_CMAES_HPP
+#define NFM_CMAES_HPP
+
+#include "nfm/NoisyFunMin.hpp"
+
+#include <cstdint>
+
+namespace nfm
+{
+
+// Covariance Matrix Adaptation Evolution Strategy (CMA-ES)
+// Based on N. Hansen, "The CMA Evolution Strategy: A Tutorial" (arXiv:1604.00772)
+//
+// Population-based and gradient-free, this method is much less prone to get stuck
+// in local minima of multimodal landscapes. On every generation, the whole population
+// (and, by default, the current distribution mean) is passed as one batch to
+// NoisyFunction::fbatch, so overwriting fbatch allows fully parallel evaluation.
+// The distribution mean is used as current position for the NFM stopping criteria.
+//
+// NOTE 1: The covariance matrix is stored in packed lower-triangular form and sampled
+//         via its Cholesky factor (A^-1 replaces C^-1/2 in the step size path). For large
+//         ndim (thousands) use the separable variant (Ros & Hansen 2008), which adapts
+//         only the diagonal and therefore has O(ndim) cost per sample.
+//
+// NOTE 2: Noise handling (enabled by default) re-evaluates those samples whose values are
+//         statistically indistinguishable from the selection boundary and combines both
+//         estimates. If a large fraction of the ranking remains uncertain afterwards, the
+//         population size is increased (up to a limit) and decreased again once resolved.
+class CMAES: public NFM
+{
+protected:
+    double _sigma0; // initial step size
+    bool _flag_sep; // use the separable (diagonal) variant
+    bool _flag_evalMean = true; // evaluate the distribution mean on every generation (else best sample is used)
+    int _lambda0 = 0; // initial population size (if 0, the default 4+3*ln(ndim) is used)
+    int _maxLambda = 0; // maximal population size for noise handling (if 0, 10 times the initial)
+    bool _flag_noiseHandling = true; // re-evaluate uncertain samples and adapt population size
+    double _reevalFrac = 0.2; // maximal fraction of the population to re-evaluate
+    double _uncertThreshold = 0.1; // grow population if the uncertain fraction is above this threshold
+    double _popGrowth = 1.5; // population growth factor
+    uint64_t _seed = 1337; // seed for the random generator
+
+    // strategy parameters (depend on the current population size)
+    int _lambda{}, _mu{};
+    std::vector<double> _weights;
+    double _mueff{}, _cs{}, _ds{}, _cc{}, _c1{}, _cmu{}, _chiN{};
+
+    // --- Internal methods
+    int _defaultLambda() const;
+    void _setPopulation(int lambda); // sets lambda and (re-)computes all dependent strategy parameters
+    void _findMin() override;
+
+public:
+    explicit CMAES(int ndim, double sigma0 = 0.5, bool separable = false);
+    ~CMAES() override = default;
+
+    // Getters
+    double getSigma0() const { return _sigma0; }
+    bool isSeparable() const { return _flag_sep; }
+    bool usesEvalMean() const { return _flag_evalMean; }
+    int getLambda0() const { return (_lambda0 > 0) ? _lambda0 : this->_defaultLambda(); }
+    int getMaxLambda() const { return (_maxLambda > 0) ? _maxLambda : 10*this->getLambda0(); }
+    int getLambda() const { return _lambda; } // population size of the last run's final generation
+    bool usesNoiseHandling() const { return _flag_noiseHandling; }
+    double getReevalFrac() const { return _reevalFrac; }
+    double getUncertThreshold() const { return _uncertThreshold; }
+    double getPopGrowth() const { return _popGrowth; }
+    uint64_t getSeed() const { return _seed; }
+
+    // Setters
+    void setSigma0(double sigma0) { _sigma0 = (sigma0 > 0.) ? sigma0 : _sigma0; }
+    void setSeparable(bool separable) { _flag_sep = separable; }
+    void setEvalMean(bool evalMean) { _flag_evalMean = evalMean; }
+    void setLambda0(int lambda0) { _lambda0 = (lambda0 > 1) ? lambda0 : 0; } // values < 2 reset to default
+    void setMaxLambda(int maxLambda) { _maxLambda = std::max(0, maxLambda); }
+    void setNoiseHandling(bool noiseHandling) { _flag_noiseHandling = noiseHandling; }
+    void setReevalFrac(double reevalFrac) { _reevalFrac = std::max(0., std::min(1., reevalFrac)); }
+    void setUncertThreshold(double uncertThreshold) { _uncertThreshold = std::max(0., std::min(1., uncertThreshold)); }
+    void setPopGrowth(double popGrowth) { _popGrowth = std::max(1., popGrowth); }
+    void setSeed(uint64_t seed) { _seed = seed; }
+};
+} // namespace nfm
+
+#endif
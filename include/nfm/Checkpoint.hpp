@@ -0,0 +1,127 @@
+#ifndef NFM_CHECKPOINT_HPP
+#define NFM_CHECKPOINT_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace nfm
+{
+
+// Helpers for (binary) checkpoints of the optimizer state, see NFM::setCheckpointing()
+//
+// The state is serialized field by field into a byte buffer, in native byte order.
+// Strings are used as tags to detect mismatching files early. Vectors are stored
+// with their length, which is checked on reading.
+class StateWriter
+{
+private:
+    std::vector<char> _data;
+
+public:
+    template <class T>
+    void write(const T &val)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "[StateWriter] Type must be trivially copyable.");
+        this->writeArray(&val, 1);
+    }
+
+    template <class T>
+    void writeArray(const T * vals, size_t n)
+    {
+        const auto * bytes = reinterpret_cast<const char *>(vals);
+        _data.insert(_data.end(), bytes, bytes + n*sizeof(T));
+    }
+
+    void write(const std::vector<double> &vec); // length and values
+    void write(const std::vector<int> &vec);
+    void write(const std::string &str); // length and characters (e.g. a tag)
+
+    std::vector<char> &data() { return _data; }
+};
+
+class StateReader
+{
+private:
+    const std::vector<char> &_data;
+    size_t _pos = 0; // read position
+
+public:
+    explicit StateReader(const std::vector<char> &data): _data(data) {}
+
+    template <class T>
+    void readArray(T * vals, size_t n)
+    {
+        if (n*sizeof(T) > _data.size() - _pos) {
+            throw std::invalid_argument("[StateReader] Unexpected end of checkpoint data.");
+        }
+        std::memcpy(vals, _data.data() + _pos, n*sizeof(T));
+        _pos += n*sizeof(T);
+    }
+
+    template <class T>
+    T read()
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "[StateReader] Type must be trivially copyable.");
+        T val;
+        this->readArray(&val, 1);
+        return val;
+    }
+
+    uint64_t readLength(); // length prefix of vectors/strings (checked against the remaining data)
+    void read(std::vector<double> &vec); // resizes vec
+    void read(std::vector<int> &vec);
+    void read(std::vector<double> &vec, size_t n); // throws if the stored length is not n
+    std::string readString();
+    void expectTag(const std::string &tag); // throws if the next string is not tag
+
+    bool atEnd() const { return _pos == _data.size(); }
+};
+
+
+// Writes files in a background thread, so the caller isn't stalled by I/O
+//
+// The data is first written to "<path>.tmp", which is then renamed to path, so an existing
+// file is never left in a partially written state. If a new write is requested before the
+// previous one has started, only the newest data is written. Errors of the background
+// thread are rethrown by the next call to write() or flush().
+class AsyncFileWriter
+{
+private:
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _cvWork, _cvDone;
+
+    std::string _path; // path of the pending data
+    std::vector<char> _pending; // data to be written next
+    bool _flag_pending = false;
+    bool _flag_busy = false; // background thread is writing
+    bool _flag_quit = false;
+    std::exception_ptr _error; // error of the last failed write
+
+    void _writerLoop();
+    void _rethrowError(); // call with locked mutex
+
+public:
+    AsyncFileWriter();
+    ~AsyncFileWriter(); // waits for pending writes (errors are dropped)
+
+    AsyncFileWriter(const AsyncFileWriter &) = delete;
+    AsyncFileWriter &operator=(const AsyncFileWriter &) = delete;
+
+    void write(const std::string &path, std::vector<char> &&data); // returns immediately
+    void flush(); // wait until all data is written
+
+    static void writeFile(const std::string &path, const std::vector<char> &data); // blocking version (throws on failure)
+    static std::vector<char> readFile(const std::string &path); // throws on failure
+};
+} // namespace nfm
+
+#endif
@@ -4,6 +4,8 @@
 #include "nfm/NoisyFunMin.hpp"
 #include "nfm/LineSearch.hpp"
 
+#include <memory>
+
 namespace nfm
 {
 
@@ -20,19 +22,56 @@ enum class CGMode
 // Useful when gradients are expensive to compute
 // and the noise is moderate. In such cases it might
 // be the fastest optimization method in this library.
+// Checkpoints and continuation (see NFM::setCheckpointing() and NFM::setContinuation())
+// are supported. On continuation, the first new direction is the new gradient plus the decayed
+// old direction (Fletcher-Reeves) or just the new gradient (Polak-Ribiere).
+// With the ask/tell interface (see NFM::begin()), the line searches are performed by the
+// resumable LineSearch class, visiting the same positions as multiLineMin.
 class ConjGrad: public NFM
 {
 protected:
     CGMode _cgmode; // which gradients to use
     MLMParams _mlmParams;  // line search configuration (see LineSearch.hpp)
 
+    // Minimization state
+    std::vector<double> _conjv; // the conjugate vectors
+    std::vector<double> _gradold; // the previous inverted gradients (only used for Polak-Ribiere CG)
+    double _gdot_old = 0.; // the denominator of CG update ratio
+    int _iter = 0; // iteration count
+
+    // Ask/tell state
+    enum class Phase
+    {
+        InitGrad, /* initial value and gradient */
+        RefreshGrad, /* value and gradient on continuation */
+        Grad, /* new gradient */
+        Line /* line search along the conjugate vectors */
+    };
+    Phase _phase = Phase::InitGrad;
+    std::unique_ptr<LineSearch> _lineSearch; // the running line search
+    std::vector<double> _xline; // position on the line
+
+    // --- Checkpoints / continuation
+    bool _supportsCheckpoints() const override { return true; }
+    void _writeState(StateWriter &out) const override;
+    void _readState(StateReader &in) override;
+    void _decayState(double decay) override;
+    bool _isStateConsistent() const; // does the state fit the configuration?
+
     // --- Internal methods
-    bool _computeGradient(bool flag_value);
-    void _findNextX(const std::vector<double> &dir); // do line-search
+    bool _checkGradient(); // log the new gradient and check if it is only noise (returns false if we are done)
+    void _updateDirection(); // compute the next direction to follow
+    bool _beginStep(); // check stopping and count the iteration (returns false if we are done)
+    void _requestNextStep(); // begin the next step and request its gradient
+    void _beginLineSearch(); // start line-search along the conjugate vectors
+    void _requestLinePoint(); // request the next position of the line-search
     void _writeCGDirectionToLog(const std::vector<double> &dir, const std::string &name) const;
 
     // --- Minimization
-    void _findMin() override; // perform noisy CG minimization
+    bool _supportsAskTell() const override { return true; }
+    void _atBegin() override;
+    void _atResult() override;
+    void _findMin() override { this->_findMinAskTell(); } // perform noisy CG minimization
 
 public:
     explicit ConjGrad(int ndim, CGMode cgmode = CGMode::CGFR, MLMParams params = defaultMLMParams());
@@ -19,6 +19,24 @@ enum class DDMode
 //
 // All contained algorithms provide some kind of adaptive learning rate,
 // controlled by a base or initial step size and up to one "beta" parameter.
+//
+// Lazy updates: For targets with sparse gradients (NoisyFunctionWithSparseGradient),
+// the SGDM, AdaGrad and RMSProp modes can update only the coordinates with non-zero
+// gradient on each step. What happened during skipped steps (decay of v and, for SGDM,
+// the movement along the decaying momentum) is caught up in closed form when a coordinate
+// is touched again, so the cost per step scales with the number of non-zeros (the stopping
+// criteria are evaluated from the touched coordinates as well). Only averaging adds O(ndim)
+// work per step, because it needs the positions of the last steps in the old value list.
+// NOTE: For AdaGrad and RMSProp this is exactly the dense algorithm. With SGDM, the target
+//       is evaluated at positions that lack the pending momentum moves of untouched coordinates,
+//       which are applied only at the end (followed by a final target evaluation).
+//
+// The state vectors (v, and w for AdaDelta) are stored with the precision set by
+// setStatePrecision(), except in lazy mode which always uses double precision.
+//
+// Checkpoints and continuation (see NFM::setCheckpointing() and NFM::setContinuation())
+// are supported, except in lazy mode. On continuation, the decay is applied to v and w.
+// The same holds for the ask/tell interface (see NFM::begin()).
 class DynamicDescent: public NFM
 {
 protected:
@@ -27,10 +45,30 @@ protected:
     double _stepSize; // step size factor / learning rate
     double _beta = 0.9; // momenta update parameter (not used in AdaGrad)
     double _epsilon = 1.e-8; // small value to prevent bad division (not used in SGDM)
+    bool _useLazyUpdates = false; // use lazy sparse updates (requires NoisyFunctionWithSparseGradient)
+
+    // Minimization state
+    StateBuffer _v; // helper vector used by all methods
+    StateBuffer _w; // only used by AdaDelta
+    int _iter = 0; // iteration count
+    bool _flag_finalEval = false; // waiting for the value at the averaged position
+
+    // --- Checkpoints / continuation
+    bool _supportsCheckpoints() const override { return !_useLazyUpdates; }
+    void _writeState(StateWriter &out) const override;
+    void _readState(StateReader &in) override;
+    void _decayState(double decay) override;
+    bool _isStateConsistent() const; // does the state fit the configuration?
 
     // --- Internal methods
-    void _updateTarget();
-    void _findNextX(int iter, std::vector<double> &v, std::vector<double> &w);
+    void _requestNextStep(); // count the iteration and request the next evaluation
+    void _findNextX(int iter, StateBuffer &v, StateBuffer &w);
+    void _findNextXBlock(int iter, size_t b0, size_t n, double * v, double * w); // update of n elements, starting from b0
+    void _catchUp(size_t i, int k, std::vector<double> &v); // catch up k skipped steps of coordinate i (lazy)
+    void _findMinLazy();
+    bool _supportsAskTell() const override { return !_useLazyUpdates; }
+    void _atBegin() override;
+    void _atResult() override;
     void _findMin() override;
 
 public:
@@ -50,11 +88,13 @@ public:
     bool usesAveraging() const { return _useAveraging; }
     double getStepSize() const { return _stepSize; }
     double getBeta() const { return _beta; }
+    bool usesLazyUpdates() const { return _useLazyUpdates; }
 
     // Setters
     void setAveraging(bool useAveraging) { _useAveraging = useAveraging; }
     void setStepSize(double stepSize) { _stepSize = std::max(0., stepSize); }
     void setBeta(double beta) { _beta = std::max(0., std::min(1., beta)); }
+    void setLazyUpdates(bool useLazyUpdates) { _useLazyUpdates = useLazyUpdates; }
 };
 } // namespace nfm
 
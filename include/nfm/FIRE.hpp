@@ -5,6 +5,7 @@
 #include "nfm/MDIntegrators.hpp"
 
 #include <algorithm>
+#include <string>
 
 namespace nfm
 {
@@ -23,6 +24,18 @@ namespace nfm
 //       mechanism (freezing only the "offending" velocity elements) and finally you
 //       have the ability to set a minimal time step together with a number of steps
 //       to stay at that limit before terminating.
+//
+// FIRE 2.0: Optionally, the modifications by Guenole et al. (https://doi.org/10.1016/j.commatsci.2020.109584)
+//       can be enabled via useFIRE2(). Then the velocity mixing is done within the MD step, right
+//       after the first velocity update, on uphill steps the frozen parameters are moved back by
+//       half a step (-0.5*dt*v), the time step is not decreased during the first Nwait steps (if
+//       initial delay is on) and we stop after NnegMax consecutive uphill steps. The paper
+//       recommends semi-implicit Euler integration, Nwait = 20 and alpha0 = 0.25.
+//
+// Checkpoints and continuation (see NFM::setCheckpointing() and NFM::setContinuation()) are
+// supported. On continuation, the decay is applied to the velocity, while time step and mixing
+// factor are kept (i.e. there is no new ramp-up of dt). The ask/tell interface (see NFM::begin())
+// is supported as well, with the MD steps split into stages around the force updates.
 class FIRE: public NFM
 {
 protected:
@@ -44,11 +57,60 @@ protected:
     bool _flag_fullFreeze = true; // set to false if you want to use selective instead of global (original) freezing
     std::vector<double> _mi; // inverse masses (default all 1)
 
+    // FIRE 2.0 parameters
+    bool _flag_fire2 = false; // use the FIRE 2.0 modifications
+    bool _flag_initialDelay = true; // FIRE 2.0: don't decrease dt during the first Nwait steps
+    int _NnegMax = 2000; // FIRE 2.0: stop after this many consecutive uphill steps (disabled if 0)
+
+    // Minimization state
+    std::vector<double> _v; // velocity vector
+    std::vector<double> _a; // acceleration vector (F*mi)
+    double _dt = 0.; // current time-step
+    double _alpha = 0.; // current mixing factor
+    int _Npos = 0; // number of steps since "F.v" was negative
+    int _Nneg = 0; // number of steps since "F.v" was positive
+    int _Nmin = 0; // number of steps since dt = dtmin
+    int _iter = 0; // iteration count
+
+    // Ask/tell state
+    enum class Phase
+    {
+        Init, /* initial force update */
+        Refresh, /* force update on continuation */
+        MDStep /* force updates of the MD step */
+    };
+    Phase _phase = Phase::Init;
+    int _mdStage = 0; // stage of the running MD step (see md::doMDStage())
+    int _mdNUpdates = 1; // force updates per MD step of the resolved integrator
+    void (FIRE::*_mdStageFun)(int) = nullptr; // MD stage function, resolved in _atBegin() (see _resolveMDStage())
+    std::string _logName = "FIRE"; // name used in log messages (of derived classes)
+
+    // --- Checkpoints / continuation
+    bool _supportsCheckpoints() const override { return true; }
+    void _writeState(StateWriter &out) const override;
+    void _readState(StateReader &in) override;
+    void _decayState(double decay) override;
+    virtual void _initializeState(); // set the state variables for a new minimization
+    virtual bool _isStateConsistent() const { return _v.size() == _grad.size() && _a.size() == _grad.size(); }
+
     // --- Internal methods
-    bool _initializeMD(md::MDView &view, double dt);
-    void _updateTarget(md::MDView &view, double dt);
+    bool _initializeMD(std::vector<double> &v, const std::vector<double> &a, double dt); // call after initial force update
     bool _isNDtMinReached(int Nmin);
-    void _findMin() override;
+    bool _isNNegMaxReached(int Nneg);
+    void _mixVelocity(std::vector<double> &v, const std::vector<double> &a, double alpha) const;
+
+    virtual void _updateForce(); // compute the accelerations from the new gradient
+    virtual bool _processMDStep(); // FIRE logic after a completed MD step (returns false if we are done)
+    void _beginMDStep(); // count the iteration and start the next MD step
+    void _resolveMDStage(); // select the MD stage function according to integrator and FIRE 2.0 mode
+    template <md::Integrator MDI, bool FIRE2>
+    void _doMDStage(int stage); // MD integrator stage (in FIRE 2.0 mode with velocity mixing)
+
+    // --- Minimization
+    bool _supportsAskTell() const override { return true; }
+    void _atBegin() override;
+    void _atResult() override;
+    void _findMin() override { this->_findMinAskTell(); }
 
 public:
     explicit FIRE(int ndim, double dtmax, double dt0 = 0. /*will be set to 0.1*dtmax*/);
@@ -69,6 +131,10 @@ public:
     md::Integrator getMDIntegrator() const { return _mdi; }
     bool getFullFreeze() const { return _flag_fullFreeze; }
 
+    bool usesFIRE2() const { return _flag_fire2; }
+    bool getInitialDelay() const { return _flag_initialDelay; }
+    int getNNegMax() const { return _NnegMax; }
+
     // Setters
     void setDt0(double dt0) { _dt0 = std::max(_dtmin, std::min(_dtmax, dt0)); }
     void setDtMax(double dtmax) { _dtmax = std::max(_dt0, dtmax); }
@@ -86,6 +152,10 @@ public:
     void setSelectiveFreeze() { _flag_fullFreeze = false; }
     void setMasses(const std::vector<double> &m);
     void resetMasses() { std::fill(_mi.begin(), _mi.end(), 1.); }
+
+    void useFIRE2(bool useFIRE2 = true) { _flag_fire2 = useFIRE2; }
+    void setInitialDelay(bool initialDelay) { _flag_initialDelay = initialDelay; }
+    void setNNegMax(int NnegMax) { _NnegMax = std::max(0, NnegMax); }
 };
 } // namespace nfm
 
@@ -20,17 +20,33 @@ namespace nfm
 // gradient for the MD dynamics. The amount of mix-in is decided by the Signal-To-Noise
 // ratio of gradient values. This allows to retain the very stiff and reactive dynamics
 // of the original optimizer, but gains the ability to progress when gradients are noisy.
+// The averaged gradient is stored with the precision set by setStatePrecision().
+// Checkpoints, continuation and the ask/tell interface (see NFM::setCheckpointing(),
+// NFM::setContinuation() and NFM::begin()) are supported. On continuation, the decay is applied
+// to velocity and averaged acceleration.
 //
 class IRENE: public FIRE // reuse some members from FIRE
 {
 private:
     double _beta = 0.; // exponential averaging factor for averaged acceleration
 
+    // Minimization state (in addition to FIRE's)
+    std::vector<double> _aerr; // acceleration errors
+    StateBuffer _ma; // moving average acceleration
+
+    // --- Checkpoints / continuation
+    void _writeState(StateWriter &out) const override;
+    void _readState(StateReader &in) override;
+    void _decayState(double decay) override;
+    bool _isStateConsistent() const override;
+    void _initializeState() override;
+
     // --- Internal methods
-    void _findMin() override;
+    void _updateForce() override; // also updates the errors and the averaged acceleration
+    bool _processMDStep() override;
 
 public:
-    explicit IRENE(int ndim, double dtmax, double dt0 = 0.): FIRE(ndim, dtmax, dt0) {}
+    explicit IRENE(int ndim, double dtmax, double dt0 = 0.): FIRE(ndim, dtmax, dt0) { _logName = "IRENE"; }
 
     // Getters
     double getBeta() const { return _beta; }
@@ -0,0 +1,70 @@
+#ifndef NFM_LEVENBERGMARQUARDT_HPP
+#define NFM_LEVENBERGMARQUARDT_HPP
+
+#include "nfm/NoisyFunMin.hpp"
+#include "nfm/NoisyResidualFunction.hpp"
+
+namespace nfm
+{
+
+// Levenberg-Marquardt Minimization of noisy least-squares problems
+//
+// Requires a NoisyResidualFunction as target. Every step solves the damped
+// normal equations of the weighted Gauss-Newton problem,
+//     (J^T W J + mu * D) * delta = -J^T W r ,
+// where the weights W = diag(1/err_k^2) are taken from the residual errors
+// and D is either diag(J^T W J) (Marquardt, default) or the identity (Levenberg).
+// The damping mu is adapted according to the gain ratio of the actual and
+// predicted reduction of the weighted sum of squares (Nielsen's strategy).
+//
+// NOTE: The residual errors are used as weights only if all of them are positive,
+//       else all residuals are weighted equally. The normal matrix is accumulated
+//       row by row from J and factorized by an in-place dense Cholesky decomposition.
+//       Stopping is done by the usual NFM criteria, plus when the damping exceeds
+//       its maximum (i.e. no improving step can be found anymore).
+class LevenbergMarquardt: public NFM
+{
+protected:
+    double _damping0 = 1.e-3; // initial damping factor
+    double _maxDamping = 1.e12; // stop when damping exceeds this value
+    bool _flag_marquardt = true; // scale damping with the diagonal of J^T W J
+    bool _flag_weighted = true; // use residual errors as weights
+
+    NoisyResidualFunction * _resfun{}; // the casted target function (valid during findMin)
+
+    // work buffers
+    std::vector<NoisyValue> _res, _rest; // current and trial residuals
+    std::vector<double> _jac; // current Jacobian (row-major nres*ndim)
+    std::vector<double> _w; // residual weights
+    std::vector<double> _A; // lower triangle of J^T W J (row-major ndim*ndim)
+    std::vector<double> _L; // Cholesky factor of damped normal matrix
+    std::vector<double> _b; // right hand side -J^T W r
+    std::vector<double> _delta; // step
+
+    // --- Internal methods
+    void _computeWeights();
+    NoisyValue _weightedSumOfSquares(const std::vector<NoisyValue> &r) const;
+    void _buildNormalEquations();
+    double _dampingDiag(size_t i) const;
+    bool _solveDamped(double mu); // solve for _delta, returns false if not positive definite
+    void _findMin() override;
+
+public:
+    explicit LevenbergMarquardt(int ndim, double damping0 = 1.e-3);
+    ~LevenbergMarquardt() override = default;
+
+    // Getters
+    double getDamping0() const { return _damping0; }
+    double getMaxDamping() const { return _maxDamping; }
+    bool usesMarquardtScaling() const { return _flag_marquardt; }
+    bool usesWeights() const { return _flag_weighted; }
+
+    // Setters
+    void setDamping0(double damping0) { _damping0 = (damping0 > 0.) ? damping0 : _damping0; }
+    void setMaxDamping(double maxDamping) { _maxDamping = std::max(_damping0, maxDamping); }
+    void setMarquardtScaling(bool useMarquardt) { _flag_marquardt = useMarquardt; }
+    void setWeights(bool useWeights) { _flag_weighted = useWeights; }
+};
+} // namespace nfm
+
+#endif
@@ -4,6 +4,7 @@
 #include "nfm/FunProjection1D.hpp"
 #include "nfm/NoisyValue.hpp"
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -45,6 +46,10 @@ namespace nfm
 //             But if the left step is passed as 0, the known function value passed via p0Pair
 //             will be used as function value for the lower boundary at 0 (to save an evaluation).
 //
+// The algorithms are implemented as resumable state machines by the classes BracketSearch,
+// BrentSearch and LineSearch (1D part of multiLineMin), see below. The functions are blocking
+// wrappers that simply drive these objects with the passed function.
+//
 
 // Global values to use in 1D Algos
 namespace m1d_detail
@@ -106,6 +111,100 @@ NoisyIOPair1D brentMin(NoisyFunction &f1d, NoisyBracket bracket, int maxNIter, d
 // Returns the previous state if minimization was not successful
 NoisyIOPair multiLineMin(NoisyFunction &mdf, NoisyIOPair p0Pair, const std::vector<double> &dir, MLMParams params = defaultMLMParams());
 // ^minimized IO Pair                  ^multi-dim fun    ^last value with point            ^direction      ^configuration
+
+
+// --- Resumable Line-Search Classes
+
+// State machine versions of the functions above, for callers that evaluate the function themselves
+// (e.g. the ask/tell interface of ConjGrad). Call nextPoint() to get the next position to evaluate and
+// report() its function value, until nextPoint() returns false. The evaluated positions and the results
+// are the same as with the functions. The objects are independent of each other, so one event loop
+// may drive many searches at once (e.g. with the evaluations running asynchronously). Calling report()
+// on a finished search throws.
+
+// Resumable findBracket
+class BracketSearch
+{
+private:
+    NoisyBracket _bracket; // current bracket
+    int _maxNIter; // iteration limit
+    double _epsx; // bracket size tolerance
+    int _iter = 0; // iteration count
+    bool _flag_pre = true; // are we in the pre-processing (scale up) loop?
+    bool _flag_nextC = false; // is the pending point c (else b)?
+    bool _flag_done = false;
+    bool _flag_success = false;
+    const char * _stepName = ""; // log key of the pending step
+
+    void _advance(); // prepare the next point or finish
+    void _finish(bool success);
+
+public:
+    BracketSearch(const NoisyBracket &bracket, int maxNIter, double epsx = m1d_detail::STD_XTOL); // see findBracket (throws on invalid x)
+
+    bool nextPoint(double &x) const; // get the next position (returns false if finished)
+    void report(NoisyValue f); // function value at the position of nextPoint()
+
+    bool isDone() const { return _flag_done; }
+    bool isSuccess() const { return _flag_success; } // valid bracket found (when done)
+    const NoisyBracket &getBracket() const { return _bracket; }
+};
+
+// Resumable brentMin
+class BrentSearch
+{
+private:
+    enum class Phase { Init, Step, Final, Done };
+
+    NoisyBracket _bracket; // lower bound a, best point b, upper bound c
+    int _maxNIter; // iteration limit
+    double _epsx, _epsf; // tolerances
+    Phase _phase = Phase::Init;
+    int _iter = 0; // iteration count
+    double _d = 0., _e = 0.; // step helpers
+    NoisyIOPair1D _v{}, _w{}, _u{}; // helper points, u is the pending one
+    bool _flag_parab = false; // was parabolic fit used for u
+
+    void _advance(); // prepare the next point or finish
+    void _updateBracket(); // process the new point u
+
+public:
+    BrentSearch(const NoisyBracket &bracket, int maxNIter, double epsx = m1d_detail::STD_XTOL, double epsf = m1d_detail::STD_FTOL); // see brentMin (throws on invalid bracket)
+
+    bool nextPoint(double &x) const; // get the next position (returns false if finished)
+    void report(NoisyValue f); // function value at the position of nextPoint()
+
+    bool isDone() const { return _phase == Phase::Done; }
+    const NoisyIOPair1D &getResult() const { return _bracket.b; } // minimum (when done)
+};
+
+// Resumable multiLineMin, in the coordinate t along the line (i.e. at p0 + t*dir)
+class LineSearch
+{
+private:
+    enum class Phase { InitA, InitB, InitC, Bracket, Brent, Recompute, Done };
+
+    MLMParams _params; // configuration
+    NoisyValue _f0; // function value at t = 0
+    NoisyBracket _bracket{}; // initial bracket
+    Phase _phase;
+    std::unique_ptr<BracketSearch> _bracketSearch;
+    std::unique_ptr<BrentSearch> _brentSearch;
+    NoisyIOPair1D _result{};
+    bool _flag_success = false;
+
+    void _checkBracketSearch(); // continue with Brent if the bracket search is done
+
+public:
+    LineSearch(NoisyValue f0, MLMParams params = defaultMLMParams()); // f0: known value at t = 0 (throws on invalid steps)
+
+    bool nextPoint(double &t) const; // get the next position (returns false if finished)
+    void report(NoisyValue f); // function value at the position of nextPoint()
+
+    bool isDone() const { return _phase == Phase::Done; }
+    bool isSuccess() const { return _flag_success; } // was a new minimum accepted (when done)?
+    const NoisyIOPair1D &getResult() const { return _result; } // new minimum, or t = 0 with recomputed value
+};
 } // namespace nfm
 
 #endif
@@ -0,0 +1,71 @@
+#ifndef NFM_LINEARMETHOD_HPP
+#define NFM_LINEARMETHOD_HPP
+
+#include "nfm/NoisyFunMin.hpp"
+
+namespace nfm
+{
+
+// Linear Method Minimization (Umrigar, Toulouse et al. 2007)
+//
+// The standard optimizer for variational Monte Carlo wave functions. On every step,
+// the sampled Hamiltonian and overlap matrices H and S in the basis of the current
+// state and its parameter derivatives are used to solve the generalized eigenproblem
+//     (H + a*D) * c = E * S * c ,   with D = diag(0, 1, ..., 1) ,
+// and the parameters are updated by dx_i = c_i/c_0 . Usually only 5-10 iterations
+// are needed, where SGD-like methods need hundreds.
+//
+// NOTE 1: The target function must be a NoisyFunctionWithHSMatrices. The eigenvector
+//         connected to the current state is found by Rayleigh quotient iteration started
+//         from c = (1, 0, ..., 0), using a dense LU decomposition with partial pivoting
+//         (H may be non-symmetric). The cost is O(ndim^3) per solve.
+// NOTE 2: The stabilization shift a is adapted by a line search on a logarithmic grid:
+//         On every step, the updates for the shifts a/r, a, a*r are evaluated (via fbatch),
+//         the lowest target value is chosen (on ties within noise, the largest shift),
+//         and a is moved to the vertex of the parabola through the three (log a, f) points.
+//         If no update improves on the current value within noise, the shifts are
+//         increased by r^2, until the maximal shift is exceeded (then we stop).
+class LinearMethod: public NFM
+{
+protected:
+    double _shift0; // initial stabilization shift
+    double _shiftRatio = 10.; // ratio r between the shifts tried per step
+    double _minShift = 1.e-8; // lower limit for the shift
+    double _maxShift = 1.e6; // upper limit for the shift (stop when exceeded)
+    double _maxStepNorm = 0.; // reject updates with larger norm (if > 0)
+    int _maxNEigIter = 20; // maximal number of Rayleigh quotient iterations
+
+    NoisyFunctionWithHSMatrices * _hsfun{}; // the casted target function (valid during findMin)
+
+    // work buffers
+    std::vector<double> _H, _S; // sampled matrices (row-major (ndim+1)^2)
+    std::vector<double> _M; // shifted pencil H + a*D - lambda*S and its LU decomposition
+    std::vector<size_t> _piv; // LU pivot indices
+
+    // --- Internal methods
+    bool _solveShifted(double shift, std::vector<double> &dx); // returns false if the update is unusable
+    void _findMin() override;
+
+public:
+    explicit LinearMethod(int ndim, double shift0 = 0.01);
+    ~LinearMethod() override = default;
+
+    // Getters
+    double getShift0() const { return _shift0; }
+    double getShiftRatio() const { return _shiftRatio; }
+    double getMinShift() const { return _minShift; }
+    double getMaxShift() const { return _maxShift; }
+    double getMaxStepNorm() const { return _maxStepNorm; }
+    int getMaxNEigIter() const { return _maxNEigIter; }
+
+    // Setters
+    void setShift0(double shift0) { _shift0 = (shift0 > 0.) ? shift0 : _shift0; }
+    void setShiftRatio(double shiftRatio) { _shiftRatio = (shiftRatio > 1.) ? shiftRatio : _shiftRatio; }
+    void setMinShift(double minShift) { _minShift = (minShift > 0.) ? minShift : _minShift; }
+    void setMaxShift(double maxShift) { _maxShift = std::max(_minShift, maxShift); }
+    void setMaxStepNorm(double maxStepNorm) { _maxStepNorm = std::max(0., maxStepNorm); }
+    void setMaxNEigIter(int maxNEigIter) { _maxNEigIter = std::max(1, maxNEigIter); }
+};
+} // namespace nfm
+
+#endif
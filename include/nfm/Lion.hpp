@@ -0,0 +1,69 @@
+#ifndef NFM_LION_HPP
+#define NFM_LION_HPP
+
+#include "nfm/NoisyFunMin.hpp"
+
+namespace nfm
+{
+
+// Lion (sign momentum) algorithm, based on https://arxiv.org/abs/2302.06675
+//
+// Every coordinate moves by exactly +-stepSize per step, in the direction of the sign
+// of an interpolation between momentum and current gradient. In contrast to Adam, only
+// one momentum vector is kept, which halves the memory needed by the optimizer state.
+//
+// Noisy freezing: If the target provides gradient errors, coordinates where the sign of
+// the interpolated momentum is not resolved within the NoisyValue sigma level are frozen
+// for the step (as in IRENE). The error of the momentum is estimated from the current
+// gradient errors, assuming stationary and uncorrelated noise.
+//
+// Since the steps don't shrink close to the minimum, it is recommended to use averaging
+// or a decreasing step size (e.g. via policy). Checkpoints, continuation and the ask/tell
+// interface (see NFM::setCheckpointing(), NFM::setContinuation() and NFM::begin()) are supported.
+class Lion: public NFM
+{
+private:
+    bool _useAveraging; // use the averaged positions of the old value list (length max_n_const_values) as end result
+    bool _useNoisyFreeze = true; // freeze coordinates with unresolved sign (if gradient errors are available)
+    double _stepSize; // step size per coordinate, default 0.0001
+    double _beta1 = 0.9, _beta2 = 0.99; // interpolation and momentum decay rates in [0, 1)
+
+    // Minimization state
+    StateBuffer _m; // momentum
+    int _iter = 0; // iteration count
+    bool _flag_finalEval = false; // waiting for the value at the averaged position
+
+    // --- Checkpoints / continuation
+    bool _supportsCheckpoints() const override { return true; }
+    void _writeState(StateWriter &out) const override;
+    void _readState(StateReader &in) override;
+    void _decayState(double decay) override { _m.scale(decay); }
+
+    // --- Minimization
+    bool _supportsAskTell() const override { return true; }
+    void _atBegin() override;
+    void _atResult() override;
+    void _requestNextStep(); // count the iteration and request the next evaluation
+    void _findMin() override { this->_findMinAskTell(); }
+
+public:
+    explicit Lion(int ndim, bool useAveraging = false, double stepSize = 0.0001);
+    ~Lion() override = default;
+
+    // Getters
+    bool usesAveraging() const { return _useAveraging; }
+    bool usesNoisyFreeze() const { return _useNoisyFreeze; }
+    double getStepSize() const { return _stepSize; }
+    double getBeta1() const { return _beta1; }
+    double getBeta2() const { return _beta2; }
+
+    // Setters
+    void setAveraging(bool useAveraging) { _useAveraging = useAveraging; }
+    void setNoisyFreeze(bool useNoisyFreeze) { _useNoisyFreeze = useNoisyFreeze; }
+    void setStepSize(double stepSize) { _stepSize = std::max(0., stepSize); }
+    void setBeta1(double beta1) { _beta1 = std::max(0., std::min(1., beta1)); }
+    void setBeta2(double beta2) { _beta2 = std::max(0., std::min(1., beta2)); }
+};
+} // namespace nfm
+
+#endif
@@ -3,8 +3,9 @@
 
 #include "nfm/NoisyFunction.hpp"
 
-#include <functional>
 #include <algorithm>
+#include <cmath>
+#include <functional>
 #include <numeric>
 
 namespace nfm
@@ -15,39 +16,270 @@ namespace md
 enum class Integrator
 {
     EulerE, /*explicit Euler*/
-    VerletV /*Velocity Verlet*/
+    EulerSI, /*semi-implicit (symplectic) Euler*/
+    VerletV, /*Velocity Verlet*/
+    ForestRuth /*4th-order symplectic (Forest-Ruth), 3 force updates per step*/
+};
+
+// Default velocity mixing policy, which does nothing. With this policy, the
+// integrators are free to fuse velocity and position updates into single passes.
+struct NoMix
+{
+    void operator()() const {}
 };
 
-// Struct used to present a set of vectors
+// Force update policy for the staged integration (see doMDStage()), where the
+// caller computes the forces between the stages.
+struct NoUpdate
+{
+    void operator()() const {}
+};
+
+// Struct used to present a set of vectors and callables
 // from the optimizers to MD integrators.
+//
+// UpdateT: force update callable (usually a lambda), computing a from x
+// MixT:    velocity mixing callable, called after the first velocity update (e.g. FIRE 2.0)
+//
+// Both are compile-time policies, so the integrator loops are instantiated (and inlined)
+// for each optimizer. Use makeMDView() to let the compiler deduce the types.
+template <class UpdateT, class MixT = NoMix>
 struct MDView
 {
     std::vector<double> &x; // position
     std::vector<double> &v; // velocity
     std::vector<double> &a; // acceleration (F*mi)
-    std::function<void()> &update; // force update callback function (usually a lambda)
+    UpdateT &update; // force update callback
+    MixT mix; // velocity mixing callback (stored by value, usually a capturing lambda)
 };
 
+template <class UpdateT, class MixT>
+MDView<UpdateT, MixT> makeMDView(std::vector<double> &x, std::vector<double> &v, std::vector<double> &a, UpdateT &update, MixT mix)
+{
+    return MDView<UpdateT, MixT>{x, v, a, update, mix};
+}
+
+template <class UpdateT>
+MDView<UpdateT, NoMix> makeMDView(std::vector<double> &x, std::vector<double> &v, std::vector<double> &a, UpdateT &update)
+{
+    return MDView<UpdateT, NoMix>{x, v, a, update, NoMix{}};
+}
+
+
+// --- Loop helpers
+
+// v += kdt*a ; x += ddt*v
+inline void kickDrift(std::vector<double> &x, std::vector<double> &v, const std::vector<double> &a, const double kdt, const double ddt)
+{
+    for (size_t i = 0; i < x.size(); ++i) {
+        v[i] += kdt*a[i];
+        x[i] += ddt*v[i];
+    }
+}
+
+inline void kick(std::vector<double> &v, const std::vector<double> &a, const double kdt)
+{
+    for (size_t i = 0; i < v.size(); ++i) { v[i] += kdt*a[i]; }
+}
+
+// kick, then mix, then drift (mixing needs the fully kicked velocity)
+template <class UpdateT, class MixT>
+void kickMixDrift(MDView<UpdateT, MixT> &view, const double kdt, const double ddt)
+{
+    kick(view.v, view.a, kdt);
+    view.mix();
+    for (size_t i = 0; i < view.x.size(); ++i) { view.x[i] += ddt*view.v[i]; }
+}
+
+// without mixing, all can be done in one pass
+template <class UpdateT>
+void kickMixDrift(MDView<UpdateT, NoMix> &view, const double kdt, const double ddt)
+{
+    kickDrift(view.x, view.v, view.a, kdt, ddt);
+}
+
+
 // --- Functions
 
 // MDIntegrator step functions are of the form:
-// std::function<void(MDView &view,  double dt)>
-//                           ^in/out MDView ^time step
+// template <class UpdateT, class MixT> void(MDView<UpdateT, MixT> &view,  double dt)
+//                                                           ^in/out MDView ^time step
 //
 // Starting from the previous step's information in MDView x,v,a ,
 // they will perform a MD time step according to dt and call the
 // provided update() callback to ask for calculation of updated
 // acceleration values, to be stored in a.
+//
+// Internally, every integrator is split into stages around the force updates, i.e.
+// a step with n force updates consists of stage 0, update, stage 1, ..., update, stage n.
+// The stage functions have the form void(MDView<UpdateT, MixT> &view, double dt, int stage)
+// and never call update(). They may be used directly via doMDStage(), when the forces
+// can't be computed within a callback (e.g. for the ask/tell interface of FIRE).
+
+// number of force updates per step
+inline int getNForceUpdates(const Integrator mdi)
+{
+    return (mdi == Integrator::ForestRuth) ? 3 : 1;
+}
 
 // Euler
-void ExplicitEulerIntegrator(MDView &view, double dt);
+template <class UpdateT, class MixT>
+void ExplicitEulerStage(MDView<UpdateT, MixT> &view, const double dt, const int stage)
+{
+    if (stage == 0) {
+        for (size_t i = 0; i < view.x.size(); ++i) {
+            view.x[i] += dt*view.v[i];
+            view.v[i] += dt*view.a[i];
+        }
+        view.mix();
+    }
+}
+
+// Semi-implicit Euler (velocity first, symplectic)
+template <class UpdateT, class MixT>
+void SemiImplicitEulerStage(MDView<UpdateT, MixT> &view, const double dt, const int stage)
+{
+    if (stage == 0) { kickMixDrift(view, dt, dt); }
+}
 
 // Standard Velocity-Verlet, 4 step version
-void VelocityVerletIntegrator(MDView &view, double dt);
+template <class UpdateT, class MixT>
+void VelocityVerletStage(MDView<UpdateT, MixT> &view, const double dt, const int stage)
+{
+    const double hdt = 0.5*dt;
+    if (stage == 0) { kickMixDrift(view, hdt, dt); }
+    else { kick(view.v, view.a, hdt); }
+}
+
+// Forest-Ruth 4th-order symplectic integrator, velocity-first form
+// (forces at the final position are available afterwards)
+// NOTE: Costs 3 force updates per step, but allows much larger dt.
+template <class UpdateT, class MixT>
+void ForestRuthStage(MDView<UpdateT, MixT> &view, const double dt, const int stage)
+{
+    const double theta = 1./(2. - cbrt(2.));
+    switch (stage) {
+    case 0:
+        kickMixDrift(view, 0.5*theta*dt, theta*dt);
+        break;
+    case 1:
+        kickDrift(view.x, view.v, view.a, 0.5*(1. - theta)*dt, (1. - 2.*theta)*dt);
+        break;
+    case 2:
+        kickDrift(view.x, view.v, view.a, 0.5*(1. - theta)*dt, theta*dt);
+        break;
+    default:
+        kick(view.v, view.a, 0.5*theta*dt);
+    }
+}
+
+
+// Compile-time integrator selection, for callers which resolve the integrator once
+// before their loop: IntegratorStages<MDI>::stage() and IntegratorStages<MDI>::nupdates
+template <Integrator MDI>
+struct IntegratorStages;
+
+template <>
+struct IntegratorStages<Integrator::EulerE>
+{
+    static constexpr int nupdates = 1;
+
+    template <class UpdateT, class MixT>
+    static void stage(MDView<UpdateT, MixT> &view, const double dt, const int stage) { ExplicitEulerStage(view, dt, stage); }
+};
+
+template <>
+struct IntegratorStages<Integrator::EulerSI>
+{
+    static constexpr int nupdates = 1;
+
+    template <class UpdateT, class MixT>
+    static void stage(MDView<UpdateT, MixT> &view, const double dt, const int stage) { SemiImplicitEulerStage(view, dt, stage); }
+};
+
+template <>
+struct IntegratorStages<Integrator::VerletV>
+{
+    static constexpr int nupdates = 1;
+
+    template <class UpdateT, class MixT>
+    static void stage(MDView<UpdateT, MixT> &view, const double dt, const int stage) { VelocityVerletStage(view, dt, stage); }
+};
+
+template <>
+struct IntegratorStages<Integrator::ForestRuth>
+{
+    static constexpr int nupdates = 3;
+
+    template <class UpdateT, class MixT>
+    static void stage(MDView<UpdateT, MixT> &view, const double dt, const int stage) { ForestRuthStage(view, dt, stage); }
+};
+
+// full MD step of the integrator MDI (resolved at compile time)
+template <Integrator MDI, class UpdateT, class MixT>
+void doMDStep(MDView<UpdateT, MixT> &view, const double dt)
+{
+    using Stages = IntegratorStages<MDI>;
+    for (int stage = 0; stage < Stages::nupdates; ++stage) {
+        Stages::stage(view, dt, stage);
+        view.update();
+    }
+    Stages::stage(view, dt, Stages::nupdates);
+}
+
+// calls the right integrator stage according to enum (stage in [0, getNForceUpdates(mdi)])
+// NOTE: Dispatches on every call. Within loops, prefer to resolve the integrator once (see above).
+template <class UpdateT, class MixT>
+void doMDStage(const Integrator mdi, MDView<UpdateT, MixT> &view, const double dt, const int stage)
+{
+    switch (mdi) {
+    case Integrator::EulerE:
+        IntegratorStages<Integrator::EulerE>::stage(view, dt, stage);
+        break;
+    case Integrator::EulerSI:
+        IntegratorStages<Integrator::EulerSI>::stage(view, dt, stage);
+        break;
+    case Integrator::VerletV:
+        IntegratorStages<Integrator::VerletV>::stage(view, dt, stage);
+        break;
+    case Integrator::ForestRuth:
+        IntegratorStages<Integrator::ForestRuth>::stage(view, dt, stage);
+        break;
+    }
+}
+
+// calls the right integrator according to enum (dispatches once per step)
+template <class UpdateT, class MixT>
+void doMDStep(const Integrator mdi, MDView<UpdateT, MixT> &view, const double dt)
+{
+    switch (mdi) {
+    case Integrator::EulerE:
+        doMDStep<Integrator::EulerE>(view, dt);
+        break;
+    case Integrator::EulerSI:
+        doMDStep<Integrator::EulerSI>(view, dt);
+        break;
+    case Integrator::VerletV:
+        doMDStep<Integrator::VerletV>(view, dt);
+        break;
+    case Integrator::ForestRuth:
+        doMDStep<Integrator::ForestRuth>(view, dt);
+        break;
+    }
+}
+
+// full step versions of the integrators
+template <class UpdateT, class MixT>
+void ExplicitEulerIntegrator(MDView<UpdateT, MixT> &view, const double dt) { doMDStep<Integrator::EulerE>(view, dt); }
+
+template <class UpdateT, class MixT>
+void SemiImplicitEulerIntegrator(MDView<UpdateT, MixT> &view, const double dt) { doMDStep<Integrator::EulerSI>(view, dt); }
 
+template <class UpdateT, class MixT>
+void VelocityVerletIntegrator(MDView<UpdateT, MixT> &view, const double dt) { doMDStep<Integrator::VerletV>(view, dt); }
 
-// calls the right integrator according to enum
-void doMDStep(Integrator mdi, MDView &view, double dt);
+template <class UpdateT, class MixT>
+void ForestRuthIntegrator(MDView<UpdateT, MixT> &view, const double dt) { doMDStep<Integrator::ForestRuth>(view, dt); }
 
 
 // helper to compute accelerations
@@ -0,0 +1,46 @@
+#ifndef NFM_MAPPEDALLOCATOR_HPP
+#define NFM_MAPPEDALLOCATOR_HPP
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+
+namespace nfm
+{
+
+// Allocate/free memory which is backed by a (deleted) temporary file in the directory dir,
+// via mmap with sequential access hints. If dir is empty or the size is below mappedMinBytes,
+// ordinary heap memory is used instead. Throws std::bad_alloc on failure.
+constexpr size_t mappedMinBytes = 65536;
+void * mappedAllocate(size_t bytes, const std::string &dir);
+void mappedDeallocate(void * ptr, size_t bytes, const std::string &dir);
+
+// Allocator for std::vector, backing large allocations by memory-mapped files (see above),
+// such that the OS can page them out to disk when they don't fit into RAM.
+template <class T>
+class MappedAllocator
+{
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    std::string dir; // directory for the backing files (empty: use heap memory)
+
+    MappedAllocator() = default;
+    explicit MappedAllocator(std::string mapDir): dir(std::move(mapDir)) {}
+    template <class U>
+    MappedAllocator(const MappedAllocator<U> &other): dir(other.dir) {} // NOLINT (implicit by design)
+
+    T * allocate(size_t n) { return static_cast<T *>(mappedAllocate(n*sizeof(T), dir)); }
+    void deallocate(T * ptr, size_t n) { mappedDeallocate(ptr, n*sizeof(T), dir); }
+
+    template <class U>
+    bool operator==(const MappedAllocator<U> &other) const { return dir == other.dir; }
+    template <class U>
+    bool operator!=(const MappedAllocator<U> &other) const { return dir != other.dir; }
+};
+} // namespace nfm
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef NFM_MULTISTART_HPP
+#define NFM_MULTISTART_HPP
+
+#include "nfm/NoisyFunMin.hpp"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace nfm
+{
+
+// Low-discrepancy sequences to generate the starting points
+enum class StartSequence { Sobol, Halton };
+
+static constexpr int maxSobolDim = 21; // number of tabulated Sobol dimensions
+
+// Point with given index of a low-discrepancy sequence in the unit cube [0, 1)^ndim
+// (index 0 is the point 0, which is skipped by MultiStart)
+std::vector<double> sobolPoint(int ndim, int index); // will throw if ndim > maxSobolDim
+std::vector<double> haltonPoint(int ndim, int index);
+
+// Result of one run of a multi-start minimization
+struct MultiStartResult
+{
+    int istart{}; // index of the starting point (in sequence order)
+    std::vector<double> x0; // starting point
+    NoisyIOPair last; // final position and value (only meaningful if flag_run)
+    int niter{}; // number of iterations of the run
+    bool flag_run{}; // was the run performed (else it was skipped due to early stopping)?
+    bool flag_stopped{}; // was the run interrupted due to early stopping?
+};
+
+// Multi-start driver: Minimizes a target function from many starting points, placed within the given
+// box bounds by a low-discrepancy sequence (Sobol by default, the first point is the box center).
+// Every start uses its own optimizer, created by the passed factory (which is responsible for all the
+// settings), and the runs are distributed over a pool of threads.
+//
+// If a target value is set, the remaining runs are stopped early (or skipped, if not started yet)
+// as soon as one run has finished with a value that is below the target within the noise, i.e.
+// f < target with the NoisyValue comparison. Which of the other runs get interrupted then depends
+// on the timing of the threads. Without early stopping, all results are reproducible.
+//
+// findMin() returns the results of all starts, the finished runs sorted by ascending value (f.val),
+// followed by the skipped runs (in start order).
+//
+// NOTE: With more than one thread, the LogManager (static) should be turned off, and the target function
+// must be safe to call concurrently. Alternatively, pass a function factory to create one target per run.
+class MultiStart
+{
+private:
+    const int _ndim;
+    std::vector<double> _lbounds, _ubounds; // box for the starting points
+    std::function<std::unique_ptr<NFM>()> _makeOpt; // optimizer factory
+
+    int _nstarts = 16; // number of starting points
+    StartSequence _startSeq = StartSequence::Sobol;
+    int _nthreads = 1; // number of concurrent runs
+    bool _flag_target = false; // early stopping enabled?
+    double _target = 0.; // target value for early stopping
+
+    std::vector<MultiStartResult> _runAll(const std::function<NoisyFunction &(std::unique_ptr<NoisyFunction> &)> &getFun) const;
+
+public:
+    // Box bounds of the starting points (lbounds < ubounds, per dimension) and optimizer factory
+    MultiStart(const std::vector<double> &lbounds, const std::vector<double> &ubounds,
+               const std::function<std::unique_ptr<NFM>()> &makeOpt); // will throw on invalid bounds or empty factory
+
+    // --- Setters
+    void setNStarts(int nstarts); // will throw if < 1
+    void setStartSequence(StartSequence startSeq) { _startSeq = startSeq; } // Sobol requires ndim <= maxSobolDim
+    void setNThreads(int nthreads); // will throw if < 1
+    void setTargetValue(double target) { _target = target; _flag_target = true; } // enables early stopping
+    void clearTargetValue() { _flag_target = false; }
+
+    // --- Getters
+    int getNDim() const { return _ndim; }
+    int getNStarts() const { return _nstarts; }
+    StartSequence getStartSequence() const { return _startSeq; }
+    int getNThreads() const { return _nthreads; }
+    bool hasTargetValue() const { return _flag_target; }
+    double getTargetValue() const { return _target; }
+
+    // the starting points, in start order
+    std::vector<std::vector<double>> getStartingPoints() const;
+
+    // --- Minimization
+
+    // Run all starts on the target function (see the note above when using threads)
+    std::vector<MultiStartResult> findMin(NoisyFunction &targetFun);
+
+    // Run all starts, each on a new target function created by makeFun
+    std::vector<MultiStartResult> findMin(const std::function<std::unique_ptr<NoisyFunction>()> &makeFun);
+};
+} // namespace nfm
+
+#endif
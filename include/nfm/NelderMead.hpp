@@ -0,0 +1,70 @@
+#ifndef NFM_NELDERMEAD_HPP
+#define NFM_NELDERMEAD_HPP
+
+#include "nfm/NoisyFunMin.hpp"
+
+namespace nfm
+{
+
+// Noisy Nelder-Mead Simplex Minimization
+//
+// Gradient-free method for low-dimensional problems (ndim <~ 20). The decisions
+// whether to reflect, expand, contract or shrink the simplex are based on
+// NoisyValue comparisons, i.e. a candidate only wins when it is significantly
+// better. To avoid stagnation due to a single lucky evaluation, the best
+// vertex is re-evaluated on every iteration (can be disabled).
+//
+// NOTE: By default all candidate points of one iteration (reflection, expansion
+//       and both contraction points, plus the re-evaluated best vertex) are
+//       passed to the target function as one batch via NoisyFunction::fbatch.
+//       The shrink points also form a single batch. If you overwrite fbatch to
+//       evaluate the points in parallel, each iteration takes as long as a single
+//       evaluation. For serial functions you may disable batching, then only the
+//       points actually needed are evaluated, one after the other.
+class NelderMead: public NFM
+{
+protected:
+    double _initStep; // offset of the initial simplex vertices along the unit vectors
+    double _fRefl = 1.; // reflection factor (> 0)
+    double _fExp = 2.; // expansion factor (> 1)
+    double _fContr = 0.5; // contraction factor, el (0,1)
+    double _fShrink = 0.5; // shrink factor, el (0,1)
+    double _simplexTol = 1.e-5; // stop when all vertices are closer than this to the best one (if 0, disabled)
+    bool _flag_batch = true; // evaluate all candidate points of an iteration as one batch
+    bool _flag_reevalBest = true; // re-evaluate the best vertex on every iteration
+
+    // --- Internal methods
+    bool _isSimplexSmall(const std::vector<NoisyIOPair> &simplex) const;
+    void _findMin() override;
+
+public:
+    explicit NelderMead(int ndim, double initStep = 0.1);
+    ~NelderMead() override = default;
+
+    // Parameter sets
+    void useStandardParams(); // the classic factors (1, 2, 0.5, 0.5), set by default
+    void useAdaptiveParams(); // dimension-dependent factors (Gao & Han 2012), better for larger ndim
+
+    // Getters
+    double getInitStep() const { return _initStep; }
+    double getFRefl() const { return _fRefl; }
+    double getFExp() const { return _fExp; }
+    double getFContr() const { return _fContr; }
+    double getFShrink() const { return _fShrink; }
+    double getSimplexTol() const { return _simplexTol; }
+    bool usesBatch() const { return _flag_batch; }
+    bool usesReevalBest() const { return _flag_reevalBest; }
+
+    // Setters
+    void setInitStep(double initStep) { _initStep = (initStep != 0.) ? initStep : _initStep; }
+    void setFRefl(double fRefl) { _fRefl = (fRefl > 0.) ? fRefl : _fRefl; }
+    void setFExp(double fExp) { _fExp = std::max(1., fExp); }
+    void setFContr(double fContr) { _fContr = (fContr > 0. && fContr < 1.) ? fContr : _fContr; }
+    void setFShrink(double fShrink) { _fShrink = (fShrink > 0. && fShrink < 1.) ? fShrink : _fShrink; }
+    void setSimplexTol(double simplexTol) { _simplexTol = std::max(0., simplexTol); }
+    void setBatch(bool useBatch) { _flag_batch = useBatch; }
+    void setReevalBest(bool reevalBest) { _flag_reevalBest = reevalBest; }
+};
+} // namespace nfm
+
+#endif
@@ -2,13 +2,44 @@
 #define NFM_NOISYFUNMIN_HPP
 
 #include <functional>
+#include <memory>
+#include <string>
 
+#include "nfm/Checkpoint.hpp"
 #include "nfm/NoisyFunction.hpp"
+#include "nfm/ParamLayout.hpp"
 #include "nfm/PushBackBuffer.hpp"
+#include "nfm/StateBuffer.hpp"
 
 namespace nfm
 {
 
+class ThreadPool; // see ThreadPool.hpp
+
+// Evaluation request of the ask/tell interface (see NFM::begin())
+struct EvalRequest
+{
+    std::vector<double> x; // position to evaluate
+    bool needsValue = false; // is the function value requested?
+    bool needsGrad = false; // is the gradient requested?
+};
+
+// Scope guard for the casted target pointers of derived optimizers: Sets the pointer
+// for the scope of _findMin() and clears it on exit, also when an exception is thrown.
+template <class FunT>
+class TargetFunGuard
+{
+private:
+    FunT *&_fun;
+
+public:
+    TargetFunGuard(FunT *&fun, FunT * target): _fun(fun) { _fun = target; }
+    ~TargetFunGuard() { _fun = nullptr; }
+
+    TargetFunGuard(const TargetFunGuard &) = delete;
+    TargetFunGuard &operator=(const TargetFunGuard &) = delete;
+};
+
 class NFM
 {
 protected:
@@ -25,7 +56,7 @@ protected:
     NoisyGradient _grad; // last noisy gradient (will be all 0 if current/last run didn't use gradients)
 
 private: // set/called directly by base class only
-    PushBackBuffer<NoisyIOPair> _old_values; // list of previous target values and positions
+    PushBackBuffer<NoisyIOPair> _old_values; // list of previous target values and positions (heap memory, see setStateMemoryMapping())
 
     // Stopping Criteria (childs should use get/set methods, but may change defaults)
     bool _flag_gradErrStop; // should we consider gradient errors for stopping? (if targetfun supports it)
@@ -48,12 +79,49 @@ private: // set/called directly by base class only
     // for NFM to continue, else NFM will stop at the next shouldStop() check.
     std::function<bool(NFM &, NoisyFunction &)> _policy{};
 
+    // Optional parallel execution of internal O(ndim) loops (see setNThreads())
+    int _nthreads = 1; // number of threads (if 1, no pool is created)
+    int _parThreshold = 100000; // only loops of at least this length (i.e. ndim) are run in parallel
+    std::unique_ptr<ThreadPool> _pool; // created by setNThreads()
+
+    // Storage precision of large internal state vectors (see setStatePrecision())
+    StatePrecision _statePrec = StatePrecision::Double;
+    std::string _stateMapDir; // if not empty, back large state vectors by memory-mapped files in this directory
+
+    // Block/shape layout of the parameter vector (default: one vector block)
+    ParamLayout _layout;
+
+    // Checkpointing (see setCheckpointing())
+    std::string _ckptPath; // file to write checkpoints to
+    int _ckptEvery = 0; // write a checkpoint every this many iterations (if 0, disabled)
+    std::unique_ptr<AsyncFileWriter> _ckptWriter; // background writer (created by setCheckpointing())
+    bool _flag_resume = false; // the next findMin() continues from a loaded checkpoint
+
+    // Warm-start continuation (see setContinuation())
+    bool _flag_continue = false; // should findMin() continue with the state of the last call?
+    double _contDecay = 1.; // decay factor for the accumulated state on continuation
+    bool _flag_continuing = false; // the running findMin() is a continuation
+
+    // Ask/tell interface (see begin())
+    EvalRequest _request; // the last evaluation request of the optimizer
+    bool _flag_askTell = false; // is an ask/tell minimization running?
+    bool _flag_pending = false; // did the optimizer request an evaluation (since the last result)?
+
     bool _isConverged() const; // check if the target function has stabilized
     void _updateDeltas(); // calculate deltaX and deltaF between _last and _old_values.front()
     bool _changedEnough() const; // check deltas against epsx and epsf
     bool _stepLimitReached() const; // is the set maximum amount of iteration reached
 
     void _writeCurrentXToLog() const; // write current x on log on storeLastValue
+    void _endStep(); // calls the policy and counts the step (end of storeLastValue)
+
+    void _writeBaseState(StateWriter &out) const; // position, gradient, deltas, step count and old values
+    void _readBaseState(StateReader &in);
+
+    void _beginRun(); // checks and (unless resuming/continuing) resets at the begin of a minimization
+    void _endRun(); // resets temporary pointers and flags at the end of a minimization (also on exceptions)
+    void _advanceAskTell(bool flag_begin); // calls _atBegin() or _atResult() and finishes the run if no evaluation was requested
+    void _tell(const NoisyValue * f, const NoisyGradient * grad);
 
 protected: // Protected methods for child optimizers
     // use this after every position&function update
@@ -61,11 +129,89 @@ protected: // Protected methods for child optimizers
 
     // use this before terminating, if averaging is desired
     void _averageOldValues(); // compute average x of old value list, store it with the corresponding function value in last
+    void _averageOldX(); // only store the average x in last (the function value has to be evaluated by the caller)
 
     // check stopping criteria (shouldStop contains meaningfulGradient, if grad!=nullptr)
     bool _isGradNoisySmall(bool flag_log = true) const; //check if any gradient element is greater than its statistical error
     bool _shouldStop() const; // check for all stopping criteria
 
+    // Helpers for loops over [0, ndim), calling fn(begin, end) on chunks of the range (fn must return
+    // double for _parallelSum). Unless parallel execution is enabled and ndim is at least the parallel
+    // threshold, they simply call fn(0, ndim) in the calling thread.
+    bool _isParallel() const { return _pool != nullptr && _ndim >= _parThreshold; }
+
+    template <class F>
+    void _parallelFor(F &&fn) const
+    {
+        if (this->_isParallel()) { this->_poolFor(fn); }
+        else { fn(size_t(0), static_cast<size_t>(_ndim)); }
+    }
+
+    template <class F>
+    double _parallelSum(F &&fn) const
+    {
+        if (this->_isParallel()) { return this->_poolSum(fn); }
+        return fn(size_t(0), static_cast<size_t>(_ndim));
+    }
+
+    // the parallel branches of the helpers above (the pool is an implementation detail)
+    void _poolFor(const std::function<void(size_t, size_t)> &fn) const;
+    double _poolSum(const std::function<double(size_t, size_t)> &fn) const;
+
+    // Create a state vector of length n, with the configured precision and memory mapping
+    StateBuffer _makeStateBuffer(size_t n, bool nonNegative = false) const { return StateBuffer(n, _statePrec, nonNegative, _stateMapDir); }
+
+    // Set a state vector to n zeros, with the configured (or given) precision and memory mapping.
+    // The storage of buf is reused if possible.
+    void _initStateBuffer(StateBuffer &buf, size_t n, bool nonNegative = false) const { this->_initStateBuffer(buf, n, _statePrec, nonNegative); }
+    void _initStateBuffer(StateBuffer &buf, size_t n, StatePrecision prec, bool nonNegative) const;
+
+    // Read a state vector from a checkpoint, converted to the configured (or given) precision
+    void _readStateBuffer(StateReader &in, StateBuffer &buf) const { this->_readStateBuffer(in, buf, _statePrec); }
+    void _readStateBuffer(StateReader &in, StateBuffer &buf, StatePrecision prec) const;
+
+    // For optimizers working with sparse gradients: Update _grad (i.e. the dense gradient used for
+    // logging and stopping) by resetting the elements of the old and setting the ones of the new gradient
+    void _updateGradFromSparse(const NoisySparseGradient &sgradOld, const NoisySparseGradient &sgradNew);
+
+    // Counterparts of _storeLastValue() and _shouldStop() for lazy sparse updates, which avoid any work
+    // proportional to ndim: deltaX is computed from the passed squared position change of the touched
+    // coordinates, the old value list stores x only if storeX (else only f, enough for the convergence
+    // check), and the gradient noise check looks only at the elements of sgrad (the others are zero).
+    void _storeLastValueSparse(double deltaX2, bool storeX);
+    bool _shouldStopSparse(const NoisySparseGradient &sgrad) const;
+
+    // Checkpointing: Optimizers supporting it keep their complete minimization state in members,
+    // which are (de)serialized by _writeState()/_readState(). If _isResuming(), the state was loaded
+    // from a checkpoint (or kept from the last call, see below) and _findMin() must continue with it,
+    // instead of initializing a new run. _checkpoint() is to be called once per iteration, after the
+    // state was updated.
+    bool _isResuming() const { return _flag_resume; }
+    void _checkpoint(); // writes a checkpoint, if enabled and due
+    virtual bool _supportsCheckpoints() const { return false; } // in the current configuration
+    virtual void _writeState(StateWriter & /*out*/) const {}
+    virtual void _readState(StateReader & /*in*/) {} // should throw if the state doesn't fit the configuration
+
+    // Continuation (see setContinuation()) is available for optimizers supporting checkpoints. In that case
+    // _isResuming() is true as well, but the target function may have changed since the state was stored,
+    // so values depending on it (e.g. accelerations) have to be recomputed. If the state doesn't fit the
+    // configuration (e.g. on the first call), _findMin() should initialize a new run instead.
+    bool _isContinuing() const { return _flag_continuing; }
+    virtual void _decayState(double /*decay*/) {} // multiply the accumulated moments/velocities by decay
+
+    // Ask/tell: Optimizers supporting it are implemented as state machines, which don't call the target
+    // function directly. _atBegin() starts the minimization (with the same resume/continuation rules as
+    // above), _atResult() processes the result of the last evaluation, which is found in _evalF (value)
+    // and _grad (gradient). Both must either request the next evaluation via _requestEval(), or return
+    // without request when the minimization is finished. Then _findMin() may simply call _findMinAskTell(),
+    // which serves the requests with the target function of findMin().
+    virtual bool _supportsAskTell() const { return false; } // in the current configuration
+    virtual void _atBegin() {}
+    virtual void _atResult() {}
+    void _requestEval(const std::vector<double> &x, bool needsValue, bool needsGrad);
+    void _findMinAskTell();
+    NoisyValue _evalF{}; // function value of the last evaluation
+
     // "Mandatory" logging routines
     // If a gradient is used, it should be logged after it is calculated
     void _writeGradientToLog() const;
@@ -76,8 +222,15 @@ protected: // Protected methods for child optimizers
     // Base Constructor
     NFM(int ndim, bool needsGrad);
 
+    // Copies configuration and state into an idle optimizer. The copy neither shares nor creates the
+    // thread pool and checkpoint writer, i.e. it runs serially and without checkpointing (until set again).
+    // Derived optimizers which own further resources (e.g. Adam, ConjGrad) remain non-copyable.
+    NFM(const NFM &other);
+
 public:
-    virtual ~NFM() = default;
+    virtual ~NFM();
+
+    NFM &operator=(const NFM &) = delete;
 
     // --- Setters
 
@@ -95,9 +248,51 @@ public:
     void disableStopping(); // WILL TURN OFF ALL STOPPING CRITERIA (except user policy)
 
     // Set an own policy function which may manipulate NFM and target function on each step.
-    // It will always get called after a new position pair has been stored.
+    // It will always get called after a new position pair has been stored. In ask/tell mode there is no
+    // target function object, so the policy gets a placeholder which throws when it is evaluated.
     void setPolicy(const std::function<bool(NFM &, NoisyFunction &)> &policy) { _policy = policy; }
     void clearPolicy() { _policy = nullptr; } // set empty policy
+    const std::function<bool(NFM &, NoisyFunction &)> &getPolicy() const { return _policy; }
+
+    // Parallel execution of internal O(ndim) loops (vector updates, norms, dot products), intended
+    // for very large ndim. Reductions are done per fixed chunk, so results are bitwise reproducible
+    // for a fixed number of threads (but differ slightly from serial results).
+    void setNThreads(int nthreads); // creates a thread pool if nthreads > 1 (default 1, i.e. serial)
+    void setParallelThreshold(int parThreshold) { _parThreshold = std::max(1, parThreshold); } // minimal ndim
+
+    // Reduced precision storage of the internal state vectors (e.g. moments of Adam), to save memory
+    // for very large ndim. The state is (de)quantized block-wise within the update loops. Positions,
+    // gradients and MD velocities/accelerations are always kept in double precision. States loaded by
+    // loadCheckpoint() are converted to the precision set at that time.
+    void setStatePrecision(StatePrecision statePrec) { _statePrec = statePrec; } // default Double
+
+    // Back the internal state vectors (see above) by memory-mapped temporary files in the given directory,
+    // so the OS can page them to disk if they don't fit into RAM (pass empty string to disable, the default).
+    // NOTE: This covers only the StateBuffer vectors. Positions, gradients, the MD velocities/accelerations
+    // of FIRE/IRENE and the list of old values (up to getMaxNConstValues() copies of x, used for stopping
+    // and averaging) always stay on the heap. For very large ndim, reduce the latter via setMaxNConstValues().
+    void setStateMemoryMapping(const std::string &mapDir) { _stateMapDir = mapDir; }
+
+    // Declare the block/shape layout of the parameter vector (see ParamLayout.hpp), used by some optimizers
+    void setParamLayout(const ParamLayout &layout); // will throw if the layout size isn't ndim
+
+    // Checkpoint/restart: Write the complete optimizer state to a (versioned binary) file every
+    // everyNIter iterations (pass 0 or an empty path to disable, the default). The files are written
+    // by a background thread, to not stall the minimization. To resume an interrupted run, configure
+    // the optimizer like before, call loadCheckpoint() and then findMin(targetFun) (i.e. without x0),
+    // which continues the same trajectory. Not all optimizers (or modes) support checkpoints, in that
+    // case findMin() and loadCheckpoint() will throw.
+    void setCheckpointing(const std::string &path, int everyNIter);
+    void loadCheckpoint(const std::string &path); // will throw on invalid or mismatching files
+
+    // Warm-start continuation: If enabled, findMin() continues with the internal state of the last call
+    // (e.g. moments and their bias corrections, velocities, time step, conjugate direction and the old value
+    // list), instead of starting cold. Useful when re-optimizing after small changes of the target function.
+    // Before continuing, the accumulated moments/velocities are multiplied by decay in [0, 1] (decay 0 is
+    // equivalent to a cold start). The iteration count and the position/value change checks start anew.
+    // The internal buffers stay allocated between calls in any case. Supported by the optimizers that
+    // support checkpoints, else findMin() will throw.
+    void setContinuation(bool keepState, double decay = 1.);
 
     // --- Getters
 
@@ -122,7 +317,7 @@ public:
     bool needsGrad() const { return _flag_needsGrad; } // does the derived optimizer require gradients?
 
     // Other last values
-    const PushBackBuffer<NoisyIOPair> &getOldValues() const { return _old_values; }
+    const PushBackBuffer<NoisyIOPair> &getOldValues() const { return _old_values; } // x is empty after lazy sparse runs (unless needed for averaging)
     double getDeltaX() const { return _lastDeltaX; }
     double getDeltaF() const { return _lastDeltaF; }
     double getIter() const { return _istep; }
@@ -134,10 +329,21 @@ public:
     int getMaxNIterations() const { return _max_n_iterations; }
     int getMaxNConstValues() const { return _max_n_const_values; }
 
+    // Parallel execution
+    int getNThreads() const { return _nthreads; }
+    int getParallelThreshold() const { return _parThreshold; }
+    StatePrecision getStatePrecision() const { return _statePrec; }
+    const std::string &getStateMemoryMapping() const { return _stateMapDir; }
+    const ParamLayout &getParamLayout() const { return _layout; }
+    const std::string &getCheckpointPath() const { return _ckptPath; }
+    int getCheckpointInterval() const { return _ckptEvery; }
+    bool usesContinuation() const { return _flag_continue; }
+    double getContinuationDecay() const { return _contDecay; }
+
 
     // When in your use case (for whatever reason) it can happen that you access
     // a NFM object while it is running the findMin() method, this may be used to check.
-    bool isRunning() const { return _targetfun != nullptr; }
+    bool isRunning() const { return _targetfun != nullptr || _flag_askTell; }
 
 
     // --- Minimization method
@@ -150,6 +356,25 @@ public:
     // Optionally provide different initial positions x0
     NoisyIOPair findMin(NoisyFunction &targetFun, const std::vector<double> &x0); // will throw on wrong size
     NoisyIOPair findMin(NoisyFunction &targetFun, const double x0[]); // c array version (no size check)
+
+
+    // --- Ask/tell interface
+
+    // Alternative to findMin(), for callers that evaluate the target function themselves (e.g. by
+    // dispatching the evaluations to a queue). begin() starts a minimization from the internal X position
+    // (settings, checkpoints and continuation apply as for findMin()). Then ask() provides the next position
+    // to evaluate, together with the information whether value and/or gradient are required, and tell()
+    // passes back the results. Once ask() returns false, the minimization is finished and the results
+    // are available via the getters. Using different NFM objects, several minimizations can be driven
+    // at the same time. Supported by ConjGrad, DynamicDescent, Adam, Lion, FIRE and IRENE (except
+    // for the lazy sparse modes), else begin() will throw.
+    // NOTE: There is no target function object, so the user policy gets a placeholder (see setPolicy()).
+    bool supportsAskTell() const { return this->_supportsAskTell(); }
+    void begin(bool hasGradErr = false); // hasGradErr: will the passed gradients contain meaningful errors?
+    bool ask(EvalRequest &request) const; // get the pending request (returns false if the minimization is finished)
+    void tell(NoisyValue f); // pass back the requested value (throws if a requested result is missing, the request stays pending)
+    void tell(const NoisyGradient &grad); // pass back the requested gradient
+    void tell(NoisyValue f, const NoisyGradient &grad); // value and gradient
 };
 } // namespace nfm
 
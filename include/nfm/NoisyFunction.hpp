@@ -4,6 +4,8 @@
 #include "nfm/NoisyValue.hpp"
 #include "nfm/NoisyGradient.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 namespace nfm
@@ -40,9 +42,34 @@ public:
 
     // operator () overload
     NoisyValue operator()(const std::vector<double> &x) { return this->f(x); }
+
+    // Batch evaluation of several independent inputs
+    // Overwrite it to evaluate the points in parallel (threads, MPI, job queue...), if possible
+    virtual void fbatch(const std::vector<std::vector<double>> &xs, std::vector<NoisyValue> &fs)
+    { //                                                   ^inputs          ^outputs (resized to xs.size())
+        fs.resize(xs.size());
+        for (size_t i = 0; i < xs.size(); ++i) { fs[i] = this->f(xs[i]); }
+    }
 };
 
 
+class NoisyFunctionWithHSMatrices: public NoisyFunction
+// Functions which (like variational Monte Carlo energies) can sample the Hamiltonian
+// and overlap matrices H and S in the basis {psi_0, psi_1, ..., psi_ndim}, where psi_0
+// is the current state and psi_i its (semi-orthogonalized) derivatives w.r.t. x_i.
+// These are required by the linear method (see LinearMethod).
+{
+protected:
+    explicit NoisyFunctionWithHSMatrices(int ndim): NoisyFunction(ndim) {}
+
+public:
+    // Function value together with H and S matrices
+    // NOTE: The derivatives psi_i are expected to be orthogonalized to psi_0, i.e. S_00 = 1 and S_0i = S_i0 = 0.
+    //       H does not need to be symmetric (the sampled estimator usually is not).
+    virtual NoisyValue fHS(const std::vector<double> &x, std::vector<double> &H, std::vector<double> &S) = 0;
+    //         ^function value&error             ^input           ^H (row-major (ndim+1)^2)   ^S (row-major (ndim+1)^2)
+};
+
 class NoisyFunctionWithGradient: public NoisyFunction
 {
 protected:
@@ -69,6 +96,159 @@ public:
     }
 
     NoisyValue operator()(const std::vector<double> &x, NoisyGradient &gradv) { return this->fgrad(x, gradv); }
+
+    // Directional derivatives along k directions, i.e. -(grad f).d_j for every direction d_j
+    // IMPORTANT: As for the gradient, we expect the NEGATIVE derivatives.
+    // By default the full gradient is computed and projected. Overwrite it, if the derivatives
+    // can be computed at a cost that scales with k instead of ndim (e.g. forward-mode AD).
+    virtual void dirDeriv(const std::vector<double> &x, const std::vector<double> &dirs, std::vector<NoisyValue> &dd)
+    { //                                         ^input             ^directions (row-major k*ndim) ^derivatives (resized to k)
+        NoisyGradient gradv(_ndim);
+        this->grad(x, gradv);
+        dd.resize(dirs.size()/_ndim);
+        for (size_t j = 0; j < dd.size(); ++j) {
+            const double * dj = dirs.data() + j*_ndim;
+            dd[j] = {0., 0.};
+            for (int i = 0; i < _ndim; ++i) {
+                dd[j].val += gradv.val[i]*dj[i];
+                dd[j].err += gradv.err[i]*gradv.err[i]*dj[i]*dj[i];
+            }
+            dd[j].err = sqrt(dd[j].err);
+        }
+    }
+
+    // Combined Function & Directional derivatives
+    // Overwrite it with a more efficient version, if possible
+    virtual NoisyValue fdirDeriv(const std::vector<double> &x, const std::vector<double> &dirs, std::vector<NoisyValue> &dd)
+    {
+        NoisyValue ret = this->f(x);
+        this->dirDeriv(x, dirs, dd);
+        return ret;
+    }
+};
+
+
+class NoisyFunctionWithSparseGradient: public NoisyFunctionWithGradient
+// Functions with gradients that have only few non-zero elements per evaluation
+// (e.g. embedding-style models). The lazy update modes of Adam and DynamicDescent
+// make use of the sparsity, while all other optimizers use the dense grad() version.
+{
+protected:
+    NoisySparseGradient _sgtmp; // buffer for default grad()
+
+    explicit NoisyFunctionWithSparseGradient(int ndim, bool flag_gradErr):
+            NoisyFunctionWithGradient(ndim, flag_gradErr) {}
+
+public:
+    // Sparse Gradient
+    // IMPORTANT: As usual, we expect the NEGATIVE gradient. The passed sgrad is empty on call.
+    virtual void sparseGrad(const std::vector<double> &x, NoisySparseGradient &sgrad) = 0;
+    //                                               ^input             ^non-zero gradient elements (please set errors if _flag_gradErr!)
+
+    // Combined Function & Sparse Gradient
+    // Overwrite it with a more efficient version, if possible
+    virtual NoisyValue fsparseGrad(const std::vector<double> &x, NoisySparseGradient &sgrad)
+    {
+        NoisyValue ret = this->f(x);
+        sgrad.clear();
+        this->sparseGrad(x, sgrad);
+        return ret;
+    }
+
+    // Dense gradient from the sparse one
+    void grad(const std::vector<double> &x, NoisyGradient &gradv) override
+    {
+        _sgtmp.clear();
+        this->sparseGrad(x, _sgtmp);
+        gradv.zero();
+        for (size_t k = 0; k < _sgtmp.nnz(); ++k) {
+            gradv.val[_sgtmp.idx[k]] = _sgtmp.val[k];
+            gradv.err[_sgtmp.idx[k]] = _sgtmp.err[k];
+        }
+    }
+};
+
+
+class NoisyFunctionWithOverlap: public NoisyFunctionWithGradient
+// Functions that additionally provide products of the overlap (or Fisher
+// information) matrix S with arbitrary vectors, as required by stochastic
+// reconfiguration. The matrix itself never needs to be formed explicitly.
+{
+protected:
+    explicit NoisyFunctionWithOverlap(int ndim, bool flag_gradErr):
+            NoisyFunctionWithGradient(ndim, flag_gradErr) {}
+
+public:
+    // Overlap-Vector product
+    // IMPORTANT: S is meant to be the one sampled at the position of the last grad/fgrad call.
+    virtual void applyOverlap(const std::vector<double> &v, std::vector<double> &Sv) = 0;
+    //                                                   ^input (size ndim)      ^output S*v (size ndim)
+};
+
+class NoisyFunctionWithHessVec: public NoisyFunctionWithGradient
+// Functions that additionally provide (noisy) products of the Hessian matrix H
+// of f with arbitrary vectors, as required by truncated-Newton methods.
+// By default they are approximated by forward differences of gradients, which
+// costs one extra gradient evaluation per product (plus one per new position x,
+// unless the optimizer passed its gradient via setHessVecRefGrad()).
+// NOTE: The default is only meaningful for noiseless gradients, or for gradients
+// computed with common random numbers (i.e. the same samples at every position),
+// because differences of independently noisy gradients amplify their errors by 1/h.
+// Otherwise, overwrite hessVec with an analytic (or correlated-sampling) version.
+{
+protected:
+    double _hvStep; // relative step size for gradient differences
+
+    // reference gradient at the last position (for the default implementation)
+    std::vector<double> _hvx, _hvxh;
+    NoisyGradient _hvg0, _hvgh;
+
+    explicit NoisyFunctionWithHessVec(int ndim, bool flag_gradErr, double hvStep = 1.e-6):
+            NoisyFunctionWithGradient(ndim, flag_gradErr), _hvStep(hvStep), _hvxh(static_cast<size_t>(ndim)), _hvg0(ndim), _hvgh(ndim) {}
+
+public:
+    // Set the reference gradient g at x for the default hessVec, i.e. the gradient the optimizer just computed.
+    // Optimizers using hessVec call this on every step, so a reference cached only by x can't become stale
+    // when the target changes between calls at the same position (e.g. on re-optimization).
+    void setHessVecRefGrad(const std::vector<double> &x, const NoisyGradient &g)
+    {
+        _hvx = x;
+        _hvg0 = g;
+    }
+
+    // Hessian-Vector product
+    // NOTE: H is the Hessian of f itself (i.e. NOT negated like the gradient), so it is positive definite around minima.
+    virtual void hessVec(const std::vector<double> &x, const std::vector<double> &v, NoisyGradient &Hv)
+    { //                                        ^position                     ^input (size ndim)   ^output H*v (please set error fields if _flag_gradErr!)
+        if (x != _hvx) { // new position, compute reference gradient
+            _hvx = x;
+            this->grad(_hvx, _hvg0);
+        }
+        double xnorm = 0., vnorm = 0.;
+        for (int i = 0; i < _ndim; ++i) {
+            xnorm += x[i]*x[i];
+            vnorm += v[i]*v[i];
+        }
+        if (vnorm == 0.) {
+            Hv.zero();
+            return;
+        }
+        const double h = _hvStep*(1. + sqrt(xnorm))/sqrt(vnorm);
+        for (int i = 0; i < _ndim; ++i) { _hvxh[i] = x[i] + h*v[i]; }
+        this->grad(_hvxh, _hvgh);
+        for (int i = 0; i < _ndim; ++i) { // minus, because grad returns the negative gradient
+            Hv.val[i] = (_hvg0.val[i] - _hvgh.val[i])/h;
+            Hv.err[i] = sqrt(_hvg0.err[i]*_hvg0.err[i] + _hvgh.err[i]*_hvgh.err[i])/h;
+        }
+    }
+
+    // Batch of Hessian-Vector products at the same position
+    // Overwrite it to compute the products in parallel or in one vectorized pass, if possible
+    virtual void hessVecBatch(const std::vector<double> &x, const std::vector<std::vector<double>> &vs, std::vector<NoisyGradient> &Hvs)
+    { //                                             ^position                               ^inputs           ^outputs (resized to vs.size())
+        Hvs.resize(vs.size(), NoisyGradient(_ndim));
+        for (size_t j = 0; j < vs.size(); ++j) { this->hessVec(x, vs[j], Hvs[j]); }
+    }
 };
 } // namespace nfm
 
@@ -37,6 +37,35 @@ struct NoisyGradient
     bool operator>(double value) const;
     bool operator<(double value) const { return !(*this > value); }
 };
+
+// Sparse version of NoisyGradient, storing only the non-zero elements
+// as (index, value, error) triplets, in the order they were added.
+// NOTE: Indices should be unique (duplicates are not merged).
+struct NoisySparseGradient
+{
+    std::vector<int> idx;
+    std::vector<double> val;
+    std::vector<double> err;
+
+    size_t nnz() const { return idx.size(); } // number of stored elements
+    bool empty() const { return idx.empty(); }
+
+    void clear()
+    {
+        idx.clear();
+        val.clear();
+        err.clear();
+    }
+
+    void add(int i, double vali, double erri = 0.)
+    {
+        idx.push_back(i);
+        val.push_back(vali);
+        err.push_back(erri);
+    }
+
+    void add(int i, NoisyValue nv) { this->add(i, nv.val, nv.err); }
+};
 } // namespace nfm
 
 #endif
@@ -0,0 +1,69 @@
+#ifndef NFM_NOISYRESIDUALFUNCTION_HPP
+#define NFM_NOISYRESIDUALFUNCTION_HPP
+
+#include "nfm/NoisyFunction.hpp"
+
+#include <vector>
+
+namespace nfm
+{
+
+// Least-squares target functions of the form
+//     f(x) = sum_k r_k(x)^2 ,
+// where the r_k are (noisy) residuals. Derived classes implement the residuals
+// and optionally the Jacobian, which otherwise is computed by forward differences.
+// Value, gradient and their errors are derived from these automatically, so such
+// functions can be minimized by any NFM optimizer. However, LevenbergMarquardt
+// makes direct use of the residual structure and usually needs far less steps.
+class NoisyResidualFunction: public NoisyFunctionWithGradient
+{
+protected:
+    const int _nres; // number of residuals
+    const bool _flag_jac; // does the derived class provide an analytic Jacobian?
+    double _fdStep = 1.e-6; // step for finite difference Jacobian
+
+    // work buffers
+    std::vector<NoisyValue> _res, _res0, _resh;
+    std::vector<double> _xh, _jac;
+
+    // forward difference Jacobian, given the residuals r0 at x
+    void _fdJacobian(const std::vector<double> &x, const std::vector<NoisyValue> &r0, std::vector<double> &J);
+
+    NoisyResidualFunction(int ndim, int nres, bool flag_resErr, bool flag_jac);
+
+public:
+    int getNRes() const { return _nres; }
+    bool hasJacobian() const { return _flag_jac; }
+    double getFDStep() const { return _fdStep; }
+    void setFDStep(double fdStep) { _fdStep = (fdStep > 0.) ? fdStep : _fdStep; }
+
+    // Residuals
+    virtual void residuals(const std::vector<double> &x, std::vector<NoisyValue> &r) = 0;
+    //                                        ^input             ^residuals (size nres, set errors if flag_resErr!)
+
+    // Jacobian J_ki = dr_k/dx_i, stored row-major (i.e. J[k*ndim + i])
+    // Overwrite this if the function provides the Jacobian (and pass flag_jac = true)
+    virtual void jacobian(const std::vector<double> &x, std::vector<double> &J);
+    //                                       ^input             ^Jacobian (size nres*ndim)
+
+    // Jacobian at x, given the residuals r at x (which a finite difference Jacobian reuses)
+    void jacobianAt(const std::vector<double> &x, const std::vector<NoisyValue> &r, std::vector<double> &J);
+
+    // Combined residuals & Jacobian (without analytic Jacobian, r is reused for the differences)
+    // Overwrite it with a more efficient version, if possible
+    virtual void resjac(const std::vector<double> &x, std::vector<NoisyValue> &r, std::vector<double> &J);
+
+    // NoisyFunctionWithGradient interface, computed from the residuals
+    NoisyValue f(const std::vector<double> &x) final;
+    void grad(const std::vector<double> &x, NoisyGradient &gradv) final;
+    NoisyValue fgrad(const std::vector<double> &x, NoisyGradient &gradv) final;
+
+    // helper to compute sum of squares with error propagation
+    static NoisyValue sumOfSquares(const std::vector<NoisyValue> &r);
+
+    // helper to compute the (negative) gradient -2*J^T*r with error propagation
+    static void gradFromResiduals(const std::vector<NoisyValue> &r, const std::vector<double> &J, NoisyGradient &gradv);
+};
+} // namespace nfm
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef NFM_NOISYSUMFUNCTION_HPP
+#define NFM_NOISYSUMFUNCTION_HPP
+
+#include "nfm/NoisyFunction.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace nfm
+{
+
+// Target functions of the finite-sum form
+//     f(x) = 1/N * sum_i f_i(x) ,
+// i.e. averages over many independent terms (data points, configurations, ...).
+// Derived classes have to provide values and gradients of single terms, while the
+// full value and gradient are computed from them by default (overwrite if possible).
+// Optimizers like VRDescent make use of the term structure to evaluate minibatches.
+// If flag_gradErr, the gradient errors are the standard errors of the mean over the
+// terms, i.e. the terms are treated as samples (e.g. configurations or data points).
+class NoisySumFunction: public NoisyFunctionWithGradient
+{
+protected:
+    const int _nterms; // number of terms N
+
+    std::vector<double> _gtmp; // work buffer
+
+    NoisySumFunction(int ndim, int nterms, bool flag_gradErr = false):
+            NoisyFunctionWithGradient(ndim, flag_gradErr), _nterms(nterms), _gtmp(static_cast<size_t>(ndim))
+    {
+        if (nterms <= 0) {
+            throw std::invalid_argument("[NoisySumFunction] Number of terms must be at least 1.");
+        }
+    }
+
+public:
+    int getNTerms() const { return _nterms; }
+
+    // Standard error of the mean over n terms, given the means of their values and squared values
+    static double meanErr(const double mean, const double mean2, const int n)
+    {
+        return (n > 1) ? sqrt(std::max(0., mean2 - mean*mean)/(n - 1)) : 0.;
+    }
+
+    // Value of single term i (0 <= i < N)
+    virtual NoisyValue fTerm(const std::vector<double> &x, int i) = 0;
+
+    // (Negative!) gradient of single term i (0 <= i < N)
+    virtual void gradTerm(const std::vector<double> &x, int i, std::vector<double> &gradi) = 0;
+    //                                           ^input   ^term ^gradient output (size ndim)
+
+    // Mean (negative) gradient over a minibatch of term indices
+    // Overwrite it with a more efficient version, if possible
+    virtual void gradBatch(const std::vector<double> &x, const std::vector<int> &idx, std::vector<double> &gradb)
+    {
+        std::fill(gradb.begin(), gradb.end(), 0.);
+        for (const int i : idx) {
+            this->gradTerm(x, i, _gtmp);
+            for (int j = 0; j < _ndim; ++j) { gradb[j] += _gtmp[j]; }
+        }
+        for (double &g : gradb) { g /= idx.size(); }
+    }
+
+    // Full value, mean of all terms (errors propagated)
+    NoisyValue f(const std::vector<double> &x) override
+    {
+        NoisyValue ret{0., 0.};
+        for (int i = 0; i < _nterms; ++i) {
+            const NoisyValue fi = this->fTerm(x, i);
+            ret.val += fi.val;
+            ret.err += fi.err*fi.err;
+        }
+        ret.val /= _nterms;
+        ret.err = sqrt(ret.err)/_nterms;
+        return ret;
+    }
+
+    // Full (negative) gradient, mean of all terms (with standard errors of the mean, if _flag_gradErr)
+    void grad(const std::vector<double> &x, NoisyGradient &gradv) override
+    {
+        gradv.zero(); // err holds the sum of squares meanwhile
+        for (int i = 0; i < _nterms; ++i) {
+            this->gradTerm(x, i, _gtmp);
+            for (int j = 0; j < _ndim; ++j) { gradv.val[j] += _gtmp[j]; }
+            if (_flag_gradErr) {
+                for (int j = 0; j < _ndim; ++j) { gradv.err[j] += _gtmp[j]*_gtmp[j]; }
+            }
+        }
+        for (int j = 0; j < _ndim; ++j) {
+            gradv.val[j] /= _nterms;
+            if (_flag_gradErr) { gradv.err[j] = meanErr(gradv.val[j], gradv.err[j]/_nterms, _nterms); }
+        }
+    }
+};
+} // namespace nfm
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef NFM_PARAMLAYOUT_HPP
+#define NFM_PARAMLAYOUT_HPP
+
+#include <vector>
+
+namespace nfm
+{
+
+// A contiguous block of the parameter vector, either a plain vector
+// (cols == 1) or a row-major matrix of shape rows x cols
+struct ParamBlock
+{
+    int offset; // index of the first element within the parameter vector
+    int rows;
+    int cols;
+
+    int size() const { return rows*cols; }
+    bool isMatrix() const { return rows > 1 && cols > 1; }
+};
+
+// Declares how the parameter vector x is composed of blocks (e.g. the flattened weight
+// matrices and bias vectors of a model). Optimizers may use the shapes to organize their
+// internal state, e.g. Adam with factored second moments (see Adam.hpp).
+//
+// Blocks are appended in order, so they cover [0, getSize()) without gaps.
+class ParamLayout
+{
+private:
+    std::vector<ParamBlock> _blocks;
+    int _size = 0; // total number of parameters
+
+public:
+    ParamLayout() = default;
+    explicit ParamLayout(int n) { this->addVector(n); } // a single vector block
+
+    // append blocks (will throw on non-positive sizes)
+    void addVector(int n);
+    void addMatrix(int rows, int cols); // row-major
+
+    int getSize() const { return _size; }
+    int getNBlocks() const { return static_cast<int>(_blocks.size()); }
+    const ParamBlock &getBlock(int i) const { return _blocks[i]; }
+    const std::vector<ParamBlock> &getBlocks() const { return _blocks; }
+    int getNMatrixElements() const; // number of parameters within matrix blocks
+};
+} // namespace nfm
+
+#endif
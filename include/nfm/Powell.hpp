@@ -0,0 +1,63 @@
+#ifndef NFM_POWELL_HPP
+#define NFM_POWELL_HPP
+
+#include "nfm/LineSearch.hpp"
+#include "nfm/NoisyFunMin.hpp"
+
+namespace nfm
+{
+
+// Powell's Conjugate-Direction Minimization
+//
+// Gradient-free method for functions where (finite-difference) gradients are too
+// costly. Every sweep (= NFM iteration) performs noisy line minimizations (multiLineMin)
+// along a set of ndim directions, initially the unit vectors. The overall displacement
+// of a sweep then replaces the direction of largest decrease, according to Powell's
+// rule (as in Numerical Recipes), which builds up mutually conjugate directions.
+//
+// NOTE 1: Directions are kept normalized. Because multiLineMin only searches to the right
+//         side (up to backStep), a failed line search is repeated along the negated direction,
+//         which is then also kept for the next sweeps.
+// NOTE 2: If nLineThreads > 1, the line searches of a sweep all start from the same point and
+//         run concurrently (Jacobi-style). Then the sum of their displacements is used as
+//         the new direction and a final line search along it determines the next point.
+//         This requires a thread-safe target function, and VERBOSE logging should be off.
+class Powell: public NFM
+{
+protected:
+    MLMParams _mlmParams; // line search configuration (see LineSearch.hpp)
+    int _nlineThreads = 1; // number of concurrent line searches per sweep (not the NFM thread pool)
+
+    std::vector<double> _dirs; // current directions (row-major ndim*ndim, normalized)
+
+    // --- Internal methods
+    NoisyIOPair _lineMin(const NoisyIOPair &p0, int idir); // line search along direction idir, flipping it if needed
+    void _replaceDirection(int ibig, const std::vector<double> &dnew); // replace direction ibig by (normalized) dnew
+    void _sweepSerial();
+    void _sweepParallel();
+    void _findMin() override;
+
+public:
+    explicit Powell(int ndim, double stepSize = 0.1, int nlineThreads = 1);
+    ~Powell() override = default;
+
+    // Setters
+    void setMLMParams(MLMParams params) { _mlmParams = params; }
+    void setStepSize(double stepSize) { _mlmParams.stepRight = stepSize; }
+    void setBackStep(double backStep) { _mlmParams.stepLeft = backStep; }
+    void setMaxNBracket(int maxn_bracket) { _mlmParams.maxNBracket = maxn_bracket; }
+    void setMaxNMin1D(int maxn_min1d) { _mlmParams.maxNMinimize = maxn_min1d; }
+    void setNLineThreads(int nlineThreads) { _nlineThreads = std::max(1, nlineThreads); }
+
+    // Getters
+    MLMParams &getMLMParams() { return _mlmParams; }
+    const MLMParams &getMLMParams() const { return _mlmParams; }
+    double getStepSize() const { return _mlmParams.stepRight; }
+    double getBackStep() const { return _mlmParams.stepLeft; }
+    int getMaxNBracket() const { return _mlmParams.maxNBracket; }
+    int getMaxNMin1D() const { return _mlmParams.maxNMinimize; }
+    int getNLineThreads() const { return _nlineThreads; }
+};
+} // namespace nfm
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef NFM_SR_HPP
+#define NFM_SR_HPP
+
+#include "nfm/NoisyFunMin.hpp"
+
+namespace nfm
+{
+
+// Stochastic Reconfiguration (SR) / Natural Gradient Descent
+//
+// Widely used in Variational Monte Carlo, this method preconditions the
+// gradient with the inverse of the overlap (or Fisher) matrix S, i.e. every
+// step solves (S + lambda*I) * delta = g and moves along delta. Typically
+// it needs far fewer iterations than the plain SGD methods.
+//
+// NOTE: The target function must be a NoisyFunctionWithOverlap. The linear
+//       system is solved by matrix-free conjugate gradients, so only S*v
+//       products are required and the memory usage stays O(ndim).
+//       The inner CG is warm-started from the previous solution and, if the
+//       target function provides gradient errors, it is terminated as soon
+//       as the residual drops below the noise level of the gradient.
+class SR: public NFM
+{
+protected:
+    bool _useAveraging; // use the averaged positions of the old value list (length max_n_const_values) as end result
+    double _stepSize; // step size factor applied to the natural gradient
+    double _diagShift = 1.e-3; // (initial) diagonal shift lambda, added to S for regularization
+    double _shiftDecay = 1.; // after every step the shift is multiplied by this factor, el (0,1]
+    double _minDiagShift = 0.; // lower limit for the decaying shift
+    int _maxNCG = 100; // maximal number of inner CG iterations
+    double _cgTol = 1.e-8; // relative residual tolerance of the inner CG
+    bool _flag_cgNoiseStop = true; // stop inner CG when the residual is smaller than gradient noise
+
+    NoisyFunctionWithOverlap * _sfun{}; // the casted target function (valid during findMin)
+
+    // --- Internal methods
+    int _solveShiftedSystem(double shift, std::vector<double> &delta); // returns the number of CG iterations
+    void _findMin() override;
+
+public:
+    explicit SR(int ndim, bool useAveraging = false, double stepSize = 0.1);
+    ~SR() override = default;
+
+    // Getters
+    bool usesAveraging() const { return _useAveraging; }
+    double getStepSize() const { return _stepSize; }
+    double getDiagShift() const { return _diagShift; }
+    double getShiftDecay() const { return _shiftDecay; }
+    double getMinDiagShift() const { return _minDiagShift; }
+    int getMaxNCG() const { return _maxNCG; }
+    double getCGTol() const { return _cgTol; }
+    bool getCGNoiseStop() const { return _flag_cgNoiseStop; }
+
+    // Setters
+    void setAveraging(bool useAveraging) { _useAveraging = useAveraging; }
+    void setStepSize(double stepSize) { _stepSize = std::max(0., stepSize); }
+    void setDiagShift(double diagShift) { _diagShift = std::max(0., diagShift); }
+    void setShiftDecay(double shiftDecay) { _shiftDecay = std::max(0., std::min(1., shiftDecay)); }
+    void setMinDiagShift(double minDiagShift) { _minDiagShift = std::max(0., minDiagShift); }
+    void setMaxNCG(int maxNCG) { _maxNCG = std::max(1, maxNCG); }
+    void setCGTol(double cgTol) { _cgTol = std::max(0., cgTol); }
+    void setCGNoiseStop(bool flag_cgNoiseStop) { _flag_cgNoiseStop = flag_cgNoiseStop; }
+};
+} // namespace nfm
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef NFM_STATEBUFFER_HPP
+#define NFM_STATEBUFFER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "nfm/MappedAllocator.hpp"
+
+namespace nfm
+{
+
+class StateWriter;
+class StateReader;
+
+enum class StatePrecision
+{
+    Double, /* full precision (default) */
+    Float,  /* single precision */
+    BF16,   /* bfloat16 (8 bit exponent, 8 bit mantissa) */
+    Q8      /* blockwise 8-bit quantization, with one float scale per block */
+};
+
+// Storage for large optimizer state vectors (e.g. moment estimates), with selectable precision
+//
+// The values are accessed block-wise only (see updateBlockwise() below): Every block is
+// decoded into a small double buffer, updated and encoded again, so the (de)quantization
+// is fused into the update loops, while the full state never exists in double precision.
+// For StatePrecision::Double, the blocks point directly into the stored data.
+//
+// Q8 uses a companding (square root) map relative to the block's absolute maximum, which
+// resolves small values much better than linear quantization. The values are rounded
+// stochastically between the two neighboring levels, such that the decoded values are
+// unbiased and repeated small updates (e.g. decay by 0.999) are not lost. The rounding noise
+// is deterministic, keyed by element index and a per-block counter of encodings. Buffers
+// declared non-negative (like second moments, which usually appear in denominators) use all
+// 256 levels for the magnitude and never round non-zero values to zero.
+//
+// Optionally, the storage is backed by memory-mapped temporary files (see MappedAllocator.hpp),
+// for states which don't fit into RAM. The block-wise access pattern is sequential.
+class StateBuffer
+{
+public:
+    static constexpr size_t blockSize = 256; // number of values per block
+
+private:
+    size_t _size = 0;
+    StatePrecision _prec = StatePrecision::Double;
+    bool _flag_nonNegative = false; // values are known to be >= 0
+    std::string _mapDir; // directory for memory-mapped storage (empty: heap memory)
+
+    // only the vector corresponding to _prec is used
+    std::vector<double, MappedAllocator<double>> _d;
+    std::vector<float, MappedAllocator<float>> _f;
+    std::vector<uint16_t, MappedAllocator<uint16_t>> _h;
+    std::vector<uint8_t, MappedAllocator<uint8_t>> _q;
+    std::vector<float, MappedAllocator<float>> _scales; // per-block scales (Q8)
+    std::vector<uint32_t, MappedAllocator<uint32_t>> _rounds; // per-block encoding counters (Q8)
+
+public:
+    explicit StateBuffer(size_t n = 0, StatePrecision prec = StatePrecision::Double, bool nonNegative = false,
+                         const std::string &mapDir = "");
+
+    // (re)allocate and set all values to 0 (the storage is reused if size and precision don't change)
+    void assign(size_t n, StatePrecision prec, bool nonNegative = false);
+
+    size_t size() const { return _size; }
+    StatePrecision getPrecision() const { return _prec; }
+    bool isNonNegative() const { return _flag_nonNegative; }
+    bool isMapped() const { return !_mapDir.empty(); } // (large) storage is memory-mapped
+    const std::string &getMapDir() const { return _mapDir; }
+    size_t getNBytes() const; // memory used by the stored values (incl. scales and counters)
+
+    // Block access: The block starting at index begin (multiple of blockSize) has len values.
+    // loadBlock returns a pointer to the block values, either into the storage (Double) or into tmp.
+    // storeBlock has to be called with the pointer returned by loadBlock, after the values were changed.
+    double * loadBlock(size_t begin, size_t len, double * tmp);
+    void storeBlock(size_t begin, size_t len, const double * blk);
+
+    // full conversion (e.g. for tests or checkpoints)
+    void get(std::vector<double> &out) const;
+    void set(const std::vector<double> &in);
+
+    void scale(double fac); // multiply all values by fac
+    void convert(StatePrecision prec); // change the precision, keeping the values (block-wise)
+
+    // (de)serialize the stored representation (checkpoints, see Checkpoint.hpp)
+    // read() restores size and precision of the stored buffer, but keeps the own memory mapping
+    void write(StateWriter &out) const;
+    void read(StateReader &in);
+};
+
+
+// Calls fn(begin, len, blks) for all blocks of the given buffers (of equal size) whose first index
+// lies within [ibegin, iend), where blks[k] points to the decoded block of bufs[k]. Afterwards the
+// blocks are encoded again. The index range allows to combine it with NFM::_parallelFor().
+template <size_t N, class F>
+void updateBlockwise(const std::array<StateBuffer *, N> &bufs, size_t ibegin, size_t iend, F &&fn)
+{
+    const size_t n = bufs[0]->size();
+    double tmp[N][StateBuffer::blockSize];
+    std::array<double *, N> blks{};
+    for (size_t b0 = ((ibegin + StateBuffer::blockSize - 1)/StateBuffer::blockSize)*StateBuffer::blockSize; b0 < iend; b0 += StateBuffer::blockSize) {
+        const size_t len = (n - b0 < StateBuffer::blockSize) ? n - b0 : StateBuffer::blockSize;
+        for (size_t k = 0; k < N; ++k) { blks[k] = bufs[k]->loadBlock(b0, len, tmp[k]); }
+        fn(b0, len, blks);
+        for (size_t k = 0; k < N; ++k) { bufs[k]->storeBlock(b0, len, blks[k]); }
+    }
+}
+} // namespace nfm
+
+#endif
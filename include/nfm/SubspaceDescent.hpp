@@ -0,0 +1,52 @@
+#ifndef NFM_SUBSPACEDESCENT_HPP
+#define NFM_SUBSPACEDESCENT_HPP
+
+#include "nfm/NoisyFunMin.hpp"
+
+#include <cstdint>
+
+namespace nfm
+{
+
+// Random-Subspace Descent
+//
+// Meant for very high-dimensional problems where a full gradient per step is overkill.
+// On every step, k random orthonormal directions u_j are drawn and only the k (noisy)
+// directional derivatives along them are requested from the target function (via
+// NoisyFunctionWithGradient::fdirDeriv). Then we step within that subspace:
+//     x += stepSize * sum_j (-grad f . u_j) * u_j .
+// If the target function provides a dirDeriv implementation with cost scaling in k
+// (e.g. forward-mode AD), every step costs O(k) instead of O(ndim) derivative evaluations.
+//
+// NOTE: The projected gradient is stored as NFM gradient (for logging), so the stopping
+//       criterion on noisy gradients would refer to the subspace only and is disabled by default.
+class SubspaceDescent: public NFM
+{
+protected:
+    int _k; // number of random directions per step
+    double _stepSize; // step size / learning rate
+    bool _useAveraging = false; // use the averaged positions of the old value list as end result
+    uint64_t _seed = 1337; // seed for the random directions
+
+    // --- Internal methods
+    void _findMin() override;
+
+public:
+    explicit SubspaceDescent(int ndim, int k = 1, double stepSize = 0.01);
+    ~SubspaceDescent() override = default;
+
+    // Getters
+    int getK() const { return _k; }
+    double getStepSize() const { return _stepSize; }
+    bool usesAveraging() const { return _useAveraging; }
+    uint64_t getSeed() const { return _seed; }
+
+    // Setters
+    void setK(int k) { _k = std::max(1, std::min(_ndim, k)); }
+    void setStepSize(double stepSize) { _stepSize = std::max(0., stepSize); }
+    void setAveraging(bool useAveraging) { _useAveraging = useAveraging; }
+    void setSeed(uint64_t seed) { _seed = seed; }
+};
+} // namespace nfm
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef NFM_THREADPOOL_HPP
+#define NFM_THREADPOOL_HPP
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nfm
+{
+
+// Minimal fixed-size thread pool for the internal O(ndim) loops of optimizers
+//
+// Every run() splits the work into exactly one chunk per thread (the calling thread
+// processes chunk 0) and blocks until all chunks are done. The chunk boundaries only
+// depend on the loop length and the number of threads, and reductions sum the chunk
+// results in chunk order, so results are bitwise reproducible for a fixed thread count.
+//
+// NOTE: A pool must not be used by more than one caller at the same time.
+class ThreadPool
+{
+private:
+    const int _nthreads; // total number of threads, including the caller
+    std::vector<std::thread> _workers;
+
+    std::mutex _mutex;
+    std::condition_variable _cvStart, _cvDone;
+    const std::function<void(int)> * _job{}; // current job, called with chunk index
+    unsigned long _generation = 0; // counts jobs, to wake workers exactly once per job
+    int _nbusy = 0; // number of workers still working on the current job
+    bool _flag_quit = false;
+
+    void _workerLoop(int ichunk);
+
+public:
+    explicit ThreadPool(int nthreads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int getNThreads() const { return _nthreads; }
+
+    // call job(ichunk) for all ichunk in [0, nthreads) and wait for completion
+    void run(const std::function<void(int)> &job);
+
+    // bounds [begin, end) of chunk ichunk, when splitting n elements into nchunks
+    static void chunkRange(size_t n, int nchunks, int ichunk, size_t &begin, size_t &end)
+    {
+        const size_t base = n/nchunks, rest = n%nchunks, ic = static_cast<size_t>(ichunk);
+        begin = ic*base + std::min(ic, rest);
+        end = begin + base + (ic < rest ? 1 : 0);
+    }
+
+    // call fn(begin, end) on all chunks of [0, n)
+    template <class F>
+    void parallelFor(size_t n, F &&fn)
+    {
+        this->run([&](int ichunk)
+                  {
+                      size_t begin, end;
+                      chunkRange(n, _nthreads, ichunk, begin, end);
+                      fn(begin, end);
+                  });
+    }
+
+    // sum of the double results of fn(begin, end) over all chunks of [0, n), in chunk order
+    template <class F>
+    double parallelSum(size_t n, F &&fn)
+    {
+        std::vector<double> partial(static_cast<size_t>(_nthreads));
+        this->run([&](int ichunk)
+                  {
+                      size_t begin, end;
+                      chunkRange(n, _nthreads, ichunk, begin, end);
+                      partial[ichunk] = fn(begin, end);
+                  });
+        double sum = 0.;
+        for (const double p : partial) { sum += p; }
+        return sum;
+    }
+};
+} // namespace nfm
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef NFM_TRUNCATEDNEWTON_HPP
+#define NFM_TRUNCATEDNEWTON_HPP
+
+#include "nfm/NoisyFunMin.hpp"
+
+namespace nfm
+{
+
+// Truncated-Newton (Hessian-free Newton-CG) Minimization
+//
+// Every step approximately solves the Newton equations H * p = g by an inner
+// conjugate gradient loop, which only requires Hessian-vector products. On
+// ill-conditioned problems (narrow curved valleys) this typically needs an order
+// of magnitude fewer outer iterations than ConjGrad or steepest descent.
+//
+// NOTE 1: The target function must be a NoisyFunctionWithHessVec. The inner CG stops when
+//         the residual falls below the forcing tolerance min(maxForcing, sqrt(|g|)) * |g|,
+//         when the curvature along a search direction is not significantly positive,
+//         or when the propagated noise of the residual exceeds maxNSR times its norm
+//         (i.e. when further CG iterations would only fit noise).
+// NOTE 2: The step is globalized by backtracking from the full Newton step, accepting
+//         the first step length whose function decrease is not significantly worse
+//         than the Armijo condition (NoisyValue comparison).
+class TruncatedNewton: public NFM
+{
+protected:
+    double _stepSize; // initial step length factor for the backtracking
+    int _maxNCG = 0; // maximal number of inner CG iterations (if 0, ndim is used)
+    double _maxForcing = 0.5; // upper limit of the relative residual tolerance (forcing term) of the inner CG
+    double _maxNSR = 0.5; // stop inner CG when the noise-to-signal ratio of the residual exceeds this value
+    double _armijo = 1.e-4; // sufficient decrease factor
+    double _backtrack = 0.5; // step length reduction factor on backtracking, el (0,1)
+    int _maxNBacktrack = 20; // maximal number of backtracking steps
+
+    NoisyFunctionWithHessVec * _hfun{}; // the casted target function (valid during findMin)
+
+    // --- Internal methods
+    int _solveNewton(std::vector<double> &p); // returns the number of CG iterations
+    bool _backtrackStep(const std::vector<double> &p); // returns false if no acceptable step was found
+    void _findMin() override;
+
+public:
+    explicit TruncatedNewton(int ndim, double stepSize = 1.);
+    ~TruncatedNewton() override = default;
+
+    // Getters
+    double getStepSize() const { return _stepSize; }
+    int getMaxNCG() const { return _maxNCG; }
+    double getMaxForcing() const { return _maxForcing; }
+    double getMaxNSR() const { return _maxNSR; }
+    double getArmijo() const { return _armijo; }
+    double getBacktrack() const { return _backtrack; }
+    int getMaxNBacktrack() const { return _maxNBacktrack; }
+
+    // Setters
+    void setStepSize(double stepSize) { _stepSize = (stepSize > 0.) ? stepSize : _stepSize; }
+    void setMaxNCG(int maxNCG) { _maxNCG = std::max(0, maxNCG); }
+    void setMaxForcing(double maxForcing) { _maxForcing = std::max(0., maxForcing); }
+    void setMaxNSR(double maxNSR) { _maxNSR = std::max(0., maxNSR); }
+    void setArmijo(double armijo) { _armijo = std::max(0., std::min(0.5, armijo)); }
+    void setBacktrack(double backtrack) { _backtrack = (backtrack > 0. && backtrack < 1.) ? backtrack : _backtrack; }
+    void setMaxNBacktrack(int maxNBacktrack) { _maxNBacktrack = std::max(0, maxNBacktrack); }
+};
+} // namespace nfm
+
+#endif
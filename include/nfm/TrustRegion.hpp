@@ -0,0 +1,79 @@
+#ifndef NFM_TRUSTREGION_HPP
+#define NFM_TRUSTREGION_HPP
+
+#include "nfm/NoisyFunMin.hpp"
+
+namespace nfm
+{
+
+// Noisy Trust-Region Minimization
+//
+// Instead of line-searches, which discard most of the values computed while
+// bracketing, this method keeps a history of all recently evaluated positions
+// together with their values and gradients. From it a local quadratic model
+//     m(s) = f + G.s + 0.5 * s^T B s     (G is the true, i.e. uphill, gradient)
+// is fitted around the current position and minimized within the trust radius
+// (truncated Steihaug-CG). Typically far fewer function evaluations are needed
+// per accepted step than with ConjGrad.
+//
+// NOTE 1: The model is rebuilt on every step. The overall curvature scale is fitted
+//         to both function values and gradient differences (weighted by inverse
+//         variance), followed by damped BFGS secant updates for every history pair,
+//         each mixed in according to its signal-to-noise ratio. B is kept dense,
+//         so this method is meant for moderate ndim.
+// NOTE 2: A step is accepted unless the ratio of actual and predicted reduction,
+//         which is a NoisyValue, is significantly below eta1. If the ratio is below
+//         eta1 only within noise, the step is rejected but the radius is decreased
+//         more gently. Rejected points still enter the model history, while the
+//         accepted ones also go into the regular NFM old value list.
+class TrustRegion: public NFM
+{
+protected:
+    double _radius0; // initial trust radius
+    double _maxRadius; // maximal trust radius
+    double _minRadius = 1.e-8; // stop when the radius falls below this value
+    double _eta1 = 0.1; // acceptance threshold for the reduction ratio
+    double _eta2 = 0.75; // radius increase threshold for the reduction ratio
+    double _fShrink = 0.25; // radius decrease factor, el (0,1)
+    double _fGrow = 2.; // radius increase factor, > 1
+    int _maxNHistory = 10; // number of positions (incl. current) kept for the model fit
+
+    std::vector<double> _B; // dense model Hessian (row-major ndim*ndim)
+
+    // --- Internal methods
+    struct HistoryPoint
+    {
+        NoisyIOPair p;
+        NoisyGradient g;
+    };
+    void _fitModel(const PushBackBuffer<HistoryPoint> &history); // fit _B around _last/_grad
+    double _solveSubproblem(double radius, std::vector<double> &s) const; // returns predicted reduction
+    void _findMin() override;
+
+public:
+    explicit TrustRegion(int ndim, double radius0 = 0.1, double maxRadius = 10.);
+    ~TrustRegion() override = default;
+
+    // Getters
+    double getRadius0() const { return _radius0; }
+    double getMaxRadius() const { return _maxRadius; }
+    double getMinRadius() const { return _minRadius; }
+    double getEta1() const { return _eta1; }
+    double getEta2() const { return _eta2; }
+    double getFShrink() const { return _fShrink; }
+    double getFGrow() const { return _fGrow; }
+    int getMaxNHistory() const { return _maxNHistory; }
+
+    // Setters
+    void setRadius0(double radius0) { _radius0 = (radius0 > 0.) ? std::min(radius0, _maxRadius) : _radius0; }
+    void setMaxRadius(double maxRadius) { _maxRadius = std::max(_radius0, maxRadius); }
+    void setMinRadius(double minRadius) { _minRadius = std::max(0., minRadius); }
+    void setEta1(double eta1) { _eta1 = std::max(0., std::min(_eta2, eta1)); }
+    void setEta2(double eta2) { _eta2 = std::max(_eta1, std::min(1., eta2)); }
+    void setFShrink(double fShrink) { _fShrink = (fShrink > 0. && fShrink < 1.) ? fShrink : _fShrink; }
+    void setFGrow(double fGrow) { _fGrow = std::max(1., fGrow); }
+    void setMaxNHistory(int maxNHistory) { _maxNHistory = std::max(2, maxNHistory); }
+};
+} // namespace nfm
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef NFM_VRDESCENT_HPP
+#define NFM_VRDESCENT_HPP
+
+#include "nfm/NoisyFunMin.hpp"
+#include "nfm/NoisySumFunction.hpp"
+
+#include <cstdint>
+
+namespace nfm
+{
+
+enum class VRMode
+{
+    SVRG, /* Stochastic Variance Reduced Gradient (Johnson & Zhang 2013) */
+    SAGA  /* SAGA (Defazio, Bach & Lacoste-Julien 2014) */
+};
+
+// Variance-Reduced Stochastic Gradient Descent
+//
+// For finite-sum targets (see NoisySumFunction), these methods step along minibatch
+// gradients which are corrected by a control variate, such that the variance of the
+// step vanishes when approaching the minimum. In contrast to DynamicDescent and Adam,
+// no full (noisy) gradient is needed on every step.
+//
+//   - SVRG: On every epoch, the full gradient is computed at a snapshot position.
+//           Inner steps use g_B(x) - g_B(x_snap) + g(x_snap), for random minibatches B.
+//   - SAGA: Keeps a table of the last gradient of every single term (one contiguous
+//           block of N*ndim values) and steps along g_B(x) - g_B(table) + mean(table).
+//
+// NOTE: The NFM iteration corresponds to one epoch (by default N/batchSize inner steps).
+//       On its start, the full target value is computed (and for SVRG also the full
+//       gradient, while for SAGA the table mean serves as gradient estimate) and
+//       the usual stopping criteria are checked.
+class VRDescent: public NFM
+{
+protected:
+    VRMode _vrmode; // which method to use
+    double _stepSize; // step size / learning rate
+    int _batchSize = 1; // number of terms per minibatch
+    int _epochLength = 0; // number of inner steps per epoch (if 0, N/batchSize is used)
+    bool _useAveraging = false; // use the averaged positions of the old value list as end result
+    uint64_t _seed = 1337; // seed for minibatch sampling
+
+    NoisySumFunction * _sumfun{}; // the casted target function (valid during findMin)
+
+    // --- Internal methods
+    void _updateTarget(bool flag_fullGrad);
+    void _findMinSVRG(std::vector<int> &perm, int nsteps, int bsize);
+    void _findMinSAGA(std::vector<int> &perm, int nsteps, int bsize);
+    void _findMin() override;
+
+public:
+    explicit VRDescent(int ndim, VRMode vrmode = VRMode::SVRG, double stepSize = 0.01);
+    ~VRDescent() override = default;
+
+    // VR Configuration
+    void useSVRG() { _vrmode = VRMode::SVRG; }
+    void useSAGA() { _vrmode = VRMode::SAGA; }
+    void setVRMode(VRMode vrmode) { _vrmode = vrmode; }
+    VRMode getVRMode() const { return _vrmode; }
+
+    // Getters
+    double getStepSize() const { return _stepSize; }
+    int getBatchSize() const { return _batchSize; }
+    int getEpochLength() const { return _epochLength; }
+    bool usesAveraging() const { return _useAveraging; }
+    uint64_t getSeed() const { return _seed; }
+
+    // Setters
+    void setStepSize(double stepSize) { _stepSize = std::max(0., stepSize); }
+    void setBatchSize(int batchSize) { _batchSize = std::max(1, batchSize); }
+    void setEpochLength(int epochLength) { _epochLength = std::max(0, epochLength); }
+    void setAveraging(bool useAveraging) { _useAveraging = useAveraging; }
+    void setSeed(uint64_t seed) { _seed = seed; }
+};
+} // namespace nfm
+
+#endif
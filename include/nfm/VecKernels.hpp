@@ -0,0 +1,78 @@
+#ifndef NFM_VECKERNELS_HPP
+#define NFM_VECKERNELS_HPP
+
+#include <cstddef>
+
+namespace nfm
+{
+namespace vk
+{
+
+// Vector Kernels for the per-element update loops of the optimizers
+//
+// Each kernel is compiled for several instruction set levels (from the same source,
+// see src/VecKernelsImpl.hpp) and the best level supported by the running CPU is
+// selected on first use. All levels compute bitwise identical results: floating point
+// contraction is disabled for the kernels and the reductions always use the same
+// fixed number of partial sums, independent of the vector width.
+//
+// NOTE: On non-x86 platforms, only the baseline level exists (named SSE2 here).
+enum class SIMDLevel
+{
+    SSE2, /* baseline (x86-64 always has SSE2) */
+    AVX2,
+    AVX512 /* AVX-512F */
+};
+
+SIMDLevel getSIMDLevel(); // currently used level
+SIMDLevel getMaxSIMDLevel(); // best level supported by the CPU (and compiler)
+void setSIMDLevel(SIMDLevel level); // force a level (for testing), will be capped at getMaxSIMDLevel()
+const char * getSIMDLevelName(SIMDLevel level);
+
+
+// --- Reductions
+
+double dot(const double * a, const double * b, size_t n); // sum_i a_i*b_i
+double sumSqProd(const double * a, const double * b, size_t n); // sum_i (a_i*b_i)^2
+
+// --- Generic updates
+
+void axpy(double * y, const double * x, double alpha, size_t n); // y += alpha*x
+void square(double * y, const double * x, double alpha, size_t n); // y = (alpha*x)^2
+void ema(double * y, const double * x, double beta, size_t n); // y = beta*y + (1-beta)*x
+
+// --- Optimizer-specific updates (see the respective optimizers for the formulas)
+
+// Adam/AMSGrad moment updates and step x += afac*m/(sqrt(v) + eps)
+void adamStep(double * x, double * m, double * v, const double * g, size_t n,
+              double beta1, double beta2, double afac, double eps, bool amsgrad);
+
+// Adam first moment update and step, for one row of a factored second moment v_j = rowfac*c_j
+void adamStepFactored(double * x, double * m, const double * c, const double * g, size_t n,
+                      double beta1, double rowfac, double afac, double eps);
+
+// DynamicDescent updates (after the first step)
+void sgdmStep(double * x, double * v, const double * g, size_t n, double beta, double stepSize);
+void adagStep(double * x, double * v, const double * g, size_t n, double stepSize, double eps);
+void adadStep(double * x, double * v, double * w, const double * g, size_t n, double beta, double eps);
+void rmspStep(double * x, double * v, const double * g, size_t n, double beta, double stepSize, double eps);
+void nestStep(double * x, double * v, const double * g, size_t n, double beta, double stepSize);
+
+// Lion step x += stepSize*sign(c) with c = beta1*m + (1-beta1)*g, followed by m = beta2*m + (1-beta2)*g,
+// where sign(c) is 0 if |c| <= errfac*gerr_i (pass gerr = nullptr to disable)
+void lionStep(double * x, double * m, const double * g, const double * gerr, size_t n,
+              double beta1, double beta2, double stepSize, double errfac);
+
+// FIRE velocity mixing: v = (1-alpha)*v + c*a/d
+void fireMix(double * v, const double * a, size_t n, double alpha, double c, double d);
+
+// FIRE freezing: where fullFreeze or a_i*v_i < 0, set x_i -= backstep*v_i and v_i = 0
+void fireFreeze(double * x, double * v, const double * a, size_t n, bool fullFreeze, double backstep);
+
+// IRENE freezing: as above, but with the noisy condition a_i*v_i + sigmaLevel*aerr_i*|v_i| < 0
+void ireneFreeze(double * x, double * v, const double * a, const double * aerr, size_t n,
+                 bool fullFreeze, double backstep, double sigmaLevel);
+} // namespace vk
+} // namespace nfm
+
+#endif
@@ -0,0 +1,105 @@
+#include "nfm/AdaHessian.hpp"
+
+#include "nfm/LogManager.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace nfm
+{
+
+// --- Constructor
+
+AdaHessian::AdaHessian(const int ndim, const int nprobes, const double alpha):
+        NFM(ndim, true), _nprobes(std::max(1, nprobes)), _alpha(std::max(0., alpha))
+{
+    // override defaults
+    this->setGradErrStop(false); // don't stop on noisy-low gradients, by default
+}
+
+// --- Internal methods
+
+void AdaHessian::_estimateDiagonal(const std::vector<std::vector<double>> &zs, std::vector<NoisyGradient> &Hzs, std::vector<double> &D) const
+{
+    _hfun->hessVecBatch(_last.x, zs, Hzs);
+
+    // Hutchinson estimate
+    std::fill(D.begin(), D.end(), 0.);
+    for (size_t p = 0; p < zs.size(); ++p) {
+        for (int i = 0; i < _ndim; ++i) { D[i] += zs[p][i]*Hzs[p].val[i]; }
+    }
+    for (double &d : D) { d = fabs(d)/zs.size(); }
+
+    // spatial averaging
+    if (_blockSize > 1) {
+        for (int b = 0; b < _ndim; b += _blockSize) {
+            const int e = std::min(_ndim, b + _blockSize);
+            double avg = 0.;
+            for (int i = b; i < e; ++i) { avg += D[i]; }
+            avg /= (e - b);
+            std::fill(D.begin() + b, D.begin() + e, avg);
+        }
+    }
+}
+
+// --- Minimization
+
+void AdaHessian::_findMin()
+{
+    LogManager::logString("\nBegin AdaHessian::findMin() procedure\n");
+
+    const TargetFunGuard<NoisyFunctionWithHessVec> funGuard(_hfun, dynamic_cast<NoisyFunctionWithHessVec *>(_targetfun));
+    if (_hfun == nullptr) {
+        throw std::invalid_argument("[AdaHessian] The target function must be a NoisyFunctionWithHessVec.");
+    }
+
+    //initialize the vectors
+    const size_t nd = _grad.size();
+    std::vector<double> m(nd), v(nd); // moment vectors
+    std::vector<double> D(nd); // Hessian diagonal estimate
+    std::vector<std::vector<double>> zs(static_cast<size_t>(_nprobes), std::vector<double>(nd)); // probe vectors
+    std::vector<NoisyGradient> Hzs(zs.size(), NoisyGradient(_ndim)); // products H*z
+    std::mt19937_64 rgen(_seed);
+    std::bernoulli_distribution rdist;
+
+    //begin the minimization loop
+    double beta1t = 1.; // stores beta1^t
+    double beta2t = 1.; // stores beta2^t
+    int iter = 0;
+    while (true) {
+        ++iter;
+        if (LogManager::isLoggingOn()) { // else skip string construction
+            LogManager::logString("\nAdaHessian::findMin() Step " + std::to_string(iter) + "\n");
+        }
+
+        // compute current gradient and target value
+        _last.f = _hfun->fgrad(_last.x, _grad);
+        _hfun->setHessVecRefGrad(_last.x, _grad); // reference for the default Hessian-vector products
+        this->_storeLastValue();
+        this->_writeGradientToLog();
+        if (this->_shouldStop()) { break; }
+
+        // Hessian diagonal from Rademacher probes
+        for (auto &z : zs) {
+            for (double &zi : z) { zi = rdist(rgen) ? 1. : -1.; }
+        }
+        this->_estimateDiagonal(zs, Hzs, D);
+        LogManager::logVector(D, LogLevel::VERBOSE, "Hessian diagonal estimate", "D");
+
+        // update factors
+        beta1t = beta1t*_beta1; // update beta1 power
+        beta2t = beta2t*_beta2; // update beta2 power
+
+        // compute the update
+        for (int i = 0; i < _ndim; ++i) {
+            m[i] = _beta1*m[i] + (1. - _beta1)*_grad.val[i]; // Update biased first moment
+            v[i] = _beta2*v[i] + (1. - _beta2)*D[i]*D[i]; // Update biased second moment
+            const double denom = pow(sqrt(v[i]/(1. - beta2t)), _hessPower) + _epsilon;
+            _last.x[i] += _alpha*m[i]/((1. - beta1t)*denom); // update _last
+        }
+    }
+
+    LogManager::logString("\nEnd AdaHessian::findMin() procedure\n");
+}
+} // namespace nfm
@@ -1,13 +1,104 @@
 #include "nfm/Adam.hpp"
 
 #include "nfm/LogManager.hpp"
+#include "nfm/VecKernels.hpp"
 
 #include <algorithm>
 #include <cmath>
+#include <memory>
 
 namespace nfm
 {
 
+// Second moments of all blocks of a ParamLayout: factored (row and column statistics) for
+// matrix blocks and full (per element) for the others
+class Adam::FactoredSecondMoment
+{
+private:
+    static constexpr double _eps1 = 1.e-30; // added to the squared gradient means (avoids 0 rows)
+
+    const ParamLayout &_layout;
+    std::vector<size_t> _soff; // per block offset into _stats (matrix) or _v (vector)
+    std::vector<double> _stats; // per matrix block: rows x row means R, cols x column means C, rows x R/mean(R)
+    std::vector<double> _v; // full second moments of vector blocks (compact)
+    std::vector<double> _colacc; // temporary column accumulator
+
+public:
+    explicit FactoredSecondMoment(const ParamLayout &layout): _layout(layout)
+    {
+        size_t nstats = 0, nv = 0, maxcols = 0;
+        for (const auto &block : _layout.getBlocks()) {
+            if (block.isMatrix()) {
+                _soff.push_back(nstats);
+                nstats += 2*block.rows + block.cols;
+                maxcols = std::max(maxcols, static_cast<size_t>(block.cols));
+            }
+            else {
+                _soff.push_back(nv);
+                nv += block.size();
+            }
+        }
+        _stats.assign(nstats, 0.);
+        _v.assign(nv, 0.);
+        _colacc.resize(maxcols);
+    }
+
+    // update the row and column statistics with new gradient g
+    void updateStatistics(const double * g, const double beta2)
+    {
+        for (size_t ib = 0; ib < _soff.size(); ++ib) {
+            const auto &block = _layout.getBlock(static_cast<int>(ib));
+            if (!block.isMatrix()) { continue; }
+            const auto rows = static_cast<size_t>(block.rows), cols = static_cast<size_t>(block.cols);
+            double * R = _stats.data() + _soff[ib];
+            double * C = R + rows;
+            double * rowfac = C + cols;
+
+            std::fill(_colacc.begin(), _colacc.begin() + cols, 0.);
+            double Rsum = 0.;
+            for (size_t r = 0; r < rows; ++r) {
+                const double * grow = g + block.offset + r*cols;
+                R[r] = beta2*R[r] + (1. - beta2)*(vk::dot(grow, grow, cols)/cols + _eps1);
+                Rsum += R[r];
+                for (size_t c = 0; c < cols; ++c) { _colacc[c] += grow[c]*grow[c]; }
+            }
+            for (size_t c = 0; c < cols; ++c) { C[c] = beta2*C[c] + (1. - beta2)*(_colacc[c]/rows + _eps1); }
+            for (size_t r = 0; r < rows; ++r) { rowfac[r] = R[r]*rows/Rsum; } // v_rc = R_r*C_c/mean(R)
+        }
+    }
+
+    // Adam update of the elements [begin, end), with m pointing to the first moment of element begin
+    void step(double * x, double * m, const double * g, const size_t begin, const size_t end,
+              const double beta1, const double beta2, const double afac, const double eps)
+    {
+        // find the block containing begin
+        const auto &blocks = _layout.getBlocks();
+        auto ib = static_cast<size_t>(std::upper_bound(blocks.begin(), blocks.end(), begin,
+                                                       [](const size_t i, const ParamBlock &block) { return i < static_cast<size_t>(block.offset); })
+                                      - blocks.begin()) - 1;
+        for (size_t i = begin; i < end; ++ib) {
+            const auto &block = blocks[ib];
+            const size_t bend = std::min(end, static_cast<size_t>(block.offset + block.size()));
+            if (block.isMatrix()) { // row by row
+                const auto rows = static_cast<size_t>(block.rows), cols = static_cast<size_t>(block.cols);
+                const double * C = _stats.data() + _soff[ib] + rows;
+                const double * rowfac = C + cols;
+                while (i < bend) {
+                    const size_t k = i - block.offset, r = k/cols, c = k%cols;
+                    const size_t rend = std::min(bend, i + cols - c);
+                    vk::adamStepFactored(x + i, m + (i - begin), C + c, g + i, rend - i, beta1, rowfac[r], afac, eps);
+                    i = rend;
+                }
+            }
+            else {
+                vk::adamStep(x + i, m + (i - begin), _v.data() + _soff[ib] + (i - block.offset), g + i, bend - i,
+                             beta1, beta2, afac, eps, false);
+                i = bend;
+            }
+        }
+    }
+};
+
 // --- Constructor
 
 Adam::Adam(const int ndim, const bool useAveraging, const double alpha):
@@ -17,21 +108,196 @@ Adam::Adam(const int ndim, const bool useAveraging, const double alpha):
     this->setGradErrStop(false); // don't stop on noisy-low gradients, by default
 }
 
+Adam::~Adam() = default; // FactoredSecondMoment is complete here
+
 // --- Minimization
 
 void Adam::_findMin()
+{
+    if (_useLazyUpdates) { // separate implementation for sparse gradients
+        LogManager::logString("\nBegin Adam::findMin() procedure\n");
+        this->_findMinLazy();
+        LogManager::logString("\nEnd Adam::findMin() procedure\n");
+        return;
+    }
+    this->_findMinAskTell();
+}
+
+void Adam::_atBegin()
 {
     LogManager::logString("\nBegin Adam::findMin() procedure\n");
 
+    if (_useFactoredV && _useAMSGrad) {
+        throw std::invalid_argument("[Adam] Factored second moments can't be used with AMSGrad.");
+    }
+
+    //initialize the state vectors (at the configured precision), unless resuming from a checkpoint or continuing
+    const size_t nd = _grad.size();
+    if (!this->_isResuming() || !this->_isStateConsistent()) {
+        this->_initStateBuffer(_m, nd);
+        this->_initStateBuffer(_v, _useFactoredV ? 0 : nd, true);
+        // when averaging is enabled, holds the running average
+        this->_initStateBuffer(_xavg, _useAveraging ? nd : 0, this->_avgPrecision(), false);
+        _beta1t = 1.;
+        _beta2t = 1.;
+        _iter = 0;
+    }
+    _fv.reset(_useFactoredV ? new FactoredSecondMoment(this->getParamLayout()) : nullptr);
+    _flag_finalEval = false;
+
+    //begin the minimization loop
+    this->_requestNextStep();
+}
+
+void Adam::_requestNextStep()
+{
+    ++_iter;
+    if (LogManager::isLoggingOn()) { // else skip string construction
+        LogManager::logString("\nAdam::findMin() Step " + std::to_string(_iter) + "\n");
+    }
+    this->_requestEval(_last.x, true, true); // current gradient and target value
+}
+
+void Adam::_atResult()
+{
+    _last.f = _evalF;
+    if (_flag_finalEval) { // new final function value (averaging)
+        LogManager::logString("\nEnd Adam::findMin() procedure\n");
+        return;
+    }
+    _storeLastValue();
+    _writeGradientToLog();
+    if (_shouldStop()) {
+        if (_useAveraging) { // we need to update _last to the averaged x
+            _xavg.get(_last.x);
+            for (int i = 0; i < _ndim; ++i) {
+                _last.x[i] /= (1. - _beta2t); // bias corrected average
+            }
+            _flag_finalEval = true;
+            this->_requestEval(_last.x, true, false); // evaluate new final function value
+            return;
+        }
+        LogManager::logString("\nEnd Adam::findMin() procedure\n");
+        return;
+    }
+
+    // update factors
+    _beta1t = _beta1t*_beta1; // update beta1 power
+    _beta2t = _beta2t*_beta2; // update beta2 power
+    const double afac = _alpha*sqrt(1. - _beta2t)/(1. - _beta1t);
+
+    // compute the update (biased first and second raw moment, AMSGrad takes the max of second moments)
+    StateBuffer &m = _m, &v = _v, &xavg = _xavg;
+    FactoredSecondMoment * fv = _fv.get();
+    if (fv) { fv->updateStatistics(_grad.val.data(), _beta2); }
+    this->_parallelFor([&](const size_t begin, const size_t end)
+                       {
+                           if (fv) {
+                               updateBlockwise<1>({&m}, begin, end, [&](const size_t b0, const size_t len, const std::array<double *, 1> &mb)
+                               {
+                                   fv->step(_last.x.data(), mb[0], _grad.val.data(), b0, b0 + len, _beta1, _beta2, afac, _epsilon);
+                               });
+                           }
+                           else {
+                               updateBlockwise<2>({&m, &v}, begin, end, [&](const size_t b0, const size_t len, const std::array<double *, 2> &mv)
+                               {
+                                   vk::adamStep(_last.x.data() + b0, mv[0], mv[1], _grad.val.data() + b0,
+                                                len, _beta1, _beta2, afac, _epsilon, _useAMSGrad);
+                               });
+                           }
+                           if (_useAveraging) {
+                               updateBlockwise<1>({&xavg}, begin, end, [&](const size_t b0, const size_t len, const std::array<double *, 1> &xa)
+                               {
+                                   vk::ema(xa[0], _last.x.data() + b0, _beta2, len);
+                               });
+                           }
+                       });
+    this->_checkpoint();
+    this->_requestNextStep();
+}
+
+// --- Checkpoints
+
+void Adam::_writeState(StateWriter &out) const
+{
+    out.write(std::string("Adam"));
+    _m.write(out);
+    _v.write(out);
+    _xavg.write(out);
+    out.write(_beta1t);
+    out.write(_beta2t);
+    out.write(static_cast<int32_t>(_iter));
+}
+
+void Adam::_readState(StateReader &in)
+{
+    in.expectTag("Adam");
+    this->_readStateBuffer(in, _m);
+    this->_readStateBuffer(in, _v);
+    this->_readStateBuffer(in, _xavg, this->_avgPrecision());
+    _beta1t = in.read<double>();
+    _beta2t = in.read<double>();
+    _iter = in.read<int32_t>();
+
+    if (!this->_isStateConsistent()) {
+        throw std::invalid_argument("[Adam] Checkpoint state doesn't match the current configuration.");
+    }
+}
+
+void Adam::_decayState(const double decay)
+{
+    _m.scale(decay);
+    _v.scale(decay);
+    _xavg.scale(decay);
+    _beta1t = 1. - decay*(1. - _beta1t); // keeps the bias corrected moments
+    _beta2t = 1. - decay*(1. - _beta2t);
+}
+
+bool Adam::_isStateConsistent() const
+{
+    const size_t nd = _grad.size();
+    return _m.size() == nd && _v.size() == nd && _xavg.size() == (_useAveraging ? nd : 0);
+}
+
+StatePrecision Adam::_avgPrecision() const
+{
+    return (this->getStatePrecision() == StatePrecision::Double) ? StatePrecision::Double : StatePrecision::Float;
+}
+
+void Adam::_findMinLazy()
+{
+    auto * sparsefun = dynamic_cast<NoisyFunctionWithSparseGradient *>(_gradfun);
+    if (sparsefun == nullptr) {
+        throw std::invalid_argument("[Adam] Lazy updates require a NoisyFunctionWithSparseGradient.");
+    }
+    if (_useFactoredV) {
+        throw std::invalid_argument("[Adam] Factored second moments can't be used with lazy updates.");
+    }
+
     //initialize the vectors
     const size_t nd = _grad.size();
     std::vector<double> m(nd), v(nd); // moment vectors
     std::vector<double> xavg; // when averaging is enabled, holds the running average
     if (_useAveraging) { xavg.assign(nd, 0.); }
+    std::vector<int> tlast(nd, 0); // step of the last update of every coordinate
+    NoisySparseGradient sgrad, sgradOld; // new and last sparse gradient
+    _grad.zero();
+
+    // catch up the decay of k skipped steps (with zero gradient) for coordinate i
+    auto catchUp = [&](const size_t i, const int k)
+    {
+        m[i] *= pow(_beta1, k);
+        if (!_useAMSGrad) { v[i] *= pow(_beta2, k); } // AMSGrad keeps the maximum, i.e. v doesn't decay
+        if (_useAveraging) { // the position didn't change
+            const double beta2k = pow(_beta2, k);
+            xavg[i] = beta2k*xavg[i] + (1. - beta2k)*_last.x[i];
+        }
+    };
 
     //begin the minimization loop
     double beta1t = 1.; // stores beta1^t
     double beta2t = 1.; // stores beta2^t
+    double dx2 = 0.; // squared position change of the last step
     int iter = 0;
     while (true) {
         ++iter;
@@ -39,43 +305,46 @@ void Adam::_findMin()
             LogManager::logString("\nAdam::findMin() Step " + std::to_string(iter) + "\n");
         }
 
-        // compute current gradient and target value
-        _last.f = _gradfun->fgrad(_last.x, _grad);
-        _storeLastValue();
+        // compute current sparse gradient and target value
+        sgrad.clear();
+        _last.f = sparsefun->fsparseGrad(_last.x, sgrad);
+        this->_updateGradFromSparse(sgradOld, sgrad);
+        this->_storeLastValueSparse(dx2, false); // x history is not needed (own running average)
         _writeGradientToLog();
-        if (_shouldStop()) { break; }
+        if (this->_shouldStopSparse(sgrad)) { break; }
 
         // update factors
         beta1t = beta1t*_beta1; // update beta1 power
         beta2t = beta2t*_beta2; // update beta2 power
         const double afac = _alpha*sqrt(1. - beta2t)/(1. - beta1t);
 
-        // compute the update
-        for (int i = 0; i < _ndim; ++i) {
-            m[i] = _beta1*m[i] + (1. - _beta1)*_grad.val[i]; // Update biased first moment
-            const double vi_new = _beta2*v[i] + (1. - _beta2)*_grad.val[i]*_grad.val[i];
-            if (!_useAMSGrad) {
-                v[i] = vi_new; // Update biased second raw moment (ADAM)
-            }
-            else {
-                v[i] = std::max(v[i], vi_new); // Update biased second raw moment (AMSGrad)
-            }
+        // compute the update of the touched coordinates
+        dx2 = 0.;
+        for (size_t k = 0; k < sgrad.nnz(); ++k) {
+            const auto i = static_cast<size_t>(sgrad.idx[k]);
+            const double gi = sgrad.val[k];
+            const double xi = _last.x[i];
+            if (iter - 1 > tlast[i]) { catchUp(i, iter - 1 - tlast[i]); }
 
+            m[i] = _beta1*m[i] + (1. - _beta1)*gi; // Update biased first moment
+            const double vi_new = _beta2*v[i] + (1. - _beta2)*gi*gi;
+            v[i] = _useAMSGrad ? std::max(v[i], vi_new) : vi_new; // Update biased second raw moment (ADAM/AMSGrad)
             _last.x[i] += afac*m[i]/(sqrt(v[i]) + _epsilon); // update _last
-
             if (_useAveraging) {
                 xavg[i] = _beta2*xavg[i] + (1. - _beta2)*_last.x[i];
             }
+            dx2 += (_last.x[i] - xi)*(_last.x[i] - xi);
+            tlast[i] = iter;
         }
+        sgradOld.idx.swap(sgrad.idx); // only the indices are needed
     }
 
-    if (_useAveraging) { // we need to update _last to the averaged x
-        for (int i = 0; i < _ndim; ++i) {
+    if (_useAveraging) { // catch up all coordinates and update _last to the averaged x
+        for (size_t i = 0; i < nd; ++i) {
+            if (iter - 1 > tlast[i]) { catchUp(i, iter - 1 - tlast[i]); }
             _last.x[i] = xavg[i]/(1. - beta2t); // bias corrected average
         }
         _last.f = _gradfun->f(_last.x); // evaluate new final function value
     }
-
-    LogManager::logString("\nEnd Adam::findMin() procedure\n");
 }
 } // namespace nfm
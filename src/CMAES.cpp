@@ -0,0 +1,302 @@
+#include "nfm/CMAES.hpp"
+
+#include "nfm/LogManager.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+// --- Internal Functions
+
+// index of element (i,j), j<=i, in a packed (row-major) lower triangular matrix
+inline size_t packedIndex(const size_t i, const size_t j)
+{
+    return i*(i + 1)/2 + j;
+}
+
+// Cholesky decomposition C = A*A^T of a packed symmetric matrix C (A also packed)
+// Returns false if C is not (numerically) positive definite.
+inline bool packedCholesky(const std::vector<double> &C, std::vector<double> &A, const size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        const size_t ii = packedIndex(i, 0);
+        for (size_t j = 0; j <= i; ++j) {
+            const size_t jj = packedIndex(j, 0);
+            double sum = C[ii + j];
+            for (size_t k = 0; k < j; ++k) { sum -= A[ii + k]*A[jj + k]; } // contiguous rows i and j
+            if (i == j) {
+                if (sum <= 0.) { return false; }
+                A[ii + i] = sqrt(sum);
+            }
+            else {
+                A[ii + j] = sum/A[jj + j];
+            }
+        }
+    }
+    return true;
+}
+
+// combine two independent estimates of the same value (inverse-variance weighting)
+inline nfm::NoisyValue combineEstimates(const nfm::NoisyValue a, const nfm::NoisyValue b)
+{
+    if (a.err <= 0.) { return a; } // exact values need no combination
+    if (b.err <= 0.) { return b; }
+    const double wa = 1./(a.err*a.err);
+    const double wb = 1./(b.err*b.err);
+    return {(wa*a.val + wb*b.val)/(wa + wb), 1./sqrt(wa + wb)};
+}
+
+namespace nfm
+{
+
+// --- Constructor
+
+CMAES::CMAES(const int ndim, const double sigma0, const bool separable):
+        NFM(ndim, false), _sigma0((sigma0 > 0.) ? sigma0 : 0.5), _flag_sep(separable) {}
+
+// --- Strategy parameters
+
+int CMAES::_defaultLambda() const
+{
+    return 4 + static_cast<int>(3.*log(static_cast<double>(_ndim)));
+}
+
+void CMAES::_setPopulation(const int lambda)
+{
+    const double n = _ndim;
+    _lambda = std::max(2, lambda);
+    _mu = _lambda/2;
+
+    // recombination weights
+    _weights.resize(static_cast<size_t>(_mu));
+    for (int k = 0; k < _mu; ++k) { _weights[k] = log(_mu + 0.5) - log(k + 1.); }
+    const double wsum = std::accumulate(_weights.begin(), _weights.end(), 0.);
+    for (double &w : _weights) { w /= wsum; }
+    _mueff = 1./std::inner_product(_weights.begin(), _weights.end(), _weights.begin(), 0.);
+
+    // adaptation rates
+    _cs = (_mueff + 2.)/(n + _mueff + 5.);
+    _ds = 1. + 2.*std::max(0., sqrt((_mueff - 1.)/(n + 1.)) - 1.) + _cs;
+    _cc = (4. + _mueff/n)/(n + 4. + 2.*_mueff/n);
+    _c1 = 2./((n + 1.3)*(n + 1.3) + _mueff);
+    _cmu = std::min(1. - _c1, 2.*(_mueff - 2. + 1./_mueff)/((n + 2.)*(n + 2.) + _mueff));
+    if (_flag_sep) { // faster learning rates for the diagonal
+        _c1 *= (n + 2.)/3.;
+        _cmu = std::min(1. - _c1, _cmu*(n + 2.)/3.);
+    }
+    _chiN = sqrt(n)*(1. - 1./(4.*n) + 1./(21.*n*n));
+}
+
+// --- Minimization
+
+void CMAES::_findMin()
+{
+    LogManager::logString("\nBegin CMAES::findMin() procedure\n");
+
+    const auto n = static_cast<size_t>(_ndim);
+    std::mt19937_64 rgen(_seed);
+    std::normal_distribution<double> rnorm(0., 1.);
+
+    // distribution state
+    const int lambda0 = this->getLambda0();
+    const int maxLambda = std::max(lambda0, this->getMaxLambda());
+    this->_setPopulation(lambda0);
+    std::vector<double> mean = _last.x;
+    double sigma = _sigma0;
+    std::vector<double> ps(n), pc(n); // evolution paths
+    std::vector<double> C, A; // packed covariance and its Cholesky factor (full variant)
+    std::vector<double> Anew; // decomposition target, swapped into A only on success
+    std::vector<double> diagC, diagA; // covariance diagonal and its square root (separable variant)
+    if (_flag_sep) {
+        diagC.assign(n, 1.);
+        diagA.assign(n, 1.);
+    }
+    else {
+        C.assign(n*(n + 1)/2, 0.);
+        for (size_t i = 0; i < n; ++i) { C[packedIndex(i, i)] = 1.; }
+        A = C;
+        Anew = C;
+    }
+    int lastDecomp = 0; // generation of the last Cholesky decomposition
+
+    // population buffers
+    std::vector<std::vector<double>> zs, ys; // standard normal samples and their transformation (A*z)
+    std::vector<std::vector<double>> xs; // batch positions (population + mean)
+    std::vector<NoisyValue> fs; // batch values
+    std::vector<size_t> order; // population indices, sorted by value
+    std::vector<double> zmean(n), ymean(n);
+    std::vector<std::vector<double>> rxs; // re-evaluation batch
+    std::vector<NoisyValue> rfs;
+    std::vector<size_t> ridx;
+
+    //begin the minimization loop
+    int iter = 0;
+    while (true) {
+        ++iter;
+        if (LogManager::isLoggingOn()) { // else skip string construction
+            LogManager::logString("\nCMAES::findMin() Step " + std::to_string(iter) + "\n");
+        }
+
+        // sample the population
+        const auto lam = static_cast<size_t>(_lambda);
+        zs.resize(lam, std::vector<double>(n));
+        ys.resize(lam, std::vector<double>(n));
+        xs.resize(_flag_evalMean ? lam + 1 : lam, std::vector<double>(n));
+        for (size_t k = 0; k < lam; ++k) {
+            std::vector<double> &z = zs[k];
+            std::vector<double> &y = ys[k];
+            for (double &zi : z) { zi = rnorm(rgen); }
+            if (_flag_sep) {
+                for (size_t i = 0; i < n; ++i) { y[i] = diagA[i]*z[i]; }
+            }
+            else {
+                for (size_t i = 0; i < n; ++i) {
+                    const double * Ai = A.data() + packedIndex(i, 0);
+                    y[i] = std::inner_product(Ai, Ai + i + 1, z.begin(), 0.);
+                }
+            }
+            for (size_t i = 0; i < n; ++i) { xs[k][i] = mean[i] + sigma*y[i]; }
+        }
+        if (_flag_evalMean) { xs[lam] = mean; }
+
+        // evaluate everything as one batch
+        _targetfun->fbatch(xs, fs);
+
+        // rank the population
+        order.resize(lam);
+        std::iota(order.begin(), order.end(), 0);
+        auto byValue = [&fs](const size_t a, const size_t b) { return fs[a].val < fs[b].val; };
+        std::sort(order.begin(), order.end(), byValue);
+
+        // store current position
+        if (_flag_evalMean) {
+            _last.x = mean;
+            _last.f = fs[lam];
+        }
+        else {
+            _last.x = xs[order[0]];
+            _last.f = fs[order[0]];
+        }
+        this->_storeLastValue();
+        if (this->_shouldStop()) { break; }
+
+        // noise handling
+        int newLambda = _lambda;
+        if (_flag_noiseHandling) {
+            // samples which can't be distinguished from the selection boundary
+            double bval = 0.5*(fs[order[_mu - 1]].val + fs[order[_mu]].val);
+            ridx.clear();
+            for (size_t k = 0; k < lam; ++k) {
+                if (fs[k] == bval) { ridx.push_back(k); }
+            }
+
+            // re-evaluate those closest to the boundary (as one batch)
+            const auto maxNReeval = static_cast<size_t>(_reevalFrac*_lambda);
+            if (ridx.size() > maxNReeval) {
+                std::nth_element(ridx.begin(), ridx.begin() + maxNReeval, ridx.end(), [&](const size_t a, const size_t b)
+                {
+                    return fabs(fs[a].val - bval) < fabs(fs[b].val - bval);
+                });
+                ridx.resize(maxNReeval);
+            }
+            if (!ridx.empty()) {
+                rxs.resize(ridx.size());
+                for (size_t r = 0; r < ridx.size(); ++r) { rxs[r] = xs[ridx[r]]; }
+                _targetfun->fbatch(rxs, rfs);
+                for (size_t r = 0; r < ridx.size(); ++r) { fs[ridx[r]] = combineEstimates(fs[ridx[r]], rfs[r]); }
+                std::sort(order.begin(), order.end(), byValue);
+                bval = 0.5*(fs[order[_mu - 1]].val + fs[order[_mu]].val);
+            }
+
+            // uncertainty of the ranking decides about the population size
+            const auto nuncert = std::count_if(order.begin(), order.end(), [&](const size_t k) { return fs[k] == bval; });
+            const double uncert = static_cast<double>(nuncert)/_lambda;
+            if (uncert > _uncertThreshold) {
+                newLambda = std::min(maxLambda, static_cast<int>(ceil(_lambda*_popGrowth)));
+            }
+            else if (nuncert == 0) {
+                newLambda = std::max(lambda0, static_cast<int>(_lambda/_popGrowth));
+            }
+        }
+
+        // recombination
+        std::fill(zmean.begin(), zmean.end(), 0.);
+        std::fill(ymean.begin(), ymean.end(), 0.);
+        for (int k = 0; k < _mu; ++k) {
+            const std::vector<double> &z = zs[order[k]];
+            const std::vector<double> &y = ys[order[k]];
+            for (size_t i = 0; i < n; ++i) {
+                zmean[i] += _weights[k]*z[i];
+                ymean[i] += _weights[k]*y[i];
+            }
+        }
+        for (size_t i = 0; i < n; ++i) { mean[i] += sigma*ymean[i]; }
+
+        // evolution paths
+        const double fps = sqrt(_cs*(2. - _cs)*_mueff);
+        for (size_t i = 0; i < n; ++i) { ps[i] = (1. - _cs)*ps[i] + fps*zmean[i]; }
+        const double psnorm = sqrt(std::inner_product(ps.begin(), ps.end(), ps.begin(), 0.));
+        const bool hsig = psnorm/sqrt(1. - pow(1. - _cs, 2.*iter))/_chiN < 1.4 + 2./(_ndim + 1.);
+        const double fpc = hsig ? sqrt(_cc*(2. - _cc)*_mueff) : 0.;
+        for (size_t i = 0; i < n; ++i) { pc[i] = (1. - _cc)*pc[i] + fpc*ymean[i]; }
+
+        // covariance update (rank-one and rank-mu)
+        const double fold = 1. - _c1 - _cmu + (hsig ? 0. : _c1*_cc*(2. - _cc));
+        if (_flag_sep) {
+            for (size_t i = 0; i < n; ++i) {
+                double rankmu = 0.;
+                for (int k = 0; k < _mu; ++k) { rankmu += _weights[k]*ys[order[k]][i]*ys[order[k]][i]; }
+                diagC[i] = fold*diagC[i] + _c1*pc[i]*pc[i] + _cmu*rankmu;
+                diagA[i] = sqrt(diagC[i]);
+            }
+        }
+        else {
+            for (size_t i = 0; i < n; ++i) {
+                double * Ci = C.data() + packedIndex(i, 0);
+                for (size_t j = 0; j <= i; ++j) { Ci[j] = fold*Ci[j] + _c1*pc[i]*pc[j]; }
+                for (int k = 0; k < _mu; ++k) {
+                    const std::vector<double> &y = ys[order[k]];
+                    const double wyi = _cmu*_weights[k]*y[i];
+                    for (size_t j = 0; j <= i; ++j) { Ci[j] += wyi*y[j]; }
+                }
+            }
+            // lazy decomposition, as the covariance changes slowly
+            const int decompGap = std::max(1, static_cast<int>(1./(10.*_ndim*(_c1 + _cmu))));
+            if (iter - lastDecomp >= decompGap) {
+                bool success = packedCholesky(C, Anew, n);
+                if (!success) { // enforce positive definiteness
+                    for (size_t i = 0; i < n; ++i) { C[packedIndex(i, i)] += 1.e-10; }
+                    success = packedCholesky(C, Anew, n);
+                }
+                if (success) { A.swap(Anew); }
+                else { // keep the last factor and make C consistent with it again
+                    LogManager::logString("\nCMAES: Covariance lost positive definiteness, keeping the last decomposition.\n");
+                    for (size_t i = 0; i < n; ++i) {
+                        const double * Ai = A.data() + packedIndex(i, 0);
+                        for (size_t j = 0; j <= i; ++j) {
+                            const double * Aj = A.data() + packedIndex(j, 0);
+                            double cij = 0.;
+                            for (size_t k = 0; k <= j; ++k) { cij += Ai[k]*Aj[k]; }
+                            C[packedIndex(i, j)] = cij;
+                        }
+                    }
+                }
+                lastDecomp = iter;
+            }
+        }
+
+        // step size
+        sigma *= exp(std::min(1., (_cs/_ds)*(psnorm/_chiN - 1.)));
+
+        if (LogManager::isLoggingOn()) {
+            LogManager::logString("sigma = " + std::to_string(sigma) + ", lambda = " + std::to_string(_lambda) + "\n", LogLevel::VERBOSE);
+        }
+
+        // adapt population size
+        if (newLambda != _lambda) { this->_setPopulation(newLambda); }
+    }
+
+    LogManager::logString("\nEnd CMAES::findMin() procedure\n");
+}
+} // namespace nfm
@@ -0,0 +1,170 @@
+#include "nfm/Checkpoint.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+namespace nfm
+{
+
+// --- StateWriter
+
+void StateWriter::write(const std::vector<double> &vec)
+{
+    this->write(static_cast<uint64_t>(vec.size()));
+    this->writeArray(vec.data(), vec.size());
+}
+
+void StateWriter::write(const std::vector<int> &vec)
+{
+    this->write(static_cast<uint64_t>(vec.size()));
+    this->writeArray(vec.data(), vec.size());
+}
+
+void StateWriter::write(const std::string &str)
+{
+    this->write(static_cast<uint64_t>(str.size()));
+    this->writeArray(str.data(), str.size());
+}
+
+// --- StateReader
+
+uint64_t StateReader::readLength()
+{
+    const auto n = this->read<uint64_t>();
+    if (n > _data.size() - _pos) { // every element has at least one byte
+        throw std::invalid_argument("[StateReader] Invalid length in checkpoint data.");
+    }
+    return n;
+}
+
+void StateReader::read(std::vector<double> &vec)
+{
+    vec.resize(this->readLength());
+    this->readArray(vec.data(), vec.size());
+}
+
+void StateReader::read(std::vector<int> &vec)
+{
+    vec.resize(this->readLength());
+    this->readArray(vec.data(), vec.size());
+}
+
+void StateReader::read(std::vector<double> &vec, const size_t n)
+{
+    if (this->readLength() != n) {
+        throw std::invalid_argument("[StateReader] Vector length in checkpoint data doesn't match.");
+    }
+    vec.resize(n);
+    this->readArray(vec.data(), n);
+}
+
+std::string StateReader::readString()
+{
+    std::string str(this->readLength(), '\0');
+    this->readArray(&str[0], str.size());
+    return str;
+}
+
+void StateReader::expectTag(const std::string &tag)
+{
+    if (this->readString() != tag) {
+        throw std::invalid_argument("[StateReader] Checkpoint data doesn't contain the expected \"" + tag + "\" state.");
+    }
+}
+
+// --- AsyncFileWriter
+
+AsyncFileWriter::AsyncFileWriter()
+{
+    _thread = std::thread(&AsyncFileWriter::_writerLoop, this);
+}
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cvDone.wait(lock, [this] { return !_flag_pending && !_flag_busy; });
+        _flag_quit = true;
+    }
+    _cvWork.notify_one();
+    _thread.join();
+}
+
+void AsyncFileWriter::_writerLoop()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _cvWork.wait(lock, [this] { return _flag_pending || _flag_quit; });
+        if (!_flag_pending) { return; } // quit
+
+        const std::string path = _path;
+        const std::vector<char> data = std::move(_pending);
+        _flag_pending = false;
+        _flag_busy = true;
+        lock.unlock();
+
+        std::exception_ptr error;
+        try { writeFile(path, data); }
+        catch (...) { error = std::current_exception(); }
+
+        lock.lock();
+        if (error) { _error = error; }
+        _flag_busy = false;
+        _cvDone.notify_all();
+    }
+}
+
+void AsyncFileWriter::_rethrowError()
+{
+    if (_error) {
+        std::exception_ptr error = _error;
+        _error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void AsyncFileWriter::write(const std::string &path, std::vector<char> &&data)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        this->_rethrowError();
+        _path = path;
+        _pending = std::move(data); // replaces older pending data
+        _flag_pending = true;
+    }
+    _cvWork.notify_one();
+}
+
+void AsyncFileWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cvDone.wait(lock, [this] { return !_flag_pending && !_flag_busy; });
+    this->_rethrowError();
+}
+
+void AsyncFileWriter::writeFile(const std::string &path, const std::vector<char> &data)
+{
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        out.close();
+        if (!out) {
+            throw std::runtime_error("[AsyncFileWriter] Failed to write file " + tmpPath);
+        }
+    }
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("[AsyncFileWriter] Failed to rename " + tmpPath + " to " + path);
+    }
+}
+
+std::vector<char> AsyncFileWriter::readFile(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::invalid_argument("[AsyncFileWriter] Failed to open file " + path);
+    }
+    return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+} // namespace nfm
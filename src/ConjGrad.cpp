@@ -28,95 +28,187 @@ void ConjGrad::_writeCGDirectionToLog(const std::vector<double> &dir, const std:
 
 // --- Minimization
 
-void ConjGrad::_findMin()
+void ConjGrad::_atBegin()
 {
-    // --- Starting Position
-
     LogManager::logString("\nBegin ConjGrad::findMin() procedure\n");
 
-    // obtain the initial function value and gradient (uphill)
-    bool flag_cont = this->_computeGradient(true); // compute grad and value
-    if (!flag_cont) { return; } // return early
+    if (!this->_isResuming() || !this->_isStateConsistent()) {
+        _phase = Phase::InitGrad;
+        this->_requestEval(_last.x, true, true); // obtain the initial function value and gradient (uphill)
+    }
+    else if (this->_isContinuing()) { // the target may have changed
+        _phase = Phase::RefreshGrad;
+        this->_requestEval(_last.x, true, true);
+    }
+    else {
+        this->_requestNextStep();
+    }
+}
+
+void ConjGrad::_atResult()
+{
+    std::vector<double> &gradnew = _grad.val; // store reference to gradient values
 
+    switch (_phase) {
+    case Phase::InitGrad: {
+        _last.f = _evalF;
+        this->_storeLastValue();
+        if (!this->_checkGradient()) { return; } // return early
 
-    // --- Initialize CG
+        // --- Initialize CG
 
-    // initialize gradient vectors and length
-    std::vector<double> &gradnew = _grad.val; // store reference to gradient values
-    std::vector<double> conjv = gradnew; // stores the conjugate vectors, initialize with raw gradient
-    std::vector<double> gradold; // the previous inverted gradients (only used for Polak-Ribiere CG)
+        // initialize gradient vectors and length
+        _conjv = gradnew; // initialize with raw gradient
+        _gradold.clear();
 
-    // save old gradient for PR-CG
-    if (_cgmode == CGMode::CGPR || _cgmode == CGMode::CGPR0) {
-        gradold = gradnew; // initialize old gradient
+        // save old gradient for PR-CG
+        if (_cgmode == CGMode::CGPR || _cgmode == CGMode::CGPR0) {
+            _gradold = gradnew; // initialize old gradient
+        }
+        _gdot_old = this->_parallelSum([&](const size_t begin, const size_t end)
+                                       { return std::inner_product(gradnew.begin() + begin, gradnew.begin() + end, gradnew.begin() + begin, 0.); });
+
+        // find initial new position
+        LogManager::logString("\nConjGrad::findMin() Step 1\n");
+        _iter = 1;
+        this->_beginLineSearch();
+        return;
     }
-    // the denominator of CG update ratio
-    double gdot_old = std::inner_product(gradnew.begin(), gradnew.end(), gradnew.begin(), 0.);
-
-    // find initial new position
-    LogManager::logString("\nConjGrad::findMin() Step 1\n");
-    this->_findNextX(conjv);
+    case Phase::RefreshGrad:
+        _last.f = _evalF;
+        // relate the CG ratio to the new gradient, i.e. the first new direction is gradient + decay * old direction
+        // (Polak-Ribiere: gradient only)
+        if (!_gradold.empty()) { _gradold = gradnew; }
+        _gdot_old = this->_parallelSum([&](const size_t begin, const size_t end)
+                                       { return std::inner_product(gradnew.begin() + begin, gradnew.begin() + end, gradnew.begin() + begin, 0.); });
+        // the refreshed gradient is the one of the first new step
+        if (!this->_beginStep() || !this->_checkGradient()) { return; }
+        this->_updateDirection();
+        this->_beginLineSearch();
+        return;
+
+    case Phase::Grad:
+        if (!this->_checkGradient()) { return; } // gradient is only noise
+        this->_updateDirection();
+        this->_beginLineSearch();
+        return;
+
+    case Phase::Line:
+        _lineSearch->report(_evalF);
+        if (!_lineSearch->isDone()) {
+            this->_requestLinePoint();
+            return;
+        }
+        // store result in last (the old position is kept if the line-search failed)
+        if (_lineSearch->isSuccess()) { std::swap(_last.x, _xline); } // _xline holds the position of the result
+        _last.f = _lineSearch->getResult().f;
+        this->_storeLastValue();
+        this->_checkpoint();
+        this->_requestNextStep();
+        return;
+    }
+}
 
+bool ConjGrad::_beginStep()
+{
+    if (this->_shouldStop()) {
+        LogManager::logString("\nEnd ConjGrad::findMin() procedure\n");
+        return false;
+    }
+    ++_iter;
+    if (LogManager::isLoggingOn()) { // else skip string construction
+        LogManager::logString("\nConjGrad::findMin() Step " + std::to_string(_iter) + "\n");
+    }
+    return true;
+}
 
-    // --- Main CG Loop
+void ConjGrad::_requestNextStep()
+{
+    if (!this->_beginStep()) { return; }
+    _phase = Phase::Grad;
+    this->_requestEval(_last.x, false, true); // evaluate the new gradient
+}
 
-    int iter = 1;
-    while (!this->_shouldStop()) {
-        ++iter;
-        if (LogManager::isLoggingOn()) { // else skip string construction
-            LogManager::logString("\nConjGrad::findMin() Step " + std::to_string(iter) + "\n");
-        }
+void ConjGrad::_updateDirection()
+{
+    std::vector<double> &gradnew = _grad.val;
+    std::vector<double> &conjv = _conjv;
+    std::vector<double> &gradold = _gradold;
 
-        // evaluate the new gradient
-        flag_cont = this->_computeGradient(false);
-        if (!flag_cont) { return; } // gradient is only noise
+    if (_cgmode == CGMode::NOCG) { // use raw gradient (i.e. steepest descent)
+        std::copy(gradnew.begin(), gradnew.end(), conjv.begin());
+    }
+    else { // use conjugate gradients
+        const double gdot_new = this->_parallelSum([&](const size_t begin, const size_t end)
+                                                   { return std::inner_product(gradnew.begin() + begin, gradnew.begin() + end, gradnew.begin() + begin, 0.); });
 
-        // compute the next direction to follow
-        if (_cgmode == CGMode::NOCG) { // use raw gradient (i.e. steepest descent)
-            std::copy(gradnew.begin(), gradnew.end(), conjv.begin());
+        double ratio; // CG update factor
+        if (_cgmode == CGMode::CGFR) { // Fletcher-Reeves CG
+            ratio = _gdot_old != 0 ? gdot_new/_gdot_old : 0.;
         }
-        else { // use conjugate gradients
-            const double gdot_new = std::inner_product(gradnew.begin(), gradnew.end(), gradnew.begin(), 0.);
-
-            double ratio; // CG update factor
-            if (_cgmode == CGMode::CGFR) { // Fletcher-Reeves CG
-                ratio = gdot_old != 0 ? gdot_new/gdot_old : 0.;
-            }
-            else { // Polak-Ribiere CG
-                double prprod = 0.;
-                for (int i = 0; i < _ndim; ++i) { prprod += gradnew[i]*(gradnew[i] - gradold[i]); }
-                ratio = gdot_old != 0 ? prprod/gdot_old : 0.;
-                if (_cgmode == CGMode::CGPR0) { ratio = std::max(0., ratio); } // CG reset
-                gradold = gradnew; // gradient old to new
-            }
-            gdot_old = gdot_new; // gdot old to new
-
-            // update conjugate gradients
-            for (int i = 0; i < _ndim; ++i) {
-                conjv[i] = gradnew[i] + ratio*conjv[i];
-            }
-            this->_writeCGDirectionToLog(conjv, "Conjugated vectors");
+        else { // Polak-Ribiere CG
+            const double prprod = this->_parallelSum([&](const size_t begin, const size_t end)
+                                                     {
+                                                         double sum = 0.;
+                                                         for (size_t i = begin; i < end; ++i) { sum += gradnew[i]*(gradnew[i] - gradold[i]); }
+                                                         return sum;
+                                                     });
+            ratio = _gdot_old != 0 ? prprod/_gdot_old : 0.;
+            if (_cgmode == CGMode::CGPR0) { ratio = std::max(0., ratio); } // CG reset
+            gradold = gradnew; // gradient old to new
         }
+        _gdot_old = gdot_new; // gdot old to new
+
+        // update conjugate gradients
+        this->_parallelFor([&](const size_t begin, const size_t end)
+                           {
+                               for (size_t i = begin; i < end; ++i) { conjv[i] = gradnew[i] + ratio*conjv[i]; }
+                           });
+        this->_writeCGDirectionToLog(conjv, "Conjugated vectors");
+    }
+}
 
-        // find new position and continue loop
-        this->_findNextX(conjv);
+
+// --- Checkpoints
+
+void ConjGrad::_writeState(StateWriter &out) const
+{
+    out.write(std::string("ConjGrad"));
+    out.write(_conjv);
+    out.write(_gradold);
+    out.write(_gdot_old);
+    out.write(static_cast<int32_t>(_iter));
+}
+
+void ConjGrad::_readState(StateReader &in)
+{
+    in.expectTag("ConjGrad");
+    in.read(_conjv, _grad.size());
+    in.read(_gradold);
+    _gdot_old = in.read<double>();
+    _iter = in.read<int32_t>();
+
+    if (!this->_isStateConsistent()) {
+        throw std::invalid_argument("[ConjGrad] Checkpoint state doesn't match the current configuration.");
     }
+}
+
+void ConjGrad::_decayState(const double decay)
+{
+    for (double &ci : _conjv) { ci *= decay; }
+}
 
-    LogManager::logString("\nEnd ConjGrad::findMin() procedure\n");
+bool ConjGrad::_isStateConsistent() const
+{
+    const bool usesOldGrad = (_cgmode == CGMode::CGPR || _cgmode == CGMode::CGPR0);
+    return _conjv.size() == _grad.size() && _gradold.size() == (usesOldGrad ? _grad.size() : 0);
 }
 
 
 // --- Internal methods
 
-bool ConjGrad::_computeGradient(const bool flag_value)
+bool ConjGrad::_checkGradient()
 {
-    if (flag_value) { // value and gradient
-        _last.f = _gradfun->fgrad(_last.x, _grad);
-        this->_storeLastValue();
-    }
-    else { // only gradient
-        _gradfun->grad(_last.x, _grad);
-    }
     this->_writeGradientToLog();
     if (this->_isGradNoisySmall()) { // we directly check and print the exit message here
         LogManager::logString("\nEnd ConjGrad::findMin() procedure\n");
@@ -125,14 +217,27 @@ bool ConjGrad::_computeGradient(const bool flag_value)
     return true;
 }
 
-void ConjGrad::_findNextX(const std::vector<double> &dir)
+void ConjGrad::_beginLineSearch()
 {
     // use NFM tolerances for MLM
     _mlmParams.epsx = this->getEpsX();
     _mlmParams.epsf = this->getEpsF();
 
-    // do line-minimization and store result in last
-    _last = nfm::multiLineMin(*_targetfun, _last, dir, _mlmParams);
-    this->_storeLastValue();
+    // line-minimization along the conjugate vectors, starting from last (see multiLineMin)
+    _lineSearch.reset(new LineSearch(_last.f, _mlmParams));
+    _xline.resize(_last.x.size());
+    _phase = Phase::Line;
+    this->_requestLinePoint();
+}
+
+void ConjGrad::_requestLinePoint()
+{
+    double t;
+    _lineSearch->nextPoint(t);
+    this->_parallelFor([&](const size_t begin, const size_t end)
+                       {
+                           for (size_t i = begin; i < end; ++i) { _xline[i] = _last.x[i] + t*_conjv[i]; }
+                       });
+    this->_requestEval(_xline, true, false);
 }
 } // namespace nfm
@@ -1,6 +1,7 @@
 #include "nfm/DynamicDescent.hpp"
 
 #include "nfm/LogManager.hpp"
+#include "nfm/VecKernels.hpp"
 
 #include <numeric>
 #include <cmath>
@@ -18,17 +19,140 @@ DynamicDescent::DynamicDescent(const int ndim, const DDMode ddmode, const bool u
 // --- Minimization
 
 void DynamicDescent::_findMin()
+{
+    if (_useLazyUpdates) { // separate implementation for sparse gradients
+        LogManager::logString("\nBegin DynamicDescent::findMin() procedure\n");
+        this->_findMinLazy();
+        LogManager::logString("\nEnd DynamicDescent::findMin() procedure\n");
+        return;
+    }
+    this->_findMinAskTell();
+}
+
+void DynamicDescent::_atBegin()
 {
     LogManager::logString("\nBegin DynamicDescent::findMin() procedure\n");
 
-    // vectors used for SGD updates
-    std::vector<double> v(_grad.size()); // helper vector used by all methods
-    std::vector<double> w; // only used by AdaDelta
-    if (_ddmode == DDMode::ADAD) {
-        w = v; // v is already all 0
+    // state vectors used for SGD updates (at the configured precision), unless resuming from a checkpoint or continuing
+    if (!this->_isResuming() || !this->_isStateConsistent()) {
+        const bool vNonNeg = (_ddmode == DDMode::ADAG || _ddmode == DDMode::ADAD || _ddmode == DDMode::RMSP); // v holds squares
+        this->_initStateBuffer(_v, _grad.size(), vNonNeg);
+        this->_initStateBuffer(_w, (_ddmode == DDMode::ADAD) ? _grad.size() : 0, true);
+        _iter = 0;
+    }
+    _flag_finalEval = false;
+
+    //begin the minimization loop
+    this->_requestNextStep();
+}
+
+void DynamicDescent::_requestNextStep()
+{
+    ++_iter;
+    if (LogManager::isLoggingOn()) { // else skip string construction
+        LogManager::logString("\nDynamicDescent::findMin() Step " + std::to_string(_iter) + "\n");
+    }
+    this->_requestEval(_last.x, true, true); // the gradient and current target
+}
+
+void DynamicDescent::_atResult()
+{
+    _last.f = _evalF;
+    if (_flag_finalEval) { // value at the averaged position
+        LogManager::logString("\nEnd DynamicDescent::findMin() procedure\n");
+        return;
+    }
+    this->_storeLastValue();
+    this->_writeGradientToLog();
+
+    if (this->_shouldStop()) { // we are done
+        if (_useAveraging) { // calculate the old value average as end result
+            this->_averageOldX();
+            _flag_finalEval = true;
+            this->_requestEval(_last.x, true, false);
+            return;
+        }
+        LogManager::logString("\nEnd DynamicDescent::findMin() procedure\n");
+        return;
+    }
+
+    // find the next position
+    this->_findNextX(_iter, _v, _w);
+    this->_checkpoint();
+    this->_requestNextStep();
+}
+
+// --- Checkpoints
+
+void DynamicDescent::_writeState(StateWriter &out) const
+{
+    out.write(std::string("DynamicDescent"));
+    _v.write(out);
+    _w.write(out);
+    out.write(static_cast<int32_t>(_iter));
+}
+
+void DynamicDescent::_readState(StateReader &in)
+{
+    in.expectTag("DynamicDescent");
+    this->_readStateBuffer(in, _v);
+    this->_readStateBuffer(in, _w);
+    _iter = in.read<int32_t>();
+
+    if (!this->_isStateConsistent()) {
+        throw std::invalid_argument("[DynamicDescent] Checkpoint state doesn't match the current configuration.");
+    }
+}
+
+void DynamicDescent::_decayState(const double decay)
+{
+    _v.scale(decay);
+    _w.scale(decay);
+}
+
+bool DynamicDescent::_isStateConsistent() const
+{
+    const bool vNonNeg = (_ddmode == DDMode::ADAG || _ddmode == DDMode::ADAD || _ddmode == DDMode::RMSP);
+    return _v.size() == _grad.size() && _v.isNonNegative() == vNonNeg
+           && _w.size() == ((_ddmode == DDMode::ADAD) ? _grad.size() : 0);
+}
+
+// --- Internal methods
+
+void DynamicDescent::_catchUp(const size_t i, const int k, std::vector<double> &v)
+{
+    switch (_ddmode) {
+    case DDMode::SGDM: { // x moved by sum_{j=1..k} beta^j * v, while v decayed by beta^k
+        const double betak = pow(_beta, k);
+        _last.x[i] += (_beta < 1.) ? _beta*(1. - betak)/(1. - _beta)*v[i] : k*v[i];
+        v[i] *= betak;
+        break;
+    }
+    case DDMode::RMSP: // x didn't move
+        v[i] *= pow(_beta, k);
+        break;
+    default: // nothing to do for AdaGrad
+        break;
+    }
+}
+
+void DynamicDescent::_findMinLazy()
+{
+    auto * sparsefun = dynamic_cast<NoisyFunctionWithSparseGradient *>(_gradfun);
+    if (sparsefun == nullptr) {
+        throw std::invalid_argument("[DynamicDescent] Lazy updates require a NoisyFunctionWithSparseGradient.");
+    }
+    if (_ddmode == DDMode::ADAD || _ddmode == DDMode::NEST) {
+        throw std::invalid_argument("[DynamicDescent] Lazy updates are only available for SGDM, AdaGrad and RMSProp.");
     }
 
+    std::vector<double> v(_grad.size()); // helper vector used by all methods
+    std::vector<int> tlast(_grad.size(), 0); // step of the last update of every coordinate
+    NoisySparseGradient sgrad, sgradOld; // new and last sparse gradient
+    _grad.zero();
+
     //begin the minimization loop
+    double dx2 = 0.; // squared position change of the last step
     int iter = 0;
     while (true) {
         ++iter;
@@ -36,95 +160,117 @@ void DynamicDescent::_findMin()
             LogManager::logString("\nDynamicDescent::findMin() Step " + std::to_string(iter) + "\n");
         }
 
-        // compute the gradient and current target
-        this->_updateTarget();
-        if (this->_shouldStop()) { break; } // we are done
+        // compute the sparse gradient and current target
+        sgrad.clear();
+        _last.f = sparsefun->fsparseGrad(_last.x, sgrad);
+        this->_updateGradFromSparse(sgradOld, sgrad);
+        this->_storeLastValueSparse(dx2, _useAveraging); // the x history is needed only for averaging
+        this->_writeGradientToLog();
+        if (this->_shouldStopSparse(sgrad)) { break; } // we are done
 
-        // find the next position
-        this->_findNextX(iter, v, w);
+        // update the touched coordinates
+        dx2 = 0.;
+        for (size_t k = 0; k < sgrad.nnz(); ++k) {
+            const auto i = static_cast<size_t>(sgrad.idx[k]);
+            const double gi = sgrad.val[k];
+            const double xi = _last.x[i];
+            if (iter - 1 > tlast[i]) { this->_catchUp(i, iter - 1 - tlast[i], v); }
+
+            switch (_ddmode) {
+            case DDMode::SGDM:
+                v[i] = _beta*v[i] + _stepSize*gi;
+                _last.x[i] += v[i];
+                break;
+            case DDMode::ADAG:
+                v[i] += gi*gi;
+                _last.x[i] += _stepSize/(sqrt(v[i]) + _epsilon)*gi;
+                break;
+            default: // RMSP, with first step as grad desc
+                if (iter > 1) {
+                    v[i] = _beta*v[i] + (1. - _beta)*(gi*gi);
+                    _last.x[i] += _stepSize*gi/(sqrt(v[i]) + _epsilon);
+                }
+                else {
+                    v[i] = gi*gi;
+                    _last.x[i] += _stepSize*gi;
+                }
+            }
+            dx2 += (_last.x[i] - xi)*(_last.x[i] - xi);
+            tlast[i] = iter;
+        }
+        sgradOld.idx.swap(sgrad.idx); // only the indices are needed
     }
 
     if (_useAveraging) { // calculate the old value average as end result
         this->_averageOldValues(); // perform average and store it in last
     }
-
-    LogManager::logString("\nEnd DynamicDescent::findMin() procedure\n");
+    else if (_ddmode == DDMode::SGDM) { // apply the pending momentum moves (to the last performed step)
+        for (size_t i = 0; i < v.size(); ++i) {
+            if (iter - 1 > tlast[i]) { this->_catchUp(i, iter - 1 - tlast[i], v); }
+        }
+        _last.f = _gradfun->f(_last.x); // evaluate new final function value
+    }
 }
 
-// --- Internal methods
-
-void DynamicDescent::_updateTarget()
+void DynamicDescent::_findNextX(const int iter, StateBuffer &v, StateBuffer &w)
 {
-    _last.f = _gradfun->fgrad(_last.x, _grad);
-    this->_storeLastValue();
-    this->_writeGradientToLog();
+    const auto n = static_cast<size_t>(_ndim);
+    if (_ddmode == DDMode::ADAD) {
+        updateBlockwise<2>({&v, &w}, 0, n, [&](const size_t b0, const size_t len, const std::array<double *, 2> &vw)
+        {
+            this->_findNextXBlock(iter, b0, len, vw[0], vw[1]);
+        });
+    }
+    else {
+        updateBlockwise<1>({&v}, 0, n, [&](const size_t b0, const size_t len, const std::array<double *, 1> &vb)
+        {
+            this->_findNextXBlock(iter, b0, len, vb[0], nullptr);
+        });
+    }
 }
 
-void DynamicDescent::_findNextX(const int iter, std::vector<double> &v, std::vector<double> &w)
+void DynamicDescent::_findNextXBlock(const int iter, const size_t b0, const size_t n, double * v, double * w)
 {
-    const std::vector<double> &gradv = _grad.val; // we need only the values
+    const double * gradv = _grad.val.data() + b0; // we need only the values
+    double * x = _last.x.data() + b0;
 
-    // compute update
+    // compute update (see VecKernels.hpp for the kernels)
     switch (_ddmode) {
     case DDMode::SGDM:
-        for (int i = 0; i < _ndim; ++i) {
-            v[i] = _beta*v[i] + _stepSize*gradv[i];
-            _last.x[i] += v[i];
-        }
+        vk::sgdmStep(x, v, gradv, n, _beta, _stepSize);
         break;
 
     case DDMode::ADAG:
-        for (int i = 0; i < _ndim; ++i) {
-            v[i] += gradv[i]*gradv[i];
-            _last.x[i] += _stepSize/(sqrt(v[i]) + _epsilon)*gradv[i];
-        }
+        vk::adagStep(x, v, gradv, n, _stepSize, _epsilon);
         break;
 
     case DDMode::ADAD:
         if (iter > 1) {
-            for (int i = 0; i < _ndim; ++i) {
-                v[i] = _beta*v[i] + (1. - _beta)*(gradv[i]*gradv[i]);
-                const double dx = gradv[i]*(sqrt(w[i]) + _epsilon)/(sqrt(v[i]) + _epsilon);
-                _last.x[i] += dx;
-                w[i] = _beta*w[i] + (1. - _beta)*(dx*dx);
-            }
+            vk::adadStep(x, v, w, gradv, n, _beta, _epsilon);
         }
         else { // first step
-            for (int i = 0; i < _ndim; ++i) {
-                v[i] = gradv[i]*gradv[i];
-                const double dx = _stepSize*gradv[i]; // initially we use the stepSize
-                _last.x[i] += dx;
-                w[i] = dx*dx;
-            }
+            vk::square(v, gradv, 1., n);
+            vk::axpy(x, gradv, _stepSize, n); // initially we use the stepSize
+            vk::square(w, gradv, _stepSize, n);
         }
         break;
 
     case DDMode::RMSP: // standard RMSProp with first step as grad desc
         if (iter > 1) {
-            for (int i = 0; i < _ndim; ++i) {
-                v[i] = _beta*v[i] + (1. - _beta)*(gradv[i]*gradv[i]);
-                _last.x[i] += _stepSize*gradv[i]/(sqrt(v[i]) + _epsilon);
-            }
+            vk::rmspStep(x, v, gradv, n, _beta, _stepSize, _epsilon);
         }
         else { // first step
-            for (int i = 0; i < _ndim; ++i) {
-                v[i] = gradv[i]*gradv[i];
-                _last.x[i] += _stepSize*gradv[i];
-            }
+            vk::square(v, gradv, 1., n);
+            vk::axpy(x, gradv, _stepSize, n);
         }
         break;
 
     case DDMode::NEST: // Bengio update with first step as grad desc
         if (iter > 1) {
-            for (int i = 0; i < _ndim; ++i) {
-                _last.x[i] += _beta*_beta*v[i] + (1. + _beta)*_stepSize*gradv[i];
-                v[i] = _beta*v[i] + _stepSize*gradv[i];
-            }
+            vk::nestStep(x, v, gradv, n, _beta, _stepSize);
         }
         else { // first step
-            for (int i = 0; i < _ndim; ++i) {
-                _last.x[i] += _stepSize*gradv[i];
-            }
+            vk::axpy(x, gradv, _stepSize, n);
         }
     }
 }
@@ -1,6 +1,7 @@
 #include "nfm/FIRE.hpp"
 
 #include "nfm/LogManager.hpp"
+#include "nfm/VecKernels.hpp"
 
 #include <cmath>
 
@@ -18,106 +19,231 @@ FIRE::FIRE(const int ndim, const double dtmax, const double dt0):
 
 // --- Minimization
 
-void FIRE::_findMin()
-{
-    LogManager::logString("\nBegin FIRE::findMin() procedure\n");
-
-    // helper variables
-    std::vector<double> v(_grad.size()); // velocity vector
-    std::vector<double> a(_grad.size()); // acceleration vector (F*mi)
-    std::function<void()> update = [&]()
-    { // MD force update lambda
-        _last.f = _gradfun->fgrad(_last.x, _grad);
-        md::computeAcceleration(_grad.val, _mi, a);
-    };
-    md::MDView mdview{.x = _last.x, .v = v, .a = a, .update = update}; // references for MD integrator
-
-    double dt = _dt0; // current time-step
-    double alpha = _alpha0; // current mixing factor
-    int Npos = 0; // number of steps since "F.v" was negative
-    int Nmin = 0; // number of steps since dt = dtmin
-
-    // initial step
-    if (!this->_initializeMD(mdview, dt)) { return; } // return if shouldStop() already
-
-    //begin the minimization loop
-    int iter = 0;
-    while (true) {
-        ++iter;
-        if (LogManager::isLoggingOn()) { // else skip string construction
-            LogManager::logString("\nFIRE::findMin() Step " + std::to_string(iter) + "\n");
-        }
+void FIRE::_atBegin()
+{
+    LogManager::logString("\nBegin " + _logName + "::findMin() procedure\n");
+    this->_resolveMDStage();
 
-        // compute the gradient and current target
-        this->_updateTarget(mdview, dt);
-        if (this->_isNDtMinReached(Nmin) || this->_shouldStop()) { break; } // we are done
+    if (!this->_isResuming() || !this->_isStateConsistent()) {
+        this->_initializeState();
+        _phase = Phase::Init;
+        this->_requestEval(_last.x, true, true); // compute initial force
+    }
+    else if (this->_isContinuing()) { // the target may have changed
+        _phase = Phase::Refresh;
+        this->_requestEval(_last.x, true, true);
+    }
+    else {
+        this->_beginMDStep();
+    }
+}
 
-        // update vector lengths and P
-        const double vnorm = sqrt(std::inner_product(v.begin(), v.end(), v.begin(), 0.));
-        const double anorm = sqrt(std::inner_product(a.begin(), a.end(), a.begin(), 0.));
-        const double P = std::inner_product(a.begin(), a.end(), v.begin(), 0.);
+void FIRE::_atResult()
+{
+    _last.f = _evalF;
+    this->_updateForce();
 
-        // velocity mixing
-        for (int i = 0; i < _ndim; ++i) {
-            v[i] = (1. - alpha)*v[i] + alpha*vnorm*a[i]/anorm;
+    switch (_phase) {
+    case Phase::Init:
+        if (!this->_initializeMD(_v, _a, _dt)) { return; } // return if shouldStop() already
+        break;
+    case Phase::Refresh:
+        break;
+    case Phase::MDStep:
+        (this->*_mdStageFun)(++_mdStage);
+        if (_mdStage < _mdNUpdates) { // the integrator needs more force updates
+            this->_requestEval(_last.x, true, true);
+            return;
         }
+        this->_storeLastValue();
+        this->_writeGradientToLog();
+        if (!this->_processMDStep()) { // we are done
+            LogManager::logString("\nEnd " + _logName + "::findMin() procedure\n");
+            return;
+        }
+        this->_checkpoint();
+        break;
+    }
+    this->_beginMDStep();
+}
+
+void FIRE::_beginMDStep()
+{
+    ++_iter;
+    if (LogManager::isLoggingOn()) { // else skip string construction
+        LogManager::logString("\n" + _logName + "::findMin() Step " + std::to_string(_iter) + "\n");
+    }
+    _phase = Phase::MDStep;
+    _mdStage = 0;
+    (this->*_mdStageFun)(0);
+    this->_requestEval(_last.x, true, true);
+}
+
+void FIRE::_resolveMDStage()
+{
+    switch (_mdi) {
+    case md::Integrator::EulerE:
+        _mdStageFun = _flag_fire2 ? &FIRE::_doMDStage<md::Integrator::EulerE, true> : &FIRE::_doMDStage<md::Integrator::EulerE, false>;
+        break;
+    case md::Integrator::EulerSI:
+        _mdStageFun = _flag_fire2 ? &FIRE::_doMDStage<md::Integrator::EulerSI, true> : &FIRE::_doMDStage<md::Integrator::EulerSI, false>;
+        break;
+    case md::Integrator::VerletV:
+        _mdStageFun = _flag_fire2 ? &FIRE::_doMDStage<md::Integrator::VerletV, true> : &FIRE::_doMDStage<md::Integrator::VerletV, false>;
+        break;
+    case md::Integrator::ForestRuth:
+        _mdStageFun = _flag_fire2 ? &FIRE::_doMDStage<md::Integrator::ForestRuth, true> : &FIRE::_doMDStage<md::Integrator::ForestRuth, false>;
+        break;
+    }
+    _mdNUpdates = md::getNForceUpdates(_mdi);
+}
+
+template <md::Integrator MDI, bool FIRE2>
+void FIRE::_doMDStage(const int stage)
+{
+    md::NoUpdate noUpdate; // the forces are updated between the stages
+    if (FIRE2) { // mix velocity within the MD step (resolved at compile time)
+        auto mdview = md::makeMDView(_last.x, _v, _a, noUpdate, [this]() { this->_mixVelocity(_v, _a, _alpha); });
+        md::IntegratorStages<MDI>::stage(mdview, _dt, stage);
+    }
+    else {
+        auto mdview = md::makeMDView(_last.x, _v, _a, noUpdate);
+        md::IntegratorStages<MDI>::stage(mdview, _dt, stage);
+    }
+}
+
+void FIRE::_updateForce()
+{
+    md::computeAcceleration(_grad.val, _mi, _a);
+}
+
+bool FIRE::_processMDStep()
+{
+    // state variables (members, for checkpoints)
+    std::vector<double> &v = _v;
+    std::vector<double> &a = _a;
+    double &dt = _dt;
+    double &alpha = _alpha;
+    int &Npos = _Npos, &Nneg = _Nneg, &Nmin = _Nmin;
+
+    if (this->_isNDtMinReached(Nmin) || this->_isNNegMaxReached(Nneg) || this->_shouldStop()) { return false; } // we are done
+
+    // compute P
+    const double P = this->_parallelSum([&](const size_t begin, const size_t end)
+                                        { return vk::dot(a.data() + begin, v.data() + begin, end - begin); });
+
+    // velocity mixing (FIRE 2.0 mixes within the MD step)
+    if (!_flag_fire2) { this->_mixVelocity(v, a, alpha); }
 
-        // check P
-        if (P > 0.) { // we are going downhill
-            if (++Npos > _Nwait) { // then increase dt
-                dt = std::min(dt*_finc, _dtmax);
-                Nmin = 0; // we have increased dt
-                alpha *= _falpha;
-            }
+    // check P
+    if (P > 0.) { // we are going downhill
+        Nneg = 0;
+        if (++Npos > _Nwait) { // then increase dt
+            dt = std::min(dt*_finc, _dtmax);
+            Nmin = 0; // we have increased dt
+            alpha *= _falpha;
         }
-        else { // we are going uphill
-            Npos = 0;
+    }
+    else { // we are going uphill
+        Npos = 0;
+        ++Nneg;
+        if (!(_flag_fire2 && _flag_initialDelay && _iter <= _Nwait)) {
             dt = std::max(dt*_fdec, _dtmin);
             if (dt == _dtmin) { ++Nmin; }
             alpha = _alpha0;
-
-            if (_flag_fullFreeze) { // freeze the system completely
-                std::fill(v.begin(), v.end(), 0.);
-            }
-            else { // freeze selectively
-                for (int i = 0; i < _ndim; ++i) {
-                    if (a[i]*v[i] < 0.) {
-                        v[i] = 0.;
-                    }
-                }
-            }
         }
+
+        // freeze the system completely or selectively (with FIRE 2.0 uphill correction)
+        vk::fireFreeze(_last.x.data(), v.data(), a.data(), a.size(), _flag_fullFreeze, _flag_fire2 ? 0.5*dt : 0.);
     }
+    return true;
+}
+
+// --- Checkpoints
 
-    LogManager::logString("\nEnd FIRE::findMin() procedure\n");
+void FIRE::_initializeState()
+{
+    _v.assign(_grad.size(), 0.);
+    _a.assign(_grad.size(), 0.);
+    _dt = _dt0;
+    _alpha = _alpha0;
+    _Npos = 0;
+    _Nneg = 0;
+    _Nmin = 0;
+    _iter = 0;
+}
+
+void FIRE::_decayState(const double decay)
+{
+    for (double &vi : _v) { vi *= decay; }
+}
+
+void FIRE::_writeState(StateWriter &out) const
+{
+    out.write(std::string("FIRE"));
+    out.write(_v);
+    out.write(_a);
+    out.write(_dt);
+    out.write(_alpha);
+    out.write(static_cast<int32_t>(_Npos));
+    out.write(static_cast<int32_t>(_Nneg));
+    out.write(static_cast<int32_t>(_Nmin));
+    out.write(static_cast<int32_t>(_iter));
+}
+
+void FIRE::_readState(StateReader &in)
+{
+    in.expectTag("FIRE");
+    in.read(_v, _grad.size());
+    in.read(_a, _grad.size());
+    _dt = in.read<double>();
+    _alpha = in.read<double>();
+    _Npos = in.read<int32_t>();
+    _Nneg = in.read<int32_t>();
+    _Nmin = in.read<int32_t>();
+    _iter = in.read<int32_t>();
 }
 
 // --- Internal methods
 
-bool FIRE::_initializeMD(md::MDView &view, const double dt)
+bool FIRE::_initializeMD(std::vector<double> &v, const std::vector<double> &a, const double dt)
 {
-    LogManager::logString("\nFIRE::findMin() Initial Step\n");
+    LogManager::logString("\n" + _logName + "::findMin() Initial Step\n");
 
     // compute initial step
-    view.update(); // compute initial force and store acceleration
     for (int i = 0; i < _ndim; ++i) {
-        view.v[i] += dt*view.a[i]; // we start with an initial velocity
+        v[i] += dt*a[i]; // we start with an initial velocity
     }
     // other stuff
     this->_storeLastValue();
     this->_writeGradientToLog();
     if (this->_shouldStop()) { // we print termination message already
-        LogManager::logString("\nEnd FIRE::findMin() procedure\n");
+        LogManager::logString("\nEnd " + _logName + "::findMin() procedure\n");
         return false;
     }
     return true; // we can start the algorithm
 }
 
-void FIRE::_updateTarget(md::MDView &view, const double dt)
+void FIRE::_mixVelocity(std::vector<double> &v, const std::vector<double> &a, const double alpha) const
 {
-    md::doMDStep(_mdi, view, dt);
-    this->_storeLastValue();
-    this->_writeGradientToLog();
+    const double vnorm = sqrt(this->_parallelSum([&](const size_t begin, const size_t end)
+                                                 { return vk::dot(v.data() + begin, v.data() + begin, end - begin); }));
+    const double anorm = sqrt(this->_parallelSum([&](const size_t begin, const size_t end)
+                                                 { return vk::dot(a.data() + begin, a.data() + begin, end - begin); }));
+    if (anorm == 0.) { return; }
+    this->_parallelFor([&](const size_t begin, const size_t end)
+                       { // v = (1-alpha)*v + alpha*vnorm*a/anorm
+                           vk::fireMix(v.data() + begin, a.data() + begin, end - begin, alpha, alpha*vnorm, anorm);
+                       });
+}
+
+bool FIRE::_isNNegMaxReached(const int Nneg)
+{
+    if (_flag_fire2 && _NnegMax > 0 && Nneg > _NnegMax) {
+        LogManager::logString("\nStopping Reason: Maximal number of consecutive uphill steps.\n");
+        return true;
+    }
+    return false;
 }
 
 bool FIRE::_isNDtMinReached(const int Nmin)
@@ -1,6 +1,7 @@
 #include "nfm/IRENE.hpp"
 
 #include "nfm/LogManager.hpp"
+#include "nfm/VecKernels.hpp"
 
 #include <cmath>
 #include <iostream>
@@ -10,96 +11,113 @@ namespace nfm
 
 // --- Minimization
 
-void IRENE::_findMin()
+void IRENE::_updateForce()
 {
-    LogManager::logString("\nBegin IRENE::findMin() procedure\n");
-
-    // helper variables
-    std::vector<double> v(_grad.size()); // velocity vector
-    std::vector<double> ma(_grad.size()); // moving average acceleration
-    NoisyGradient a(_ndim); // noisy mixed acceleration vector (used for MD)
-
-    std::function<void()> update = [&]()
-    { // MD force update lambda
-        _last.f = _gradfun->fgrad(_last.x, _grad);
-        md::computeAcceleration(_grad.val, _mi, a.val);
-        md::computeAcceleration(_grad.err, _mi, a.err); // we need that later
-        if (_beta > 0.) {
-            for (int i = 0; i < _ndim; ++i) { // update averaged acceleration and mixed acceleration (for MD)
-                ma[i] = _beta*ma[i] + (1. - _beta)*a.val[i];
-                const double ISNR = std::min(1., a.err[i]/fabs(ma[i]));
-                a.val[i] = (a.val[i] + ISNR*ISNR*ma[i])/(ISNR*ISNR + 1.); // mix raw and averaged gradient according to ISNR squared
+    std::vector<double> &a = _a; // mixed acceleration vector (used for MD)
+    std::vector<double> &aerr = _aerr;
+
+    md::computeAcceleration(_grad.val, _mi, a);
+    md::computeAcceleration(_grad.err, _mi, aerr); // we need that later
+    if (_beta > 0.) {
+        updateBlockwise<1>({&_ma}, 0, _ma.size(), [&](const size_t b0, const size_t len, const std::array<double *, 1> &mab)
+        {
+            double * mai = mab[0];
+            for (size_t i = b0; i < b0 + len; ++i, ++mai) { // update averaged acceleration and mixed acceleration (for MD)
+                *mai = _beta*(*mai) + (1. - _beta)*a[i];
+                const double ISNR = std::min(1., aerr[i]/fabs(*mai));
+                a[i] = (a[i] + ISNR*ISNR*(*mai))/(ISNR*ISNR + 1.); // mix raw and averaged gradient according to ISNR squared
                 // note that we currently "assume" that the statistical error of a does not change due to this
             }
+        });
+    }
+}
+
+bool IRENE::_processMDStep()
+{
+    // state variables (members, for checkpoints)
+    std::vector<double> &v = _v;
+    std::vector<double> &a = _a; // mixed acceleration vector (used for MD)
+    std::vector<double> &aerr = _aerr;
+    double &dt = _dt;
+    double &alpha = _alpha;
+    int &Npos = _Npos, &Nneg = _Nneg, &Nmin = _Nmin;
+
+    std::transform(_grad.err.begin(), _grad.err.end(), _mi.begin(), aerr.begin(), std::multiplies<>()); // update aerr
+    if (this->_isNDtMinReached(Nmin) || this->_isNNegMaxReached(Nneg) || this->_shouldStop()) { return false; } // we are done
+
+    // compute P, which is a NoisyValue in this algorithm
+    NoisyValue P{};
+    P.val = this->_parallelSum([&](const size_t begin, const size_t end) // P = v.a
+                               { return vk::dot(v.data() + begin, a.data() + begin, end - begin); });
+    P.err = sqrt(this->_parallelSum([&](const size_t begin, const size_t end) // error propagation, sum of (dP/da * a_err)^2
+                                    { return vk::sumSqProd(v.data() + begin, aerr.data() + begin, end - begin); }));
+
+    // acceleration / velocity mixing (FIRE 2.0 mixes within the MD step)
+    if (!_flag_fire2) { this->_mixVelocity(v, a, alpha); }
+
+    // check P (using noisy comparison)
+    if (P > 0.) { // we are most likely going downhill
+        Nneg = 0;
+        if (++Npos > _Nwait) { // then increase dt
+            dt = std::min(dt*_finc, _dtmax);
+            Nmin = 0; // we have increased dt
+            alpha *= _falpha;
         }
-    };
-    md::MDView mdview{.x = _last.x, .v = v, .a = a.val, .update = update}; // references for MD integrator
-
-    double dt = _dt0; // current time-step
-    double alpha = _alpha0; // current mixing factor
-    int Npos = 0; // number of steps since "F.v" was negative
-    int Nmin = 0; // number of steps since dt = dtmin
-
-    // initial step
-    if (!this->_initializeMD(mdview, dt)) { return; } // return if shouldStop() already
-
-    //begin the minimization loop
-    int iter = 0;
-    while (true) {
-        ++iter;
-        if (LogManager::isLoggingOn()) { // else skip string construction
-            LogManager::logString("\nIRENE::findMin() Step " + std::to_string(iter) + "\n");
+    }
+    else if (P < 0.) { // we are most likely going uphill
+        Npos = 0;
+        ++Nneg;
+        if (!(_flag_fire2 && _flag_initialDelay && _iter <= _Nwait)) {
+            dt = std::max(dt*_fdec, _dtmin);
+            alpha = _alpha0;
         }
 
-        // compute the gradient and current target
-        this->_updateTarget(mdview, dt);
-        std::transform(_grad.err.begin(), _grad.err.end(), _mi.begin(), a.err.begin(), std::multiplies<>()); // update a.err
-        if (this->_isNDtMinReached(Nmin) || this->_shouldStop()) { break; } // we are done
-
-        // compute P, which is a NoisyValue in this algorithm
-        NoisyValue P{};
-        P.val = std::inner_product(v.begin(), v.end(), a.val.begin(), 0.); // P = v.a
-        // error estimation based on error propagation
-        for (int i = 0; i < _ndim; ++i) {
-            P.err += pow(v[i]*a.err[i], 2); // dP/da * a_err
-        }
-        P.err = sqrt(P.err);
+        // freeze completely or selectively, where a_i*v_i < 0 (noisy comparison), with FIRE 2.0 uphill correction
+        vk::ireneFreeze(_last.x.data(), v.data(), a.data(), aerr.data(), v.size(),
+                        _flag_fullFreeze, _flag_fire2 ? 0.5*dt : 0., NoisyValue::getSigmaLevel());
+    }
 
-        // acceleration / velocity mixing
-        const double vnorm = sqrt(std::inner_product(v.begin(), v.end(), v.begin(), 0.));
-        const double anorm = sqrt(std::inner_product(a.val.begin(), a.val.end(), a.val.begin(), 0.));
-        for (int i = 0; i < _ndim; ++i) {
-            v[i] = (1. - alpha)*v[i] + alpha*vnorm*a.val[i]/anorm;
-        }
+    if (dt == _dtmin) { ++Nmin; }
+    return true;
+}
 
-        // check P (using noisy comparison)
-        if (P > 0.) { // we are most likely going downhill
-            if (++Npos > _Nwait) { // then increase dt
-                dt = std::min(dt*_finc, _dtmax);
-                Nmin = 0; // we have increased dt
-                alpha *= _falpha;
-            }
-        }
-        else if (P < 0.) { // we are most likely going uphill
-            Npos = 0;
-            dt = std::max(dt*_fdec, _dtmin);
-            alpha = _alpha0;
+// --- Checkpoints
 
-            if (_flag_fullFreeze) { // freeze the system completely
-                std::fill(v.begin(), v.end(), 0.);
-            }
-            else { // freeze selectively
-                for (int i = 0; i < _ndim; ++i) {
-                    if (a[i]*v[i] < 0.) { // using two noisy overloads here!
-                        v[i] = 0.;
-                    }
-                }
-            }
-        }
+void IRENE::_initializeState()
+{
+    FIRE::_initializeState();
+    _aerr.assign(_grad.size(), 0.);
+    this->_initStateBuffer(_ma, (_beta > 0.) ? _grad.size() : 0);
+}
+
+void IRENE::_writeState(StateWriter &out) const
+{
+    FIRE::_writeState(out);
+    out.write(std::string("IRENE"));
+    out.write(_aerr);
+    _ma.write(out);
+}
 
-        if (dt == _dtmin) { ++Nmin; }
+void IRENE::_readState(StateReader &in)
+{
+    FIRE::_readState(in);
+    in.expectTag("IRENE");
+    in.read(_aerr, _grad.size());
+    this->_readStateBuffer(in, _ma);
+
+    if (!this->_isStateConsistent()) {
+        throw std::invalid_argument("[IRENE] Checkpoint state doesn't match the current configuration.");
     }
+}
 
-    LogManager::logString("\nEnd IRENE::findMin() procedure\n");
+void IRENE::_decayState(const double decay)
+{
+    FIRE::_decayState(decay);
+    _ma.scale(decay);
+}
+
+bool IRENE::_isStateConsistent() const
+{
+    return FIRE::_isStateConsistent() && _aerr.size() == _grad.size() && _ma.size() == ((_beta > 0.) ? _grad.size() : 0);
 }
 } // namespace nfm
\ No newline at end of file
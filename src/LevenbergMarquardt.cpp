@@ -0,0 +1,195 @@
+#include "nfm/LevenbergMarquardt.hpp"
+
+#include "nfm/LogManager.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace nfm
+{
+
+// --- Constructor
+
+LevenbergMarquardt::LevenbergMarquardt(const int ndim, const double damping0):
+        NFM(ndim, true), _damping0((damping0 > 0.) ? damping0 : 1.e-3) {}
+
+// --- Internal methods
+
+void LevenbergMarquardt::_computeWeights()
+{
+    const bool useErrs = _flag_weighted && std::all_of(_res.begin(), _res.end(), [](const NoisyValue r) { return r.err > 0.; });
+    for (size_t k = 0; k < _res.size(); ++k) {
+        _w[k] = useErrs ? 1./(_res[k].err*_res[k].err) : 1.;
+    }
+}
+
+NoisyValue LevenbergMarquardt::_weightedSumOfSquares(const std::vector<NoisyValue> &r) const
+{
+    NoisyValue chi2{0., 0.};
+    for (size_t k = 0; k < r.size(); ++k) {
+        const double wr = _w[k]*r[k].val;
+        chi2.val += wr*r[k].val;
+        chi2.err += 4.*wr*wr*r[k].err*r[k].err;
+    }
+    chi2.err = sqrt(chi2.err);
+    return chi2;
+}
+
+void LevenbergMarquardt::_buildNormalEquations()
+{
+    const auto n = static_cast<size_t>(_ndim);
+    std::fill(_A.begin(), _A.end(), 0.);
+    std::fill(_b.begin(), _b.end(), 0.);
+    for (size_t k = 0; k < _res.size(); ++k) { // rank-1 update per row of J
+        const double * Jk = _jac.data() + k*n;
+        const double wk = _w[k];
+        const double wrk = wk*_res[k].val;
+        for (size_t i = 0; i < n; ++i) {
+            const double wJki = wk*Jk[i];
+            double * Ai = _A.data() + i*n;
+            for (size_t j = 0; j <= i; ++j) { Ai[j] += wJki*Jk[j]; }
+            _b[i] -= wrk*Jk[i];
+        }
+    }
+}
+
+double LevenbergMarquardt::_dampingDiag(const size_t i) const
+{
+    if (_flag_marquardt) {
+        const double Aii = _A[i*_ndim + i];
+        return (Aii > 0.) ? Aii : 1.;
+    }
+    return 1.;
+}
+
+bool LevenbergMarquardt::_solveDamped(const double mu)
+{
+    const auto n = static_cast<size_t>(_ndim);
+
+    // in-place Cholesky of A + mu*D (lower triangle, row-major)
+    for (size_t i = 0; i < n; ++i) {
+        const double * Ai = _A.data() + i*n;
+        double * Li = _L.data() + i*n;
+        for (size_t j = 0; j <= i; ++j) {
+            const double * Lj = _L.data() + j*n;
+            double sum = Ai[j] - std::inner_product(Li, Li + j, Lj, 0.);
+            if (i == j) {
+                sum += mu*this->_dampingDiag(i);
+                if (sum <= 0.) { return false; }
+                Li[i] = sqrt(sum);
+            }
+            else {
+                Li[j] = sum/Lj[j];
+            }
+        }
+    }
+
+    // forward substitution L y = b (y stored in delta)
+    for (size_t i = 0; i < n; ++i) {
+        const double * Li = _L.data() + i*n;
+        _delta[i] = (_b[i] - std::inner_product(Li, Li + i, _delta.begin(), 0.))/Li[i];
+    }
+    // backward substitution L^T delta = y, column-oriented to keep row access
+    for (size_t ii = n; ii > 0; --ii) {
+        const size_t i = ii - 1;
+        const double * Li = _L.data() + i*n;
+        _delta[i] /= Li[i];
+        for (size_t k = 0; k < i; ++k) { _delta[k] -= Li[k]*_delta[i]; }
+    }
+    return true;
+}
+
+// --- Minimization
+
+void LevenbergMarquardt::_findMin()
+{
+    LogManager::logString("\nBegin LevenbergMarquardt::findMin() procedure\n");
+
+    const TargetFunGuard<NoisyResidualFunction> funGuard(_resfun, dynamic_cast<NoisyResidualFunction *>(_targetfun));
+    if (_resfun == nullptr) {
+        throw std::invalid_argument("[LevenbergMarquardt] The target function must be a NoisyResidualFunction.");
+    }
+
+    // allocate buffers
+    const auto n = static_cast<size_t>(_ndim);
+    const auto nres = static_cast<size_t>(_resfun->getNRes());
+    _res.resize(nres);
+    _rest.resize(nres);
+    _jac.resize(nres*n);
+    _w.resize(nres);
+    _A.assign(n*n, 0.);
+    _L.assign(n*n, 0.);
+    _b.resize(n);
+    _delta.resize(n);
+    std::vector<double> xt(n); // trial position
+
+    // initial residuals and Jacobian
+    _resfun->resjac(_last.x, _res, _jac);
+    this->_computeWeights();
+    NoisyValue chi2 = this->_weightedSumOfSquares(_res);
+
+    double mu = 0.; // damping factor
+    double nu = 2.; // damping increase factor
+    int iter = 0;
+    while (true) {
+        ++iter;
+        if (LogManager::isLoggingOn()) { // else skip string construction
+            LogManager::logString("\nLevenbergMarquardt::findMin() Step " + std::to_string(iter) + "\n");
+        }
+
+        // store current values (f and gradient follow from the residuals)
+        _last.f = NoisyResidualFunction::sumOfSquares(_res);
+        NoisyResidualFunction::gradFromResiduals(_res, _jac, _grad);
+        this->_storeLastValue();
+        this->_writeGradientToLog();
+        if (this->_shouldStop()) { break; }
+
+        this->_buildNormalEquations();
+        if (iter == 1) { // initial damping
+            mu = _damping0;
+            if (!_flag_marquardt) {
+                for (size_t i = 0; i < n; ++i) { mu = std::max(mu, _damping0*_A[i*n + i]); }
+            }
+        }
+
+        // find an acceptable damped step
+        bool accepted = false;
+        while (mu <= _maxDamping) {
+            if (this->_solveDamped(mu)) {
+                for (size_t i = 0; i < n; ++i) { xt[i] = _last.x[i] + _delta[i]; }
+                _resfun->residuals(xt, _rest);
+                const NoisyValue chi2t = this->_weightedSumOfSquares(_rest);
+
+                // predicted reduction delta.(b + mu*D*delta)
+                double pred = 0.;
+                for (size_t i = 0; i < n; ++i) { pred += _delta[i]*(_b[i] + mu*this->_dampingDiag(i)*_delta[i]); }
+                const NoisyValue rho = (chi2 - chi2t)/pred;
+                LogManager::logNoisyValue(rho, LogLevel::VERBOSE, "Gain ratio (mu = " + std::to_string(mu) + ")", "rho");
+
+                if (pred > 0. && rho.val > 0.) {
+                    accepted = true;
+                    mu *= std::max(1./3., 1. - pow(2.*rho.val - 1., 3));
+                    nu = 2.;
+                    break;
+                }
+            }
+            mu *= nu;
+            nu *= 2.;
+        }
+        if (!accepted) {
+            LogManager::logString("\nStopping Reason: Damping exceeded maximum.\n");
+            break;
+        }
+
+        // move to trial position and compute new Jacobian (reusing the trial residuals)
+        _last.x.swap(xt);
+        _res.swap(_rest);
+        _resfun->jacobianAt(_last.x, _res, _jac);
+        this->_computeWeights();
+        chi2 = this->_weightedSumOfSquares(_res);
+    }
+
+    LogManager::logString("\nEnd LevenbergMarquardt::findMin() procedure\n");
+}
+} // namespace nfm
@@ -89,262 +89,398 @@ void writeBracketToLog(const std::string &key, const nfm::NoisyBracket &bracket)
     LogManager::logString(s.str(), LogLevel::VERBOSE);
 }
 
+// drive a resumable search object with a 1D function
+template <class SearchT>
+void runSearch(nfm::NoisyFunction &f1d, SearchT &search)
+{
+    std::vector<double> xvec(1); // helper array to invoke noisy function
+    while (search.nextPoint(xvec[0])) {
+        search.report(f1d(xvec));
+    }
+}
+
 // --- Public Functions
 
 namespace nfm
 {
 
-bool findBracket(NoisyFunction &f1d, NoisyBracket &bracket /*inout*/, const int maxNIter, double epsx)
+bool findBracket(NoisyFunction &f1d, NoisyBracket &bracket /*inout*/, const int maxNIter, const double epsx)
 {
-    // Noisy findBracket Algorithm
-    // Mix of own ideas and GSL's findBracket ( gsl/min/bracketing.c )
+    // Noisy findBracket Algorithm (see BracketSearch)
     // Returns true when valid bracket found, else false.
-    using namespace m1d_detail;
-
-    // --- Sanity
     if (f1d.getNDim() != 1) {
         throw std::invalid_argument("[nfm::findBracket] The NoisyFunction is not 1D. Ndim=" + std::to_string(f1d.getNDim()));
     }
-    bracket = sortedBracket(bracket); // ensure proper ordering
-    validateBracketX(bracket.a.x, bracket.b.x, bracket.c.x, "nfm::findBracket"); // ensure valid bracket (else throw)
-    epsx = std::max(0., epsx);
+    BracketSearch search(bracket, maxNIter, epsx);
+    runSearch(f1d, search);
+    bracket = search.getBracket();
+    return search.isSuccess();
+}
 
-    // --- Initialization
-    NoisyIOPair1D &a = bracket.a;
-    NoisyIOPair1D &b = bracket.b;
-    NoisyIOPair1D &c = bracket.c;
+NoisyIOPair1D brentMin(NoisyFunction &f1d, const NoisyBracket bracket, const int maxNIter, const double epsx, const double epsf)
+{
+    // Brent minimization with noisy values (see BrentSearch)
+    if (f1d.getNDim() != 1) {
+        throw std::invalid_argument("[nfm::brentMin] The NoisyFunction is not 1D. Ndim=" + std::to_string(f1d.getNDim()));
+    }
+    BrentSearch search(bracket, maxNIter, epsx, epsf);
+    runSearch(f1d, search);
+    return search.getResult();
+}
+
+
+NoisyIOPair multiLineMin(NoisyFunction &mdf, NoisyIOPair p0Pair, const std::vector<double> &dir, const MLMParams params)
+{
+    // Sanity
+    if (mdf.getNDim() != p0Pair.getNDim() || p0Pair.x.size() != dir.size()) {
+        throw std::invalid_argument("[nfm::multiLineMin] The passed function and positions are inconsistent in size.");
+    }
+
+    // project the original multi-dim function into a one-dim function
+    FunProjection1D proj1d(&mdf, p0Pair.x, dir);
+    LineSearch search(p0Pair.f, params); // throws on invalid steps
+    runSearch(proj1d, search);
+
+    p0Pair.f = search.getResult().f; // the minimal f value (or the recomputed one at p0)
+    if (search.isSuccess()) {
+        proj1d.getVecFromX(search.getResult().x, p0Pair.x); // get the true x position
+    }
+    return p0Pair;
+}
 
-    // shortcut lambda
-    int iter = 0; // keeps track of loop iteration count (overall)
-    std::vector<double> xvec(1); // helper array to invoke noisy function
-    std::function<NoisyValue(double x)> F = [&](const double x)
-    {
-        xvec[0] = x;
-        return f1d(xvec);
-    };
 
-    // --- Bracketing
+// --- BracketSearch
+
+BracketSearch::BracketSearch(const NoisyBracket &bracket, const int maxNIter, const double epsx):
+        _bracket(sortedBracket(bracket)), _maxNIter(maxNIter), _epsx(std::max(0., epsx))
+{
+    validateBracketX(_bracket.a.x, _bracket.b.x, _bracket.c.x, "nfm::BracketSearch"); // ensure valid bracket (else throw)
+    writeBracketToLog("findBracket init", _bracket);
+    this->_advance();
+}
+
+bool BracketSearch::nextPoint(double &x) const
+{
+    if (_flag_done) { return false; }
+    x = _flag_nextC ? _bracket.c.x : _bracket.b.x;
+    return true;
+}
+
+void BracketSearch::report(const NoisyValue f)
+{
+    if (_flag_done) {
+        throw std::invalid_argument("[nfm::BracketSearch::report] The search is already finished.");
+    }
+    (_flag_nextC ? _bracket.c : _bracket.b).f = f;
+    writeBracketToLog(_stepName, _bracket);
+    this->_advance();
+}
+
+void BracketSearch::_finish(const bool success)
+{
+    if (success) { writeBracketToLog("findBracket final", _bracket); }
+    _flag_done = true;
+    _flag_success = success;
+}
+
+void BracketSearch::_advance()
+{
+    using namespace m1d_detail;
+    NoisyIOPair1D &a = _bracket.a;
+    NoisyIOPair1D &b = _bracket.b;
+    NoisyIOPair1D &c = _bracket.c;
 
     // Pre-Processing
-    writeBracketToLog("findBracket init", bracket);
-    while (hasEquals(bracket)) { // we need larger interval
-        // check stopping conditions
-        if (!checkBracketXTol(bracket, epsx)) { return false; }
-        if (isBracketed(bracket)) {
-            writeBracketToLog("findBracket final", bracket);
-            return true; // return with early success
+    if (_flag_pre) {
+        if (hasEquals(_bracket)) { // we need larger interval
+            // check stopping conditions
+            if (!checkBracketXTol(_bracket, _epsx)) { this->_finish(false); return; }
+            if (isBracketed(_bracket)) { this->_finish(true); return; } // early success
+            if (_iter++ > _maxNIter) { this->_finish(false); return; } // evaluation limit
+
+            // scale up
+            b = c;
+            c.x = a.x + (b.x - a.x)/IGOLD2;
+            _flag_nextC = true;
+            _stepName = "findBracket pre-step (scale)";
+            return;
         }
-        if (iter++ > maxNIter) { return false; } // evaluation limit
+        _flag_pre = false; // continue with main loop
+    }
+
+    // Main Loop
+    if (hasEquals(_bracket)) { this->_finish(false); return; } // stop if we have equal function values again
+    if (!checkBracketXTol(_bracket, _epsx)) { this->_finish(false); return; } // bracket violates tolerances
+    if (isBracketed(_bracket)) { this->_finish(true); return; } // success (i.e. a.f > b.f < c.f ruled out below)
+    if (_iter++ > _maxNIter) { this->_finish(false); return; } // evaluation limit
+
+    // regular iteration (equals ruled out)
+    if (b.f < a.f) { // -> a.f > b.f > c.f
+        // move up (c.f follows)
+        shiftABC(a.x, b.x, c.x, (c.x - b.x)/IGOLD2 + b.x);
+        a.f = b.f;
+        b.f = c.f;
+        _flag_nextC = true;
+        _stepName = "findBracket step (move)";
+    }
+    else { // -> a.f < b.f < c.f || a.f < b.f > c.f
+        // contract (b.f follows)
+        c = b;
+        b.x = (c.x - a.x)*IGOLD2 + a.x;
+        _flag_nextC = false;
+        _stepName = "findBracket step (contract)";
+    }
+}
+
 
-        // scale up
-        b = c;
-        c.x = a.x + (b.x - a.x)/IGOLD2;
-        c.f = F(c.x);
+// --- BrentSearch
 
-        writeBracketToLog("findBracket pre-step (scale)", bracket);
+BrentSearch::BrentSearch(const NoisyBracket &bracket, const int maxNIter, const double epsx, const double epsf):
+        _bracket(bracket), _maxNIter(maxNIter), _epsx(std::max(0., epsx)), _epsf(std::max(0., epsf))
+{
+    validateBracket(_bracket, "nfm::BrentSearch"); // check for valid bracket
+    _v.x = _bracket.a.x + m1d_detail::IGOLD2*(_bracket.c.x - _bracket.a.x);
+}
+
+bool BrentSearch::nextPoint(double &x) const
+{
+    switch (_phase) {
+    case Phase::Init:
+        x = _v.x;
+        return true;
+    case Phase::Step:
+        x = _u.x;
+        return true;
+    case Phase::Final: // recompute the value at the final position
+        x = _bracket.b.x;
+        return true;
+    default:
+        return false;
     }
+}
 
-    // Main Loop
-    while (!hasEquals(bracket)) { // stop if we have equal function values again
-        // check other stopping conditions
-        if (!checkBracketXTol(bracket, epsx)) { return false; } // bracket violates tolerances
-        if (isBracketed(bracket)) {
-            writeBracketToLog("findBracket final", bracket);
-            return true; // return with success (i.e. a.f > b.f < c.f ruled out below)
-        }
-        if (iter++ > maxNIter) { return false; } // evaluation limit
-
-        // regular iteration (equals ruled out)
-        if (b.f < a.f) { // -> a.f > b.f > c.f (else we would have returned successful)
-            // move up
-            shiftABC(a.x, b.x, c.x, (c.x - b.x)/IGOLD2 + b.x);
-            shiftABC(a.f, b.f, c.f, F(c.x));
-            writeBracketToLog("findBracket step (move)", bracket);
-        }
-        else { // -> a.f < b.f < c.f || a.f < b.f > c.f
-            // contract
-            c = b;
-            b.x = (c.x - a.x)*IGOLD2 + a.x;
-            b.f = F(b.x);
-            writeBracketToLog("findBracket step (contract)", bracket);
-        }
+void BrentSearch::report(const NoisyValue f)
+{
+    switch (_phase) {
+    case Phase::Init:
+        _v.f = f;
+        _w = _v;
+        break;
+    case Phase::Step:
+        _u.f = f;
+        this->_updateBracket();
+        ++_iter;
+        break;
+    case Phase::Final:
+        _bracket.b.f = f;
+        _phase = Phase::Done;
+        return;
+    default:
+        throw std::invalid_argument("[nfm::BrentSearch::report] The search is already finished.");
     }
-    return false;
+    this->_advance();
 }
 
-NoisyIOPair1D brentMin(NoisyFunction &f1d, NoisyBracket bracket, const int maxNIter, double epsx, double epsf)
+void BrentSearch::_advance()
 {
-    //
-    // Adaption of GNU Scientific Libraries's Brent minimization ( gsl/min/brent.c )
-    //
     using namespace m1d_detail;
-
-    // Sanity
-    if (f1d.getNDim() != 1) {
-        throw std::invalid_argument("[nfm::brentMin] The NoisyFunction is not 1D. Ndim=" + std::to_string(f1d.getNDim()));
+    const NoisyIOPair1D &lb = _bracket.a; // lower bound
+    const NoisyIOPair1D &m = _bracket.b;
+    const NoisyIOPair1D &ub = _bracket.c; // upper bound
+
+    if (_iter >= _maxNIter || !checkBracketXTol(_bracket, _epsx) || !checkBracketFTol(_bracket, _epsf)) {
+        // To avoid any bias, we recompute the function value at the final position (see brentMin)
+        writeBracketToLog("brentMin final", _bracket);
+        _phase = Phase::Final;
+        return;
     }
-    validateBracket(bracket, "nfm::brentMin"); // check for valid bracket
-    epsx = std::max(0., epsx);
-    epsf = std::max(0., epsf);
 
-    // --- Initialization
+    const double mtolb = m.x - lb.x;
+    const double mtoub = ub.x - m.x;
+    const double xm = 0.5*(lb.x + ub.x);
+    const double tol = 1.5e-08*fabs(m.x); // tolerance for strategy choice
 
-    // we reuse the bracket
-    NoisyIOPair1D &lb = bracket.a; // lower bound
-    NoisyIOPair1D &m = bracket.b;
-    NoisyIOPair1D &ub = bracket.c; // upper bound
+    double p = 0.;
+    double q = 0.;
+    double r = 0.;
+    _u = NoisyIOPair1D{};
 
-    // shortcut lambda
-    std::vector<double> xvec(1); // helper array to invoke noisy function
-    std::function<NoisyValue(double x)> F = [&](const double x)
-    {
-        xvec[0] = x;
-        return f1d(xvec);
-    };
-
-    // initialize helpers
-    double d = 0., e = 0.;
-    NoisyIOPair1D v{}, w{};
-    v.x = lb.x + IGOLD2*(ub.x - lb.x);
-    v.f = F(v.x);
-    w = v;
-
-    // --- Main Brent Loop
-    for (int it = 0; it < maxNIter; ++it) {
-        if (!checkBracketXTol(bracket, epsx)) { break; } // bracket size too small, return early
-        if (!checkBracketFTol(bracket, epsf)) { break; } // values too close, return early (noisy version)
-
-        const double mtolb = m.x - lb.x;
-        const double mtoub = ub.x - m.x;
-        const double xm = 0.5*(lb.x + ub.x);
-        const double tol = 1.5e-08*fabs(m.x); // tolerance for strategy choice
-
-        //std::swap(d, e); // this happens only in the step initialization of GSL's Brent and looks like a bug
-        NoisyIOPair1D u{};
-
-        double p = 0.;
-        double q = 0.;
-        double r = 0.;
-
-        bool flag_parab; // was parabolic fit used
-
-        // The following is a customized adaption of GSL's Brent,
-        // just using NoisyValue overloads and small other modifications.
-        if (fabs(e) > tol) { // we should fit a parabola
-            r = (m.x - w.x)*(m.f.val - v.f.val);
-            q = (m.x - v.x)*(m.f.val - w.f.val);
-            p = (m.x - v.x)*q - (m.x - w.x)*r;
-            q = 2.*(q - r);
-
-            if (q > 0.) {
-                p = -p;
-            }
-            else {
-                q = -q;
-            }
-            r = e;
-            e = d;
-        }
+    if (fabs(_e) > tol) { // we should fit a parabola
+        r = (m.x - _w.x)*(m.f.val - _v.f.val);
+        q = (m.x - _v.x)*(m.f.val - _w.f.val);
+        p = (m.x - _v.x)*q - (m.x - _w.x)*r;
+        q = 2.*(q - r);
 
-        // if parabola fine, use it
-        if (fabs(p) < fabs(0.5*q*r) && p < q*mtolb && p < q*mtoub) {
-            double t2 = 2.*tol;
-            d = p/q;
-            u.x = m.x + d;
-            if ((u.x - lb.x) < t2 || (ub.x - u.x) < t2) { // keep minimal distance to lb and ub
-                d = (m.x < xm) ? tol : -tol;
-            }
-            flag_parab = true;
+        if (q > 0.) {
+            p = -p;
         }
-        else { // else use golden section
-            e = (m.x < xm) ? ub.x - m.x : -(m.x - lb.x);
-            d = IGOLD2*e;
-            flag_parab = false;
+        else {
+            q = -q;
         }
+        r = _e;
+        _e = _d;
+    }
 
-        // keep minimal distance to m
-        if (fabs(d) >= tol) {
-            u.x = m.x + d;
-        }
-        else {
-            u.x = m.x + ((d > 0) ? tol : -tol);
+    // if parabola fine, use it
+    if (fabs(p) < fabs(0.5*q*r) && p < q*mtolb && p < q*mtoub) {
+        double t2 = 2.*tol;
+        _d = p/q;
+        _u.x = m.x + _d;
+        if ((_u.x - lb.x) < t2 || (ub.x - _u.x) < t2) { // keep minimal distance to lb and ub
+            _d = (m.x < xm) ? tol : -tol;
         }
+        _flag_parab = true;
+    }
+    else { // else use golden section
+        _e = (m.x < xm) ? ub.x - m.x : -(m.x - lb.x);
+        _d = IGOLD2*_e;
+        _flag_parab = false;
+    }
 
-        // here we evaluate the function
-        u.f = F(u.x);
+    // keep minimal distance to m
+    if (fabs(_d) >= tol) {
+        _u.x = m.x + _d;
+    }
+    else {
+        _u.x = m.x + ((_d > 0) ? tol : -tol);
+    }
+    _phase = Phase::Step;
+}
 
-        // check continue conditions
-        if (u.f.getUBound() <= m.f.getUBound()) { // keep best ubound in m (prove safer so far)
-            if (u.x < m.x) { ub = m; }
-            else { lb = m; }
+void BrentSearch::_updateBracket()
+{
+    NoisyIOPair1D &lb = _bracket.a; // lower bound
+    NoisyIOPair1D &m = _bracket.b;
+    NoisyIOPair1D &ub = _bracket.c; // upper bound
+    const NoisyIOPair1D &u = _u;
+
+    // check continue conditions
+    if (u.f.getUBound() <= m.f.getUBound()) { // keep best ubound in m (prove safer so far)
+        if (u.x < m.x) { ub = m; }
+        else { lb = m; }
+
+        _v = _w;
+        _w = m;
+        m = u;
+    }
+    else {
+        if (u.x < m.x) { lb = u; }
+        else { ub = u; }
 
-            v = w;
-            w = m;
-            m = u;
+        if (u.f <= _w.f || _w.x == m.x) {
+            _v = _w;
+            _w = u;
         }
-        else {
-            if (u.x < m.x) { lb = u; }
-            else { ub = u; }
-
-            if (u.f <= w.f || w.x == m.x) {
-                v = w;
-                w = u;
-            }
-            else if (u.f <= v.f || v.x == m.x || v.x == w.x) {
-                v = u;
-            }
+        else if (u.f <= _v.f || _v.x == m.x || _v.x == _w.x) {
+            _v = u;
         }
-
-        writeBracketToLog(flag_parab ? "brentMin step (parabola)" : "brentMin step (goldsect)", bracket);
     }
 
-    writeBracketToLog("brentMin final", bracket);
-
-    // Return point in m. v might rarely have a better upper bound, but is more risky.
-    // To avoid any bias, we recompute the function value at the final position.
-    m.f = F(m.x);
-    return m;
+    writeBracketToLog(_flag_parab ? "brentMin step (parabola)" : "brentMin step (goldsect)", _bracket);
 }
 
 
-NoisyIOPair multiLineMin(NoisyFunction &mdf, NoisyIOPair p0Pair, const std::vector<double> &dir, MLMParams params)
+// --- LineSearch
+
+LineSearch::LineSearch(const NoisyValue f0, MLMParams params): _params(params), _f0(f0)
 {
     using namespace m1d_detail;
-    // Sanity
-    if (mdf.getNDim() != p0Pair.getNDim() || p0Pair.x.size() != dir.size()) {
-        throw std::invalid_argument("[nfm::multiLineMin] The passed function and positions are inconsistent in size.");
-    }
-    if (params.stepLeft < 0. || params.stepRight <= 0.) {
-        throw std::invalid_argument("[nfm::multiLineMin] stepLeft and stepRight must be non-negative (stepRight strictly positive).");
+    if (_params.stepLeft < 0. || _params.stepRight <= 0.) {
+        throw std::invalid_argument("[nfm::LineSearch] stepLeft and stepRight must be non-negative (stepRight strictly positive).");
     }
     // these should be non-zero
-    params.epsx = (params.epsx > 0) ? params.epsx : STD_XTOL;
-    params.epsf = (params.epsf > 0) ? params.epsf : STD_FTOL;
-
-    // project the original multi-dim function into a one-dim function
-    FunProjection1D proj1d(&mdf, p0Pair.x, dir);
+    _params.epsx = (_params.epsx > 0) ? _params.epsx : STD_XTOL;
+    _params.epsf = (_params.epsf > 0) ? _params.epsf : STD_FTOL;
 
     // prepare initial bracket (allow backstep via stepLeft)
-    const double ax = -params.stepLeft;
-    const double cx = params.stepRight;
-    const double bx = ax + (cx - ax)*IGOLD2; // golden section
-    NoisyBracket bracket{{ax, (fabs(ax) == 0.) ? p0Pair.f : proj1d(ax)}, // avoid recomputation
-                         {bx, proj1d(bx)},
-                         {cx, proj1d(cx)}};
-
-    if (findBracket(proj1d, bracket, params.maxNBracket, params.epsx)) { // valid bracket was stored in bracket
-        // now do line-minimization via brent
-        NoisyIOPair1D min1D = brentMin(proj1d, bracket, params.maxNMinimize, params.epsx, params.epsf);
-
-        if (min1D.f <= p0Pair.f) { // reject new values that are truly larger
-            // return new NoisyIOPair
-            p0Pair.f = min1D.f; // store the minimal f value
-            proj1d.getVecFromX(min1D.x, p0Pair.x); // get the true x position
-            return p0Pair;
+    _bracket.a.x = -_params.stepLeft;
+    _bracket.c.x = _params.stepRight;
+    _bracket.b.x = _bracket.a.x + (_bracket.c.x - _bracket.a.x)*IGOLD2; // golden section
+    if (fabs(_bracket.a.x) == 0.) { // avoid recomputation
+        _bracket.a.f = _f0;
+        _phase = Phase::InitB;
+    }
+    else {
+        _phase = Phase::InitA;
+    }
+}
+
+bool LineSearch::nextPoint(double &t) const
+{
+    switch (_phase) {
+    case Phase::InitA:
+        t = _bracket.a.x;
+        return true;
+    case Phase::InitB:
+        t = _bracket.b.x;
+        return true;
+    case Phase::InitC:
+        t = _bracket.c.x;
+        return true;
+    case Phase::Bracket:
+        return _bracketSearch->nextPoint(t);
+    case Phase::Brent:
+        return _brentSearch->nextPoint(t);
+    case Phase::Recompute: // the old position
+        t = 0.;
+        return true;
+    default:
+        return false;
+    }
+}
+
+void LineSearch::report(const NoisyValue f)
+{
+    switch (_phase) {
+    case Phase::InitA:
+        _bracket.a.f = f;
+        _phase = Phase::InitB;
+        break;
+    case Phase::InitB:
+        _bracket.b.f = f;
+        _phase = Phase::InitC;
+        break;
+    case Phase::InitC:
+        _bracket.c.f = f;
+        _bracketSearch.reset(new BracketSearch(_bracket, _params.maxNBracket, _params.epsx));
+        _phase = Phase::Bracket;
+        this->_checkBracketSearch();
+        break;
+    case Phase::Bracket:
+        _bracketSearch->report(f);
+        this->_checkBracketSearch();
+        break;
+    case Phase::Brent:
+        _brentSearch->report(f);
+        if (_brentSearch->isDone()) {
+            if (_brentSearch->getResult().f <= _f0) { // reject new values that are truly larger
+                _result = _brentSearch->getResult();
+                _flag_success = true;
+                _phase = Phase::Done;
+            }
+            else { // return the old position, but recompute value
+                _phase = Phase::Recompute;
+            }
         }
+        break;
+    case Phase::Recompute:
+        _result = {0., f};
+        _phase = Phase::Done;
+        break;
+    default:
+        throw std::invalid_argument("[nfm::LineSearch::report] The search is already finished.");
+    }
+}
+
+void LineSearch::_checkBracketSearch()
+{
+    if (!_bracketSearch->isDone()) { return; }
+    if (_bracketSearch->isSuccess()) { // now do line-minimization via brent
+        _brentSearch.reset(new BrentSearch(_bracketSearch->getBracket(), _params.maxNMinimize, _params.epsx, _params.epsf));
+        _phase = Phase::Brent;
+    }
+    else {
+        _phase = Phase::Recompute;
     }
-    // return the old position, but recompute value
-    p0Pair.f = mdf(p0Pair.x);
-    return p0Pair;
 }
 } // namespace nfm
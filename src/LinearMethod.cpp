@@ -0,0 +1,209 @@
+#include "nfm/LinearMethod.hpp"
+
+#include "nfm/LogManager.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+// --- Internal Functions
+
+// in-place LU decomposition with partial pivoting of a dense (row-major) n*n matrix
+// Returns false if A is (numerically) singular.
+inline bool luDecompose(std::vector<double> &A, std::vector<size_t> &piv, const size_t n)
+{
+    double amax = 0.;
+    for (const double a : A) { amax = std::max(amax, fabs(a)); }
+    const double tiny = 1.e-14*amax;
+
+    for (size_t k = 0; k < n; ++k) {
+        size_t p = k;
+        for (size_t i = k + 1; i < n; ++i) {
+            if (fabs(A[i*n + k]) > fabs(A[p*n + k])) { p = i; }
+        }
+        piv[k] = p;
+        if (fabs(A[p*n + k]) <= tiny) { return false; }
+        if (p != k) { std::swap_ranges(A.begin() + k*n, A.begin() + (k + 1)*n, A.begin() + p*n); }
+
+        const double * Ak = A.data() + k*n;
+        for (size_t i = k + 1; i < n; ++i) {
+            double * Ai = A.data() + i*n;
+            Ai[k] /= Ak[k];
+            for (size_t j = k + 1; j < n; ++j) { Ai[j] -= Ai[k]*Ak[j]; }
+        }
+    }
+    return true;
+}
+
+// solve A*x = b in-place (b becomes x), given the LU decomposition from above
+inline void luSolve(const std::vector<double> &LU, const std::vector<size_t> &piv, std::vector<double> &b, const size_t n)
+{
+    for (size_t k = 0; k < n; ++k) { std::swap(b[k], b[piv[k]]); }
+    for (size_t i = 1; i < n; ++i) { // forward substitution (unit lower triangle)
+        const double * LUi = LU.data() + i*n;
+        b[i] -= std::inner_product(LUi, LUi + i, b.begin(), 0.);
+    }
+    for (size_t ii = n; ii > 0; --ii) { // backward substitution
+        const size_t i = ii - 1;
+        const double * LUi = LU.data() + i*n;
+        b[i] = (b[i] - std::inner_product(LUi + i + 1, LUi + n, b.begin() + i + 1, 0.))/LUi[i];
+    }
+}
+
+// dense (row-major) matrix-vector product y = A*x
+inline void matVec(const std::vector<double> &A, const std::vector<double> &x, std::vector<double> &y, const size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        y[i] = std::inner_product(A.begin() + i*n, A.begin() + (i + 1)*n, x.begin(), 0.);
+    }
+}
+
+namespace nfm
+{
+
+// --- Constructor
+
+LinearMethod::LinearMethod(const int ndim, const double shift0):
+        NFM(ndim, false), _shift0((shift0 > 0.) ? shift0 : 0.01) {}
+
+// --- Internal methods
+
+bool LinearMethod::_solveShifted(const double shift, std::vector<double> &dx)
+{
+    const auto n1 = static_cast<size_t>(_ndim) + 1;
+    std::vector<double> c(n1, 0.), y(n1), Hy(n1), Sy(n1);
+    c[0] = 1.; // start from the current state
+    double lambda = _H[0];
+
+    // Rayleigh quotient iteration on the shifted pencil
+    for (int it = 0; it < _maxNEigIter; ++it) {
+        for (size_t i = 0; i < n1; ++i) {
+            for (size_t j = 0; j < n1; ++j) { _M[i*n1 + j] = _H[i*n1 + j] - lambda*_S[i*n1 + j]; }
+            if (i > 0) { _M[i*n1 + i] += shift; }
+        }
+        if (!luDecompose(_M, _piv, n1)) { break; } // lambda is an eigenvalue already, c its eigenvector
+
+        matVec(_S, c, y, n1);
+        luSolve(_M, _piv, y, n1);
+        const double ynorm = sqrt(std::inner_product(y.begin(), y.end(), y.begin(), 0.));
+        if (!std::isfinite(ynorm) || ynorm == 0.) { return false; }
+        for (double &yi : y) { yi /= ynorm; }
+
+        matVec(_H, y, Hy, n1);
+        matVec(_S, y, Sy, n1);
+        double num = std::inner_product(y.begin(), y.end(), Hy.begin(), 0.);
+        for (size_t i = 1; i < n1; ++i) { num += shift*y[i]*y[i]; }
+        const double lambda_new = num/std::inner_product(y.begin(), y.end(), Sy.begin(), 0.);
+
+        c.swap(y);
+        const bool converged = fabs(lambda_new - lambda) <= 1.e-12*std::max(1., fabs(lambda));
+        lambda = lambda_new;
+        if (converged) { break; }
+    }
+
+    // parameter update
+    const double cnorm = sqrt(std::inner_product(c.begin(), c.end(), c.begin(), 0.));
+    if (fabs(c[0]) <= 1.e-8*cnorm) { return false; } // eigenvector (nearly) orthogonal to current state
+    double dxnorm = 0.;
+    for (int i = 0; i < _ndim; ++i) {
+        dx[i] = c[i + 1]/c[0];
+        dxnorm += dx[i]*dx[i];
+    }
+    dxnorm = sqrt(dxnorm);
+    return std::isfinite(dxnorm) && (_maxStepNorm <= 0. || dxnorm <= _maxStepNorm);
+}
+
+// --- Minimization
+
+void LinearMethod::_findMin()
+{
+    LogManager::logString("\nBegin LinearMethod::findMin() procedure\n");
+
+    const TargetFunGuard<NoisyFunctionWithHSMatrices> funGuard(_hsfun, dynamic_cast<NoisyFunctionWithHSMatrices *>(_targetfun));
+    if (_hsfun == nullptr) {
+        throw std::invalid_argument("[LinearMethod] The target function must be a NoisyFunctionWithHSMatrices.");
+    }
+
+    // allocate buffers
+    const auto n1 = static_cast<size_t>(_ndim) + 1;
+    _H.resize(n1*n1);
+    _S.resize(n1*n1);
+    _M.resize(n1*n1);
+    _piv.resize(n1);
+    std::vector<double> dx(static_cast<size_t>(_ndim));
+    std::vector<std::vector<double>> xt; // candidate positions
+    std::vector<NoisyValue> ft; // candidate values
+    std::vector<int> kt; // candidate shift indices
+    const double logr = log(_shiftRatio);
+
+    double shift = std::max(_minShift, std::min(_maxShift, _shift0));
+
+    //begin the minimization loop
+    int iter = 0;
+    while (true) {
+        ++iter;
+        if (LogManager::isLoggingOn()) { // else skip string construction
+            LogManager::logString("\nLinearMethod::findMin() Step " + std::to_string(iter) + "\n");
+        }
+
+        // sample value and matrices
+        _last.f = _hsfun->fHS(_last.x, _H, _S);
+        this->_storeLastValue();
+        if (this->_shouldStop()) { break; }
+
+        // line search over the shift
+        bool accepted = false;
+        while (shift <= _maxShift) {
+            const double shifts[3] = {shift/_shiftRatio, shift, shift*_shiftRatio};
+            xt.clear();
+            kt.clear();
+            for (int k = 0; k < 3; ++k) {
+                if (this->_solveShifted(shifts[k], dx)) {
+                    xt.push_back(_last.x);
+                    for (int i = 0; i < _ndim; ++i) { xt.back()[i] += dx[i]; }
+                    kt.push_back(k);
+                }
+            }
+            if (!xt.empty()) {
+                _hsfun->fbatch(xt, ft);
+
+                // lowest value, on ties prefer the largest shift
+                size_t best = 0;
+                for (size_t j = 1; j < ft.size(); ++j) {
+                    if (ft[j].val < ft[best].val) { best = j; }
+                }
+                for (size_t j = best + 1; j < ft.size(); ++j) {
+                    if (ft[j] == ft[best]) { best = j; }
+                }
+                if (LogManager::isLoggingOn()) {
+                    LogManager::logString("Shift " + std::to_string(shifts[kt[best]]) + " chosen\n", LogLevel::VERBOSE);
+                }
+
+                if (ft[best] <= _last.f) { // not significantly worse than the current value
+                    accepted = true;
+                    _last.x.swap(xt[best]);
+
+                    // next shift from parabola through (log a, f)
+                    double tv = static_cast<double>(kt[best] - 1);
+                    if (ft.size() == 3) {
+                        const double curv = ft[0].val - 2.*ft[1].val + ft[2].val;
+                        if (curv > 0.) {
+                            tv = std::max(-1., std::min(1., 0.5*(ft[0].val - ft[2].val)/curv));
+                        }
+                    }
+                    shift *= exp(tv*logr);
+                    shift = std::max(_minShift, std::min(_maxShift, shift));
+                    break;
+                }
+            }
+            shift *= _shiftRatio*_shiftRatio; // be more conservative
+        }
+        if (!accepted) {
+            LogManager::logString("\nStopping Reason: Stabilization shift exceeded maximum.\n");
+            break;
+        }
+    }
+
+    LogManager::logString("\nEnd LinearMethod::findMin() procedure\n");
+}
+} // namespace nfm
@@ -0,0 +1,105 @@
+#include "nfm/Lion.hpp"
+
+#include "nfm/LogManager.hpp"
+#include "nfm/VecKernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace nfm
+{
+
+// --- Constructor
+
+Lion::Lion(const int ndim, const bool useAveraging, const double stepSize):
+        NFM(ndim, true), _useAveraging(useAveraging), _stepSize(std::max(0., stepSize))
+{
+    // override defaults
+    this->setGradErrStop(false); // don't stop on noisy-low gradients, by default
+}
+
+// --- Minimization
+
+void Lion::_atBegin()
+{
+    LogManager::logString("\nBegin Lion::findMin() procedure\n");
+
+    // the only state vector (at the configured precision), unless resuming from a checkpoint or continuing
+    if (!this->_isResuming() || _m.size() != _grad.size()) {
+        this->_initStateBuffer(_m, _grad.size());
+        _iter = 0;
+    }
+    _flag_finalEval = false;
+
+    //begin the minimization loop
+    this->_requestNextStep();
+}
+
+void Lion::_requestNextStep()
+{
+    ++_iter;
+    if (LogManager::isLoggingOn()) { // else skip string construction
+        LogManager::logString("\nLion::findMin() Step " + std::to_string(_iter) + "\n");
+    }
+    this->_requestEval(_last.x, true, true); // current gradient and target value
+}
+
+void Lion::_atResult()
+{
+    _last.f = _evalF;
+    if (_flag_finalEval) { // value at the averaged position
+        LogManager::logString("\nEnd Lion::findMin() procedure\n");
+        return;
+    }
+    _storeLastValue();
+    _writeGradientToLog();
+
+    if (_shouldStop()) {
+        if (_useAveraging) { // calculate the old value average as end result
+            this->_averageOldX();
+            _flag_finalEval = true;
+            this->_requestEval(_last.x, true, false);
+            return;
+        }
+        LogManager::logString("\nEnd Lion::findMin() procedure\n");
+        return;
+    }
+
+    // factor for the error of c = beta1*m + (1-beta1)*g, relative to the current gradient error
+    // (m has variance (1-beta2)/(1+beta2)*err^2 for stationary uncorrelated noise)
+    const bool useErr = _useNoisyFreeze && this->hasGradErr();
+    const double errfac = NoisyValue::getSigmaLevel()*sqrt((1. - _beta1)*(1. - _beta1) + _beta1*_beta1*(1. - _beta2)/(1. + _beta2));
+
+    // sign update and momentum update, fused
+    this->_parallelFor([&](const size_t begin, const size_t end)
+                       {
+                           updateBlockwise<1>({&_m}, begin, end, [&](const size_t b0, const size_t len, const std::array<double *, 1> &mb)
+                           {
+                               vk::lionStep(_last.x.data() + b0, mb[0], _grad.val.data() + b0, useErr ? _grad.err.data() + b0 : nullptr,
+                                            len, _beta1, _beta2, _stepSize, errfac);
+                           });
+                       });
+    this->_checkpoint();
+    this->_requestNextStep();
+}
+
+// --- Checkpoints
+
+void Lion::_writeState(StateWriter &out) const
+{
+    out.write(std::string("Lion"));
+    _m.write(out);
+    out.write(static_cast<int32_t>(_iter));
+}
+
+void Lion::_readState(StateReader &in)
+{
+    in.expectTag("Lion");
+    this->_readStateBuffer(in, _m);
+    _iter = in.read<int32_t>();
+
+    if (_m.size() != _grad.size()) {
+        throw std::invalid_argument("[Lion] Checkpoint state doesn't match the current configuration.");
+    }
+}
+} // namespace nfm
@@ -0,0 +1,57 @@
+#include "nfm/MappedAllocator.hpp"
+
+#include <new>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#define NFM_HAS_MMAP
+#endif
+
+namespace nfm
+{
+
+void * mappedAllocate(const size_t bytes, const std::string &dir)
+{
+    if (dir.empty() || bytes < mappedMinBytes) { return ::operator new(bytes); }
+#ifdef NFM_HAS_MMAP
+    // create and immediately unlink a temporary file, which lives on until munmap
+    std::string path = dir + "/nfm_stateXXXXXX";
+    std::vector<char> cpath(path.begin(), path.end());
+    cpath.push_back('\0');
+    const int fd = mkstemp(cpath.data());
+    if (fd < 0) { throw std::bad_alloc(); }
+    unlink(cpath.data());
+    // reserve the disk blocks now, because running out of space on a store into a sparse mapping would raise SIGBUS
+#ifdef __APPLE__
+    fstore_t store = {F_ALLOCATEALL, F_PEOFPOSMODE, 0, static_cast<off_t>(bytes), 0};
+    if (fcntl(fd, F_PREALLOCATE, &store) == -1 || ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+#else
+    if (posix_fallocate(fd, 0, static_cast<off_t>(bytes)) != 0) {
+#endif
+        close(fd);
+        throw std::bad_alloc();
+    }
+    void * ptr = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd); // the mapping keeps the file
+    if (ptr == MAP_FAILED) { throw std::bad_alloc(); }
+    madvise(ptr, bytes, MADV_SEQUENTIAL); // optimizers pass over their state vectors in order
+    return ptr;
+#else
+    throw std::bad_alloc(); // memory mapping not supported
+#endif
+}
+
+void mappedDeallocate(void * ptr, const size_t bytes, const std::string &dir)
+{
+    if (dir.empty() || bytes < mappedMinBytes) {
+        ::operator delete(ptr);
+        return;
+    }
+#ifdef NFM_HAS_MMAP
+    munmap(ptr, bytes);
+#endif
+}
+} // namespace nfm
@@ -0,0 +1,256 @@
+#include "nfm/MultiStart.hpp"
+
+#include "nfm/ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace sobol_detail
+{
+// Primitive polynomials (degree s, coefficients a) and initial direction numbers m_1..m_s
+// for the Sobol dimensions 2 to 21 (S. Joe and F. Y. Kuo, new-joe-kuo-6.21201)
+struct SobolPoly
+{
+    int s;
+    unsigned a;
+    unsigned m[7];
+};
+
+static constexpr SobolPoly POLYS[nfm::maxSobolDim - 1] = {
+        {1, 0,  {1}},
+        {2, 1,  {1, 3}},
+        {3, 1,  {1, 3, 1}},
+        {3, 2,  {1, 1, 1}},
+        {4, 1,  {1, 1, 3, 3}},
+        {4, 4,  {1, 3, 5, 13}},
+        {5, 2,  {1, 1, 5, 5, 17}},
+        {5, 4,  {1, 1, 5, 5, 5}},
+        {5, 7,  {1, 1, 7, 11, 19}},
+        {5, 11, {1, 1, 5, 1, 1}},
+        {5, 13, {1, 1, 1, 3, 11}},
+        {5, 14, {1, 3, 5, 5, 31}},
+        {6, 1,  {1, 3, 3, 9, 7, 49}},
+        {6, 13, {1, 1, 1, 15, 21, 21}},
+        {6, 16, {1, 3, 1, 13, 27, 49}},
+        {6, 19, {1, 1, 1, 15, 7, 5}},
+        {6, 22, {1, 3, 1, 15, 13, 25}},
+        {6, 25, {1, 1, 5, 5, 19, 61}},
+        {7, 1,  {1, 3, 7, 11, 23, 15, 103}},
+        {7, 4,  {1, 3, 7, 13, 13, 15, 69}}
+};
+
+static constexpr int NBITS = 32;
+
+// direction numbers v_k (k = 1..32, stored from index 0) of dimension idim (from 0)
+void directionNumbers(const int idim, uint32_t v[NBITS])
+{
+    if (idim == 0) { // van der Corput sequence
+        for (int k = 0; k < NBITS; ++k) { v[k] = 1u << (NBITS - 1 - k); }
+        return;
+    }
+    const SobolPoly &poly = POLYS[idim - 1];
+    const int s = poly.s;
+    for (int k = 0; k < s; ++k) { v[k] = poly.m[k] << (NBITS - 1 - k); }
+    for (int k = s; k < NBITS; ++k) {
+        v[k] = v[k - s] ^ (v[k - s] >> s);
+        for (int j = 1; j < s; ++j) {
+            if ((poly.a >> (s - 1 - j)) & 1u) { v[k] ^= v[k - j]; }
+        }
+    }
+}
+} // namespace sobol_detail
+
+namespace nfm
+{
+
+// --- Low-discrepancy sequences
+
+std::vector<double> sobolPoint(const int ndim, const int index)
+{
+    if (ndim < 1 || ndim > maxSobolDim) {
+        throw std::invalid_argument("[nfm::sobolPoint] Sobol points are only available for 1 to " + std::to_string(maxSobolDim) + " dimensions.");
+    }
+    if (index < 0) {
+        throw std::invalid_argument("[nfm::sobolPoint] The index must be non-negative.");
+    }
+    const auto gray = static_cast<uint32_t>(index ^ (index >> 1)); // gray code ordering
+    std::vector<double> x(static_cast<size_t>(ndim));
+    uint32_t v[sobol_detail::NBITS];
+    for (int i = 0; i < ndim; ++i) {
+        sobol_detail::directionNumbers(i, v);
+        uint32_t xi = 0;
+        for (int k = 0; k < sobol_detail::NBITS; ++k) {
+            if ((gray >> k) & 1u) { xi ^= v[k]; }
+        }
+        x[i] = xi/4294967296.; // 2^32
+    }
+    return x;
+}
+
+std::vector<double> haltonPoint(const int ndim, const int index)
+{
+    if (ndim < 1) {
+        throw std::invalid_argument("[nfm::haltonPoint] The number of dimensions must be positive.");
+    }
+    if (index < 0) {
+        throw std::invalid_argument("[nfm::haltonPoint] The index must be non-negative.");
+    }
+    std::vector<double> x(static_cast<size_t>(ndim));
+    int base = 1;
+    for (int i = 0; i < ndim; ++i) {
+        // next prime base
+        bool isPrime;
+        do {
+            ++base;
+            isPrime = true;
+            for (int d = 2; d*d <= base; ++d) {
+                if (base%d == 0) {
+                    isPrime = false;
+                    break;
+                }
+            }
+        } while (!isPrime);
+
+        // radical inverse of index in base
+        double xi = 0., fac = 1./base;
+        for (int n = index; n > 0; n /= base) {
+            xi += (n%base)*fac;
+            fac /= base;
+        }
+        x[i] = xi;
+    }
+    return x;
+}
+
+
+// --- MultiStart
+
+MultiStart::MultiStart(const std::vector<double> &lbounds, const std::vector<double> &ubounds,
+                       const std::function<std::unique_ptr<NFM>()> &makeOpt):
+        _ndim(static_cast<int>(lbounds.size())), _lbounds(lbounds), _ubounds(ubounds), _makeOpt(makeOpt)
+{
+    if (_ndim < 1 || lbounds.size() != ubounds.size()) {
+        throw std::invalid_argument("[MultiStart] The bounds must be non-empty and of equal size.");
+    }
+    for (int i = 0; i < _ndim; ++i) {
+        if (!(lbounds[i] < ubounds[i])) {
+            throw std::invalid_argument("[MultiStart] The lower bounds must be smaller than the upper bounds.");
+        }
+    }
+    if (!_makeOpt) {
+        throw std::invalid_argument("[MultiStart] The optimizer factory must not be empty.");
+    }
+}
+
+void MultiStart::setNStarts(const int nstarts)
+{
+    if (nstarts < 1) {
+        throw std::invalid_argument("[MultiStart::setNStarts] The number of starts must be at least 1.");
+    }
+    _nstarts = nstarts;
+}
+
+void MultiStart::setNThreads(const int nthreads)
+{
+    if (nthreads < 1) {
+        throw std::invalid_argument("[MultiStart::setNThreads] Number of threads must be at least 1.");
+    }
+    _nthreads = nthreads;
+}
+
+std::vector<std::vector<double>> MultiStart::getStartingPoints() const
+{
+    std::vector<std::vector<double>> points;
+    points.reserve(static_cast<size_t>(_nstarts));
+    for (int is = 0; is < _nstarts; ++is) { // skip the sequence's initial point 0 (a box corner)
+        std::vector<double> x = (_startSeq == StartSequence::Sobol) ? sobolPoint(_ndim, is + 1) : haltonPoint(_ndim, is + 1);
+        for (int i = 0; i < _ndim; ++i) { x[i] = _lbounds[i] + x[i]*(_ubounds[i] - _lbounds[i]); }
+        points.push_back(std::move(x));
+    }
+    return points;
+}
+
+std::vector<MultiStartResult> MultiStart::_runAll(const std::function<NoisyFunction &(std::unique_ptr<NoisyFunction> &)> &getFun) const
+{
+    const std::vector<std::vector<double>> x0s = this->getStartingPoints(); // throws on unsupported ndim
+    std::vector<MultiStartResult> results(x0s.size());
+    for (int is = 0; is < _nstarts; ++is) {
+        results[is].istart = is;
+        results[is].x0 = x0s[is];
+    }
+
+    std::atomic<int> nextStart{0}; // next start to be run by any thread
+    std::atomic<bool> flag_stop{false}; // early stop (or error) happened
+    std::mutex errMutex;
+    std::exception_ptr error;
+
+    ThreadPool pool(std::min(_nthreads, _nstarts));
+    pool.run([&](int)
+             {
+                 int is;
+                 while ((is = nextStart++) < _nstarts && !flag_stop) {
+                     MultiStartResult &res = results[is];
+                     try {
+                         std::unique_ptr<NFM> opt = _makeOpt();
+                         if (!opt) {
+                             throw std::invalid_argument("[MultiStart::findMin] The optimizer factory returned no optimizer.");
+                         }
+                         std::unique_ptr<NoisyFunction> ownFun;
+                         NoisyFunction &fun = getFun(ownFun);
+
+                         // let the runs stop on early stop, in addition to the optimizer's own policy
+                         const std::function<bool(NFM &, NoisyFunction &)> policy = opt->getPolicy();
+                         opt->setPolicy([&flag_stop, &res, policy](NFM &nfm, NoisyFunction &f)
+                                        {
+                                            if (flag_stop) {
+                                                res.flag_stopped = true;
+                                                return true;
+                                            }
+                                            return policy ? policy(nfm, f) : false;
+                                        });
+
+                         res.last = opt->findMin(fun, res.x0);
+                         res.niter = static_cast<int>(opt->getIter());
+                         res.flag_run = true;
+                         if (_flag_target && !res.flag_stopped && res.last.f < _target) { flag_stop = true; }
+                     }
+                     catch (...) {
+                         std::lock_guard<std::mutex> lock(errMutex);
+                         if (!error) { error = std::current_exception(); }
+                         flag_stop = true;
+                     }
+                 }
+             });
+    if (error) { std::rethrow_exception(error); }
+
+    // finished runs by ascending value, then the skipped ones in start order
+    std::stable_sort(results.begin(), results.end(), [](const MultiStartResult &r1, const MultiStartResult &r2)
+    {
+        if (r1.flag_run != r2.flag_run) { return r1.flag_run; }
+        return r1.flag_run && (r1.last.f.val < r2.last.f.val || (r1.last.f.val == r2.last.f.val && r1.last.f.err < r2.last.f.err));
+    });
+    return results;
+}
+
+std::vector<MultiStartResult> MultiStart::findMin(NoisyFunction &targetFun)
+{
+    return this->_runAll([&targetFun](std::unique_ptr<NoisyFunction> &) -> NoisyFunction & { return targetFun; });
+}
+
+std::vector<MultiStartResult> MultiStart::findMin(const std::function<std::unique_ptr<NoisyFunction>()> &makeFun)
+{
+    return this->_runAll([&makeFun](std::unique_ptr<NoisyFunction> &ownFun) -> NoisyFunction &
+                         {
+                             ownFun = makeFun();
+                             if (!ownFun) {
+                                 throw std::invalid_argument("[MultiStart::findMin] The function factory returned no function.");
+                             }
+                             return *ownFun;
+                         });
+}
+} // namespace nfm
@@ -0,0 +1,180 @@
+#include "nfm/NelderMead.hpp"
+
+#include "nfm/LogManager.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace nfm
+{
+
+// --- Constructor
+
+NelderMead::NelderMead(const int ndim, const double initStep):
+        NFM(ndim, false), _initStep((initStep != 0.) ? initStep : 0.1)
+{
+    // override defaults
+    this->setEpsX(0.); // the best vertex often stays the same, so we use the simplex size instead
+}
+
+// --- Parameter sets
+
+void NelderMead::useStandardParams()
+{
+    _fRefl = 1.;
+    _fExp = 2.;
+    _fContr = 0.5;
+    _fShrink = 0.5;
+}
+
+void NelderMead::useAdaptiveParams()
+{
+    const double nd = _ndim;
+    _fRefl = 1.;
+    _fExp = 1. + 2./nd;
+    _fContr = 0.75 - 0.5/nd;
+    _fShrink = 1. - 1./nd;
+    if (_ndim == 1) { _fShrink = 0.5; } // otherwise we would not shrink at all
+}
+
+// --- Internal methods
+
+bool NelderMead::_isSimplexSmall(const std::vector<NoisyIOPair> &simplex) const
+{
+    if (_simplexTol <= 0.) { return false; }
+    const std::vector<double> &xb = simplex[0].x;
+    for (size_t iv = 1; iv < simplex.size(); ++iv) {
+        double dist = 0.;
+        for (int i = 0; i < _ndim; ++i) { dist += (simplex[iv].x[i] - xb[i])*(simplex[iv].x[i] - xb[i]); }
+        if (sqrt(dist) >= _simplexTol) { return false; }
+    }
+    LogManager::logString("\nStopping Reason: Simplex size below tolerance.\n");
+    return true;
+}
+
+// --- Minimization
+
+void NelderMead::_findMin()
+{
+    LogManager::logString("\nBegin NelderMead::findMin() procedure\n");
+
+    // indices of the candidate points
+    enum Cand
+    {
+        REFL = 0, EXP = 1, OCON = 2, ICON = 3, BEST = 4
+    };
+
+    // initial simplex, evaluated as one batch
+    const auto nvert = static_cast<size_t>(_ndim + 1);
+    std::vector<NoisyIOPair> simplex(nvert, _last);
+    std::vector<std::vector<double>> xs(nvert, _last.x); // batch positions
+    std::vector<NoisyValue> fs; // batch values
+    for (int i = 0; i < _ndim; ++i) { xs[i + 1][i] += _initStep; }
+    _targetfun->fbatch(xs, fs);
+    for (size_t iv = 0; iv < nvert; ++iv) {
+        simplex[iv].x = xs[iv];
+        simplex[iv].f = fs[iv];
+    }
+
+    // candidate buffers
+    const int ncand = _flag_reevalBest ? 5 : 4;
+    std::vector<std::vector<double>> cxs(static_cast<size_t>(ncand), _last.x);
+    std::vector<NoisyValue> cfs(static_cast<size_t>(ncand));
+    std::vector<bool> evaluated(static_cast<size_t>(ncand));
+    std::vector<double> centroid(_last.x.size());
+
+    // lazy evaluation of candidates (only used when batching is off)
+    auto candF = [&](const int k)
+    {
+        if (!evaluated[k]) {
+            cfs[k] = _targetfun->f(cxs[k]);
+            evaluated[k] = true;
+        }
+        return cfs[k];
+    };
+
+    //begin the minimization loop
+    int iter = 0;
+    while (true) {
+        ++iter;
+        if (LogManager::isLoggingOn()) { // else skip string construction
+            LogManager::logString("\nNelderMead::findMin() Step " + std::to_string(iter) + "\n");
+        }
+
+        // order vertices by value and store the best one
+        std::sort(simplex.begin(), simplex.end(), [](const NoisyIOPair &a, const NoisyIOPair &b) { return a.f.val < b.f.val; });
+        _last = simplex[0];
+        this->_storeLastValue();
+        if (this->_shouldStop() || this->_isSimplexSmall(simplex)) { break; }
+
+        NoisyIOPair &best = simplex[0];
+        NoisyIOPair &secw = simplex[nvert - 2]; // second worst (== best for 1D)
+        NoisyIOPair &worst = simplex[nvert - 1];
+
+        // centroid of all but the worst vertex
+        std::fill(centroid.begin(), centroid.end(), 0.);
+        for (size_t iv = 0; iv < nvert - 1; ++iv) {
+            for (int i = 0; i < _ndim; ++i) { centroid[i] += simplex[iv].x[i]; }
+        }
+        for (double &ci : centroid) { ci /= _ndim; }
+
+        // candidate positions
+        const double fac[4]{_fRefl, _fRefl*_fExp, _fRefl*_fContr, -_fContr};
+        for (int k = 0; k < 4; ++k) {
+            for (int i = 0; i < _ndim; ++i) { cxs[k][i] = centroid[i] + fac[k]*(centroid[i] - worst.x[i]); }
+        }
+        if (_flag_reevalBest) { cxs[BEST] = best.x; }
+
+        // evaluate
+        std::fill(evaluated.begin(), evaluated.end(), false);
+        if (_flag_batch) {
+            _targetfun->fbatch(cxs, cfs);
+            std::fill(evaluated.begin(), evaluated.end(), true);
+        }
+        if (_flag_reevalBest) { best.f = candF(BEST); }
+
+        // decide which candidate replaces the worst vertex (-1 means shrink)
+        int accept = -1;
+        std::string action;
+        const NoisyValue fr = candF(REFL);
+        if (fr < best.f) { // reflection is a new best, try to expand
+            accept = (candF(EXP) < fr) ? EXP : REFL;
+            action = (accept == EXP) ? "expand" : "reflect";
+        }
+        else if (fr < secw.f) {
+            accept = REFL;
+            action = "reflect";
+        }
+        else if (fr < worst.f) {
+            if (candF(OCON) <= fr) { accept = OCON; }
+            action = "outside contraction";
+        }
+        else {
+            if (candF(ICON) < worst.f) { accept = ICON; }
+            action = "inside contraction";
+        }
+
+        if (accept >= 0) {
+            worst.x = cxs[accept];
+            worst.f = cfs[accept];
+        }
+        else { // shrink towards the best vertex, again as one batch
+            action = "shrink";
+            xs.resize(nvert - 1);
+            for (size_t iv = 1; iv < nvert; ++iv) {
+                for (int i = 0; i < _ndim; ++i) {
+                    xs[iv - 1][i] = best.x[i] + _fShrink*(simplex[iv].x[i] - best.x[i]);
+                }
+            }
+            _targetfun->fbatch(xs, fs);
+            for (size_t iv = 1; iv < nvert; ++iv) {
+                simplex[iv].x = xs[iv - 1];
+                simplex[iv].f = fs[iv - 1];
+            }
+        }
+        LogManager::logString("Simplex update: " + action + "\n", LogLevel::VERBOSE);
+    }
+
+    LogManager::logString("\nEnd NelderMead::findMin() procedure\n");
+}
+} // namespace nfm
@@ -1,24 +1,57 @@
 #include "nfm/NoisyFunMin.hpp"
 
 #include "nfm/LogManager.hpp"
+#include "nfm/ThreadPool.hpp"
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <numeric>
 #include <sstream>
+#include <stdexcept>
 
 
 namespace nfm
 {
+namespace
+{
+// Stands in for the target function when the policy is called in ask/tell mode (no target object)
+class AskTellTarget: public NoisyFunction
+{
+public:
+    explicit AskTellTarget(int ndim): NoisyFunction(ndim) {}
+
+    NoisyValue f(const std::vector<double> &) override
+    {
+        throw std::invalid_argument("[NFM] The target function can't be evaluated by the policy in ask/tell mode.");
+    }
+};
+
+// checkpoint file header
+const char CKPT_MAGIC[8] = "NFMCKPT";
+const uint32_t CKPT_VERSION = 2;
+} // namespace
 
 // --- Constructor
 
 NFM::NFM(const int ndim, const bool needsGrad):
-        _ndim(ndim), _flag_needsGrad(needsGrad), _last(_ndim), _grad(_ndim), _flag_gradErrStop(needsGrad /*default*/)
+        _ndim(ndim), _flag_needsGrad(needsGrad), _last(_ndim), _grad(_ndim), _flag_gradErrStop(needsGrad /*default*/), _layout(ndim)
 {
     _old_values.reserve(static_cast<size_t>(_max_n_const_values));
 }
 
+NFM::NFM(const NFM &other):
+        _ndim(other._ndim), _flag_needsGrad(other._flag_needsGrad), _last(other._last), _grad(other._grad),
+        _old_values(other._old_values), _flag_gradErrStop(other._flag_gradErrStop), _epsx(other._epsx), _epsf(other._epsf),
+        _max_n_iterations(other._max_n_iterations), _max_n_const_values(other._max_n_const_values),
+        _lastDeltaX(other._lastDeltaX), _lastDeltaF(other._lastDeltaF), _istep(other._istep),
+        _flag_policyStop(other._flag_policyStop), _flag_validGrad(other._flag_validGrad), _flag_validGradErr(other._flag_validGradErr),
+        _policy(other._policy), _parThreshold(other._parThreshold), _statePrec(other._statePrec), _stateMapDir(other._stateMapDir),
+        _layout(other._layout), _flag_resume(other._flag_resume), _flag_continue(other._flag_continue), _contDecay(other._contDecay),
+        _evalF(other._evalF) {}
+
+NFM::~NFM() = default; // ThreadPool is complete here
+
 
 // --- Private methods
 
@@ -45,11 +78,15 @@ void NFM::_updateDeltas()
     if (!_old_values.empty()) {
         const NoisyIOPair &old = _old_values.back(); // reference to last old value
         // deltaX
-        _lastDeltaX = 0.;
-        for (int i = 0; i < _ndim; ++i) {
-            _lastDeltaX += pow(old.x[i] - _last.x[i], 2);
-        }
-        _lastDeltaX = sqrt(_lastDeltaX);
+        _lastDeltaX = sqrt(this->_parallelSum([&](const size_t begin, const size_t end)
+                                              {
+                                                  double dx2 = 0.;
+                                                  for (size_t i = begin; i < end; ++i) {
+                                                      const double dxi = old.x[i] - _last.x[i];
+                                                      dx2 += dxi*dxi;
+                                                  }
+                                                  return dx2;
+                                              }));
         // deltaF
         _lastDeltaF = std::max(0., _last.f.minDist(old.f));
     }
@@ -91,8 +128,44 @@ void NFM::_storeLastValue()
     // update old value list
     _old_values.push_back(_last); // oldest element will be deleted (if full)
 
+    this->_endStep();
+}
+
+void NFM::_storeLastValueSparse(const double deltaX2, const bool storeX)
+{
+    this->_writeCurrentXToLog();
+
+    // changes in x and f (the untouched coordinates didn't move)
+    if (!_old_values.empty()) {
+        _lastDeltaX = sqrt(deltaX2);
+        _lastDeltaF = std::max(0., _last.f.minDist(_old_values.back().f));
+    }
+    else { // is first step, initialize deltas
+        _lastDeltaX = _epsx;
+        _lastDeltaF = _epsf;
+    }
+
+    // update old value list, without copying x unless required
+    if (storeX) { _old_values.push_back(_last); }
+    else {
+        NoisyIOPair fonly; // empty x
+        fonly.f = _last.f;
+        _old_values.push_back(std::move(fonly)); // frees the x of a replaced element
+    }
+
+    this->_endStep();
+}
+
+void NFM::_endStep()
+{
     // call policy
-    if (_policy) { _flag_policyStop = _policy(*this, *_targetfun); }
+    if (_policy) {
+        if (_targetfun != nullptr) { _flag_policyStop = _policy(*this, *_targetfun); }
+        else { // ask/tell mode
+            AskTellTarget placeholder(_ndim);
+            _flag_policyStop = _policy(*this, placeholder);
+        }
+    }
 
     // count step
     ++_istep;
@@ -100,14 +173,35 @@ void NFM::_storeLastValue()
 
 void NFM::_averageOldValues()
 {
-    std::fill(_last.x.begin(), _last.x.end(), 0.);
-    for (const auto &oldp : _old_values.vec()) {
-        std::transform(_last.x.begin(), _last.x.end(), oldp.x.begin(), _last.x.begin(), std::plus<>());
-    }
-    for (double &x : _last.x) { x /= _old_values.size(); } // get proper averages
+    this->_averageOldX();
     _last.f = _targetfun->f(_last.x); // evaluate final function value
 }
 
+void NFM::_averageOldX()
+{
+    this->_parallelFor([&](const size_t begin, const size_t end)
+                       {
+                           std::fill(_last.x.begin() + begin, _last.x.begin() + end, 0.);
+                           for (const auto &oldp : _old_values.vec()) {
+                               for (size_t i = begin; i < end; ++i) { _last.x[i] += oldp.x[i]; }
+                           }
+                           for (size_t i = begin; i < end; ++i) { _last.x[i] /= _old_values.size(); } // get proper averages
+                       });
+}
+
+
+void NFM::_updateGradFromSparse(const NoisySparseGradient &sgradOld, const NoisySparseGradient &sgradNew)
+{
+    for (const int i : sgradOld.idx) {
+        _grad.val[i] = 0.;
+        _grad.err[i] = 0.;
+    }
+    for (size_t k = 0; k < sgradNew.nnz(); ++k) {
+        _grad.val[sgradNew.idx[k]] = sgradNew.val[k];
+        _grad.err[sgradNew.idx[k]] = sgradNew.err[k];
+    }
+}
+
 
 bool NFM::_isGradNoisySmall(const bool flag_log) const
 {
@@ -128,6 +222,131 @@ bool NFM::_shouldStop() const
     return (_isConverged() || !_changedEnough() || _stepLimitReached() || _isGradNoisySmall());
 }
 
+bool NFM::_shouldStopSparse(const NoisySparseGradient &sgrad) const
+{   // like _shouldStop(), but checks only the non-zero gradient elements for noise
+    if (_flag_policyStop) {
+        LogManager::logString("\nStopping Reason: User provided policy.\n");
+        return true;
+    }
+    if (_isConverged() || !_changedEnough() || _stepLimitReached()) { return true; }
+    if (_flag_gradErrStop && this->hasGradErr()) {
+        for (size_t k = 0; k < sgrad.nnz(); ++k) {
+            if (fabs(sgrad.val[k]) - NoisyValue::getSigmaLevel()*sgrad.err[k] > 0.) { return false; }
+        }
+        LogManager::logString("\nStopping Reason: Gradient is dominated by noise.\n");
+        return true;
+    }
+    return false;
+}
+
+
+void NFM::_writeBaseState(StateWriter &out) const
+{
+    out.write(_last.x);
+    out.write(_last.f);
+    out.write(_grad.val);
+    out.write(_grad.err);
+    out.write(_lastDeltaX);
+    out.write(_lastDeltaF);
+    out.write(static_cast<int32_t>(_istep));
+
+    // old values in storage order (so averages are reproduced bitwise), with the storage index of the oldest
+    const auto ifront = static_cast<uint64_t>(_old_values.empty() ? 0 : &_old_values.front() - _old_values.data());
+    out.write(static_cast<uint64_t>(_old_values.capacity()));
+    out.write(static_cast<uint64_t>(_old_values.size()));
+    out.write(ifront);
+    for (const auto &oldp : _old_values.vec()) {
+        out.write(oldp.x);
+        out.write(oldp.f);
+    }
+}
+
+void NFM::_readBaseState(StateReader &in)
+{
+    const auto nd = static_cast<size_t>(_ndim);
+    in.read(_last.x, nd);
+    _last.f = in.read<NoisyValue>();
+    in.read(_grad.val, nd);
+    in.read(_grad.err, nd);
+    _lastDeltaX = in.read<double>();
+    _lastDeltaF = in.read<double>();
+    _istep = in.read<int32_t>();
+
+    const auto ncap = in.read<uint64_t>();
+    const auto nold = static_cast<size_t>(in.readLength());
+    const auto ifront = static_cast<size_t>(in.read<uint64_t>());
+    if (ifront > 0 && ifront >= nold) {
+        throw std::invalid_argument("[NFM::loadCheckpoint] Invalid old value list in checkpoint.");
+    }
+    std::vector<NoisyIOPair> olds(nold, NoisyIOPair(_ndim));
+    for (auto &oldp : olds) {
+        in.read(oldp.x, nd);
+        oldp.f = in.read<NoisyValue>();
+    }
+    _old_values.clear();
+    if (ncap == _old_values.capacity()) { // restore the storage order
+        for (const auto &oldp : olds) { _old_values.push_back(oldp); }
+        for (size_t i = 0; i < ifront; ++i) { _old_values.push_back(olds[i]); } // same values again, to restore the write position
+    }
+    else { // restore the insertion order only (excess old values are dropped)
+        for (size_t i = 0; i < nold; ++i) { _old_values.push_back(olds[(ifront + i)%nold]); }
+    }
+}
+
+void NFM::_initStateBuffer(StateBuffer &buf, const size_t n, const StatePrecision prec, const bool nonNegative) const
+{
+    if (buf.getMapDir() == _stateMapDir) { buf.assign(n, prec, nonNegative); }
+    else { buf = StateBuffer(n, prec, nonNegative, _stateMapDir); }
+}
+
+void NFM::_readStateBuffer(StateReader &in, StateBuffer &buf, const StatePrecision prec) const
+{
+    buf = this->_makeStateBuffer(0); // for the memory mapping
+    buf.read(in); // restores the precision of the checkpoint
+    buf.convert(prec);
+}
+
+void NFM::_checkpoint()
+{
+    if (_ckptEvery > 0 && _istep%_ckptEvery == 0) {
+        StateWriter out;
+        out.writeArray(CKPT_MAGIC, sizeof(CKPT_MAGIC));
+        out.write(CKPT_VERSION);
+        out.write(static_cast<int32_t>(_ndim));
+        this->_writeBaseState(out);
+        this->_writeState(out);
+        out.write(std::string("END"));
+        _ckptWriter->write(_ckptPath, std::move(out.data())); // returns immediately
+    }
+}
+
+void NFM::_requestEval(const std::vector<double> &x, const bool needsValue, const bool needsGrad)
+{
+    _request.x = x;
+    _request.needsValue = needsValue;
+    _request.needsGrad = needsGrad;
+    _flag_pending = true;
+}
+
+void NFM::_findMinAskTell()
+{
+    _flag_pending = false;
+    this->_atBegin();
+    while (_flag_pending) { // serve the requests with the target function
+        _flag_pending = false;
+        if (!_request.needsGrad) {
+            _evalF = _targetfun->f(_request.x);
+        }
+        else if (_request.needsValue) {
+            _evalF = _gradfun->fgrad(_request.x, _grad);
+        }
+        else {
+            _gradfun->grad(_request.x, _grad);
+        }
+        this->_atResult();
+    }
+}
+
 
 // --- Loggers
 
@@ -172,6 +391,73 @@ void NFM::setMaxNConstValues(int maxn_const_values)
     _old_values.set_cap(static_cast<size_t>(_max_n_const_values));
 }
 
+void NFM::setNThreads(const int nthreads)
+{
+    _nthreads = std::max(1, nthreads);
+    _pool.reset((_nthreads > 1) ? new ThreadPool(_nthreads) : nullptr);
+}
+
+void NFM::_poolFor(const std::function<void(size_t, size_t)> &fn) const
+{
+    _pool->parallelFor(static_cast<size_t>(_ndim), fn);
+}
+
+double NFM::_poolSum(const std::function<double(size_t, size_t)> &fn) const
+{
+    return _pool->parallelSum(static_cast<size_t>(_ndim), fn);
+}
+
+void NFM::setParamLayout(const ParamLayout &layout)
+{
+    if (layout.getSize() != _ndim) {
+        throw std::invalid_argument("[NFM::setParamLayout] Passed layout size didn't match NFM's number of dimensions.");
+    }
+    _layout = layout;
+}
+
+void NFM::setCheckpointing(const std::string &path, const int everyNIter)
+{
+    _ckptPath = path;
+    _ckptEvery = path.empty() ? 0 : std::max(0, everyNIter);
+    if (_ckptEvery > 0) {
+        if (!_ckptWriter) { _ckptWriter.reset(new AsyncFileWriter()); }
+    }
+    else { _ckptWriter.reset(); } // waits for pending writes
+}
+
+void NFM::loadCheckpoint(const std::string &path)
+{
+    if (!this->_supportsCheckpoints()) {
+        throw std::invalid_argument("[NFM::loadCheckpoint] The optimizer doesn't support checkpoints in its current configuration.");
+    }
+    const std::vector<char> data = AsyncFileWriter::readFile(path);
+    StateReader in(data);
+    char magic[sizeof(CKPT_MAGIC)];
+    in.readArray(magic, sizeof(magic));
+    if (std::memcmp(magic, CKPT_MAGIC, sizeof(magic)) != 0) {
+        throw std::invalid_argument("[NFM::loadCheckpoint] " + path + " is not a checkpoint file.");
+    }
+    if (in.read<uint32_t>() != CKPT_VERSION) {
+        throw std::invalid_argument("[NFM::loadCheckpoint] Unsupported checkpoint version.");
+    }
+    if (in.read<int32_t>() != _ndim) {
+        throw std::invalid_argument("[NFM::loadCheckpoint] Checkpoint's number of dimensions is not equal to NFM's number of dimensions.");
+    }
+    this->_readBaseState(in);
+    this->_readState(in);
+    in.expectTag("END");
+    if (!in.atEnd()) {
+        throw std::invalid_argument("[NFM::loadCheckpoint] Unexpected data at the end of the checkpoint.");
+    }
+    _flag_resume = true;
+}
+
+void NFM::setContinuation(const bool keepState, const double decay)
+{
+    _flag_continue = keepState;
+    _contDecay = std::max(0., std::min(1., decay));
+}
+
 void NFM::disableStopping()
 { // turn NFM::findMin into an endless loop (unless policy cares for stopping)
     _epsx = 0.;
@@ -183,46 +469,76 @@ void NFM::disableStopping()
 
 // --- findMin
 
-NoisyIOPair NFM::findMin(NoisyFunction &targetfun)
+void NFM::_beginRun()
 {
-    if (targetfun.getNDim() != this->getNDim()) {
-        throw std::invalid_argument("[NFM] Passed target function's number of inputs is not equal to NFM's number of dimensions.");
+    if ((_ckptEvery > 0 || _flag_resume || _flag_continue) && !this->_supportsCheckpoints()) {
+        _flag_resume = false;
+        throw std::invalid_argument("[NFM] The optimizer doesn't support checkpoints/continuation in its current configuration.");
     }
 
-    // setup target function
-    _targetfun = &targetfun; // we keep a pointer during findMin()
-    _gradfun = dynamic_cast<NoisyFunctionWithGradient *>(_targetfun); // we do this single dynamic cast to check for gradient functions
-
-    if (this->needsGrad()) { // setup gradient case
-        if (_gradfun != nullptr) {
-            _flag_validGrad = true; // gradient values will be calulcated and stored
-            _flag_validGradErr = _gradfun->hasGradErr(); // for the errors it also depends on the function's settings
-        }
-        else {
-            throw std::invalid_argument("[NFM] The optimizer requires gradients, but the target function doesn't provide them.");
-        }
+    // for consistency reset some values (unless we continue from a checkpoint or the last call)
+    if (!_flag_resume && _flag_continue && _contDecay > 0.) { // keep state, old values and gradient
+        _flag_continuing = true;
+        _flag_resume = true;
+        _lastDeltaX = _epsx; // checks will pass (like on the first step)
+        _lastDeltaF = _epsf;
+        _istep = 0;
+        if (_contDecay < 1.) { this->_decayState(_contDecay); }
     }
-    else { // gradients will not be calculated
-        _flag_validGrad = false;
-        _flag_validGradErr = false;
+    else if (!_flag_resume) {
+        _last.f.zero();
+        _grad.zero();
+        _old_values.clear();
+        _lastDeltaX = 0.;
+        _lastDeltaF = 0.;
+        _istep = 0;
     }
-
-    // for consistency reset some values
-    _last.f.zero();
-    _grad.zero();
-    _old_values.clear();
-    _lastDeltaX = 0.;
-    _lastDeltaF = 0.;
-    _istep = 0;
     _flag_policyStop = false;
+}
 
-    // find minimum
-    this->_findMin();
-    LogManager::logNoisyIOPair(_last, LogLevel::NORMAL, "Final position and target value");
-
-    // reset temporary pointers
+void NFM::_endRun()
+{
     _targetfun = nullptr;
     _gradfun = nullptr;
+    _flag_askTell = false;
+    _flag_pending = false;
+    _flag_resume = false;
+    _flag_continuing = false;
+}
+
+NoisyIOPair NFM::findMin(NoisyFunction &targetfun)
+{
+    if (targetfun.getNDim() != this->getNDim()) {
+        throw std::invalid_argument("[NFM] Passed target function's number of inputs is not equal to NFM's number of dimensions.");
+    }
+    if (this->isRunning()) {
+        throw std::invalid_argument("[NFM] The optimizer is already running.");
+    }
+    auto * gradfun = dynamic_cast<NoisyFunctionWithGradient *>(&targetfun); // we do this single dynamic cast to check for gradient functions
+    if (this->needsGrad() && gradfun == nullptr) {
+        throw std::invalid_argument("[NFM] The optimizer requires gradients, but the target function doesn't provide them.");
+    }
+    this->_beginRun();
+    {
+        // end the run on return and on exceptions (derived optimizers may throw on unsuitable target functions)
+        struct RunGuard
+        {
+            NFM &nfm;
+            ~RunGuard() { nfm._endRun(); }
+        } runGuard{*this};
+
+        // setup target function
+        _targetfun = &targetfun; // we keep a pointer during findMin()
+        _gradfun = gradfun;
+        _flag_validGrad = this->needsGrad(); // gradient values will be calculated and stored
+        _flag_validGradErr = this->needsGrad() && _gradfun->hasGradErr(); // for the errors it also depends on the function's settings
+
+        // find minimum
+        this->_findMin();
+        LogManager::logNoisyIOPair(_last, LogLevel::NORMAL, "Final position and target value");
+    }
+
+    if (_ckptWriter) { _ckptWriter->flush(); } // make sure the last checkpoint is complete
 
     return _last;
 }
@@ -238,4 +554,81 @@ NoisyIOPair NFM::findMin(NoisyFunction &targetFun, const double x0[])
     this->setX(x0);
     return this->findMin(targetFun);
 }
+
+// --- Ask/tell
+
+void NFM::begin(const bool hasGradErr)
+{
+    if (!this->_supportsAskTell()) {
+        throw std::invalid_argument("[NFM::begin] The optimizer doesn't support the ask/tell interface in its current configuration.");
+    }
+    if (this->isRunning()) {
+        throw std::invalid_argument("[NFM::begin] The optimizer is already running.");
+    }
+    this->_beginRun();
+    _flag_validGrad = this->needsGrad();
+    _flag_validGradErr = this->needsGrad() && hasGradErr;
+    _flag_askTell = true;
+    this->_advanceAskTell(true);
+}
+
+bool NFM::ask(EvalRequest &request) const
+{
+    if (!_flag_askTell) { return false; } // finished (or not begun)
+    request = _request;
+    return true;
+}
+
+void NFM::tell(const NoisyValue f)
+{
+    this->_tell(&f, nullptr);
+}
+
+void NFM::tell(const NoisyGradient &grad)
+{
+    this->_tell(nullptr, &grad);
+}
+
+void NFM::tell(const NoisyValue f, const NoisyGradient &grad)
+{
+    this->_tell(&f, &grad);
+}
+
+void NFM::_tell(const NoisyValue * f, const NoisyGradient * grad)
+{
+    if (!_flag_askTell) {
+        throw std::invalid_argument("[NFM::tell] There is no pending evaluation request.");
+    }
+    if ((_request.needsValue && f == nullptr) || (_request.needsGrad && grad == nullptr)) {
+        throw std::invalid_argument("[NFM::tell] The requested function value or gradient is missing.");
+    }
+    if (_request.needsGrad && (grad->val.size() != _grad.size() || grad->err.size() != _grad.size())) {
+        throw std::invalid_argument("[NFM::tell] Passed gradient's size is not equal to NFM's number of dimensions.");
+    }
+    // results that were not requested are ignored
+    if (_request.needsValue) { _evalF = *f; }
+    if (_request.needsGrad) {
+        std::copy(grad->val.begin(), grad->val.end(), _grad.val.begin());
+        std::copy(grad->err.begin(), grad->err.end(), _grad.err.begin());
+    }
+    this->_advanceAskTell(false);
+}
+
+void NFM::_advanceAskTell(const bool flag_begin)
+{
+    _flag_pending = false;
+    try {
+        if (flag_begin) { this->_atBegin(); }
+        else { this->_atResult(); }
+    }
+    catch (...) {
+        this->_endRun();
+        throw;
+    }
+    if (!_flag_pending) { // the minimization is finished
+        LogManager::logNoisyIOPair(_last, LogLevel::NORMAL, "Final position and target value");
+        this->_endRun();
+        if (_ckptWriter) { _ckptWriter->flush(); } // make sure the last checkpoint is complete
+    }
+}
 } // namespace nfm
@@ -0,0 +1,99 @@
+#include "nfm/NoisyResidualFunction.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace nfm
+{
+
+NoisyResidualFunction::NoisyResidualFunction(const int ndim, const int nres, const bool flag_resErr, const bool flag_jac):
+        NoisyFunctionWithGradient(ndim, flag_resErr), _nres(nres), _flag_jac(flag_jac)
+{
+    if (nres <= 0) {
+        throw std::invalid_argument("[NoisyResidualFunction] Number of residuals must be at least 1.");
+    }
+    _res.resize(static_cast<size_t>(_nres));
+    _res0.resize(_res.size());
+    _resh.resize(_res.size());
+    _xh.resize(static_cast<size_t>(_ndim));
+    _jac.resize(_res.size()*_xh.size());
+}
+
+void NoisyResidualFunction::_fdJacobian(const std::vector<double> &x, const std::vector<NoisyValue> &r0, std::vector<double> &J)
+{
+    _xh = x;
+    for (int i = 0; i < _ndim; ++i) {
+        const double h = _fdStep*std::max(1., fabs(x[i]));
+        _xh[i] = x[i] + h;
+        this->residuals(_xh, _resh);
+        for (int k = 0; k < _nres; ++k) {
+            J[k*_ndim + i] = (_resh[k].val - r0[k].val)/h;
+        }
+        _xh[i] = x[i];
+    }
+}
+
+void NoisyResidualFunction::jacobian(const std::vector<double> &x, std::vector<double> &J)
+{
+    this->residuals(x, _res0);
+    this->_fdJacobian(x, _res0, J);
+}
+
+void NoisyResidualFunction::jacobianAt(const std::vector<double> &x, const std::vector<NoisyValue> &r, std::vector<double> &J)
+{
+    if (_flag_jac) { this->jacobian(x, J); }
+    else { this->_fdJacobian(x, r, J); }
+}
+
+void NoisyResidualFunction::resjac(const std::vector<double> &x, std::vector<NoisyValue> &r, std::vector<double> &J)
+{
+    this->residuals(x, r);
+    this->jacobianAt(x, r, J);
+}
+
+NoisyValue NoisyResidualFunction::sumOfSquares(const std::vector<NoisyValue> &r)
+{
+    NoisyValue ret{0., 0.};
+    for (const NoisyValue rk : r) {
+        ret.val += rk.val*rk.val;
+        ret.err += 4.*rk.val*rk.val*rk.err*rk.err; // (d(r^2)/dr * err)^2
+    }
+    ret.err = sqrt(ret.err);
+    return ret;
+}
+
+NoisyValue NoisyResidualFunction::f(const std::vector<double> &x)
+{
+    this->residuals(x, _res);
+    return sumOfSquares(_res);
+}
+
+void NoisyResidualFunction::grad(const std::vector<double> &x, NoisyGradient &gradv)
+{
+    this->fgrad(x, gradv);
+}
+
+void NoisyResidualFunction::gradFromResiduals(const std::vector<NoisyValue> &r, const std::vector<double> &J, NoisyGradient &gradv)
+{
+    const size_t ndim = gradv.size();
+    gradv.zero();
+    for (size_t k = 0; k < r.size(); ++k) { // row-wise pass over J
+        const double * Jk = J.data() + k*ndim;
+        const double rk = r[k].val;
+        const double ek2 = r[k].err*r[k].err;
+        for (size_t i = 0; i < ndim; ++i) {
+            gradv.val[i] -= 2.*Jk[i]*rk;
+            gradv.err[i] += 4.*Jk[i]*Jk[i]*ek2;
+        }
+    }
+    for (double &e : gradv.err) { e = sqrt(e); }
+}
+
+NoisyValue NoisyResidualFunction::fgrad(const std::vector<double> &x, NoisyGradient &gradv)
+{
+    this->resjac(x, _res, _jac);
+    gradFromResiduals(_res, _jac, gradv);
+    return sumOfSquares(_res);
+}
+} // namespace nfm
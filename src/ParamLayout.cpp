@@ -0,0 +1,32 @@
+#include "nfm/ParamLayout.hpp"
+
+#include <stdexcept>
+
+namespace nfm
+{
+
+void ParamLayout::addVector(const int n)
+{
+    if (n < 1) {
+        throw std::invalid_argument("[ParamLayout::addVector] Vector block size must be positive.");
+    }
+    _blocks.push_back({_size, n, 1});
+    _size += n;
+}
+
+void ParamLayout::addMatrix(const int rows, const int cols)
+{
+    if (rows < 1 || cols < 1) {
+        throw std::invalid_argument("[ParamLayout::addMatrix] Matrix block dimensions must be positive.");
+    }
+    _blocks.push_back({_size, rows, cols});
+    _size += rows*cols;
+}
+
+int ParamLayout::getNMatrixElements() const
+{
+    int nmat = 0;
+    for (const auto &block : _blocks) { nmat += block.isMatrix() ? block.size() : 0; }
+    return nmat;
+}
+} // namespace nfm
@@ -0,0 +1,155 @@
+#include "nfm/Powell.hpp"
+
+#include "nfm/LogManager.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <numeric>
+#include <thread>
+
+namespace nfm
+{
+
+// --- Constructor
+
+Powell::Powell(const int ndim, const double stepSize, const int nlineThreads):
+        NFM(ndim, false), _mlmParams(defaultMLMParams()), _nlineThreads(std::max(1, nlineThreads))
+{
+    _mlmParams.stepRight = stepSize;
+}
+
+// --- Internal methods
+
+NoisyIOPair Powell::_lineMin(const NoisyIOPair &p0, const int idir)
+{
+    const auto n = static_cast<size_t>(_ndim);
+    std::vector<double> dir(_dirs.begin() + idir*n, _dirs.begin() + (idir + 1)*n);
+    NoisyIOPair p1 = multiLineMin(*_targetfun, p0, dir, _mlmParams);
+
+    if (p1.x == p0.x) { // no success, so try the opposite direction
+        for (double &d : dir) { d = -d; }
+        NoisyIOPair p2 = multiLineMin(*_targetfun, p1, dir, _mlmParams);
+        if (p2.x != p1.x) { // keep the flipped direction
+            std::copy(dir.begin(), dir.end(), _dirs.begin() + idir*n);
+        }
+        return p2;
+    }
+    return p1;
+}
+
+void Powell::_replaceDirection(const int ibig, const std::vector<double> &dnew)
+{   // direction ibig is dropped, the new one is appended at the end
+    const auto n = static_cast<size_t>(_ndim);
+    const double dnorm = sqrt(std::inner_product(dnew.begin(), dnew.end(), dnew.begin(), 0.));
+    std::copy(_dirs.begin() + (ibig + 1)*n, _dirs.end(), _dirs.begin() + ibig*n);
+    std::transform(dnew.begin(), dnew.end(), _dirs.end() - n, [dnorm](const double d) { return d/dnorm; });
+}
+
+void Powell::_sweepSerial()
+{
+    const NoisyIOPair pstart = _last;
+    double bigDelta = 0.; // largest decrease
+    int ibig = 0; // direction of largest decrease
+
+    for (int i = 0; i < _ndim; ++i) {
+        const NoisyValue fprev = _last.f;
+        _last = this->_lineMin(_last, i);
+        if (fprev.val - _last.f.val > bigDelta) {
+            bigDelta = fprev.val - _last.f.val;
+            ibig = i;
+        }
+    }
+
+    // Powell's rule for replacing a direction
+    std::vector<double> dnew(_last.x.size());
+    NoisyIOPair pext(_ndim); // extrapolated point
+    for (int i = 0; i < _ndim; ++i) {
+        dnew[i] = _last.x[i] - pstart.x[i];
+        pext.x[i] = _last.x[i] + dnew[i];
+    }
+    if (std::all_of(dnew.begin(), dnew.end(), [](const double d) { return d == 0.; })) { return; }
+    pext.f = _targetfun->f(pext.x);
+
+    const double fp = pstart.f.val, fn = _last.f.val, fe = pext.f.val;
+    if (pext.f < pstart.f) {
+        const double t = 2.*(fp - 2.*fn + fe)*pow(fp - fn - bigDelta, 2) - bigDelta*pow(fp - fe, 2);
+        if (t < 0.) {
+            this->_replaceDirection(ibig, dnew);
+            _last = this->_lineMin(_last, _ndim - 1);
+        }
+    }
+}
+
+void Powell::_sweepParallel()
+{
+    const NoisyIOPair pstart = _last;
+    std::vector<NoisyIOPair> results(static_cast<size_t>(_ndim));
+
+    // concurrent line searches from the same starting point
+    const int nthreads = std::min(_nlineThreads, _ndim);
+    std::vector<std::thread> threads;
+    std::vector<std::exception_ptr> errors(static_cast<size_t>(nthreads));
+    for (int it = 0; it < nthreads; ++it) {
+        threads.emplace_back([this, it, nthreads, &pstart, &results, &errors]() {
+            try {
+                for (int i = it; i < _ndim; i += nthreads) { results[i] = this->_lineMin(pstart, i); }
+            }
+            catch (...) {
+                errors[it] = std::current_exception();
+            }
+        });
+    }
+    for (auto &th : threads) { th.join(); }
+    for (const auto &err : errors) {
+        if (err) { std::rethrow_exception(err); }
+    }
+
+    // best single line search and sum of all displacements
+    int ibig = 0;
+    std::vector<double> dnew(_last.x.size(), 0.);
+    for (int i = 0; i < _ndim; ++i) {
+        if (results[i].f.val < results[ibig].f.val) { ibig = i; }
+        for (int j = 0; j < _ndim; ++j) { dnew[j] += results[i].x[j] - pstart.x[j]; }
+    }
+    _last = results[ibig];
+    if (std::all_of(dnew.begin(), dnew.end(), [](const double d) { return d == 0.; })) { return; }
+
+    // the combined direction replaces the one of largest decrease
+    this->_replaceDirection(ibig, dnew);
+    const NoisyIOPair pcomb = this->_lineMin(pstart, _ndim - 1);
+    if (pcomb.f < _last.f) { _last = pcomb; }
+}
+
+// --- Minimization
+
+void Powell::_findMin()
+{
+    LogManager::logString("\nBegin Powell::findMin() procedure\n");
+
+    // set line search tolerances and initial directions
+    _mlmParams.epsx = this->getEpsX();
+    _mlmParams.epsf = this->getEpsF();
+    _dirs.assign(static_cast<size_t>(_ndim*_ndim), 0.);
+    for (int i = 0; i < _ndim; ++i) { _dirs[i*_ndim + i] = 1.; }
+
+    _last.f = _targetfun->f(_last.x);
+
+    //begin the minimization loop
+    int iter = 0;
+    while (true) {
+        ++iter;
+        if (LogManager::isLoggingOn()) { // else skip string construction
+            LogManager::logString("\nPowell::findMin() Sweep " + std::to_string(iter) + "\n");
+        }
+
+        this->_storeLastValue();
+        if (this->_shouldStop()) { break; }
+
+        if (_nlineThreads > 1) { this->_sweepParallel(); }
+        else { this->_sweepSerial(); }
+    }
+
+    LogManager::logString("\nEnd Powell::findMin() procedure\n");
+}
+} // namespace nfm
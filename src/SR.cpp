@@ -0,0 +1,111 @@
+#include "nfm/SR.hpp"
+
+#include "nfm/LogManager.hpp"
+
+#include <cmath>
+#include <numeric>
+
+namespace nfm
+{
+
+// --- Constructor
+
+SR::SR(const int ndim, const bool useAveraging, const double stepSize):
+        NFM(ndim, true), _useAveraging(useAveraging), _stepSize(std::max(0., stepSize)) {}
+
+// --- Minimization
+
+void SR::_findMin()
+{
+    LogManager::logString("\nBegin SR::findMin() procedure\n");
+
+    const TargetFunGuard<NoisyFunctionWithOverlap> funGuard(_sfun, dynamic_cast<NoisyFunctionWithOverlap *>(_targetfun));
+    if (_sfun == nullptr) {
+        throw std::invalid_argument("[SR] The target function must be a NoisyFunctionWithOverlap.");
+    }
+
+    std::vector<double> delta(_grad.size()); // natural gradient (also used as CG starting guess)
+    double shift = _diagShift; // current diagonal shift
+
+    //begin the minimization loop
+    int iter = 0;
+    while (true) {
+        ++iter;
+        if (LogManager::isLoggingOn()) { // else skip string construction
+            LogManager::logString("\nSR::findMin() Step " + std::to_string(iter) + "\n");
+        }
+
+        // compute current gradient and target value (S is sampled alongside)
+        _last.f = _sfun->fgrad(_last.x, _grad);
+        this->_storeLastValue();
+        this->_writeGradientToLog();
+        if (this->_shouldStop()) { break; }
+
+        // solve (S + shift*I) * delta = g
+        const int ncg = this->_solveShiftedSystem(shift, delta);
+        if (LogManager::isLoggingOn()) {
+            LogManager::logString("Inner CG iterations: " + std::to_string(ncg) + "\n", LogLevel::VERBOSE);
+        }
+        LogManager::logVector(delta, LogLevel::VERBOSE, "Natural gradient", "d");
+
+        // update position and shift
+        for (int i = 0; i < _ndim; ++i) {
+            _last.x[i] += _stepSize*delta[i];
+        }
+        shift = std::max(_minDiagShift, shift*_shiftDecay);
+    }
+
+    if (_useAveraging) { // calculate the old value average as end result
+        this->_averageOldValues(); // perform average and store it in last
+    }
+
+    LogManager::logString("\nEnd SR::findMin() procedure\n");
+}
+
+// --- Internal methods
+
+int SR::_solveShiftedSystem(const double shift, std::vector<double> &delta)
+{
+    const std::vector<double> &g = _grad.val;
+    std::vector<double> r(g.size()); // residual
+    std::vector<double> p(g.size()); // search direction
+    std::vector<double> Ap(g.size()); // (S + shift*I) * p
+
+    // initial residual r = g - (S + shift*I) * delta, with delta from last step
+    _sfun->applyOverlap(delta, Ap);
+    for (int i = 0; i < _ndim; ++i) {
+        r[i] = g[i] - Ap[i] - shift*delta[i];
+    }
+    p = r;
+    double rr = std::inner_product(r.begin(), r.end(), r.begin(), 0.);
+
+    // tolerance on the residual norm
+    double tol = _cgTol*sqrt(std::inner_product(g.begin(), g.end(), g.begin(), 0.));
+    if (_flag_cgNoiseStop && this->hasGradErr()) { // no point in solving beyond the gradient noise
+        tol = std::max(tol, sqrt(std::inner_product(_grad.err.begin(), _grad.err.end(), _grad.err.begin(), 0.)));
+    }
+
+    int iter = 0;
+    while (iter < _maxNCG && sqrt(rr) > tol) {
+        ++iter;
+        _sfun->applyOverlap(p, Ap);
+        for (int i = 0; i < _ndim; ++i) { Ap[i] += shift*p[i]; }
+
+        const double pAp = std::inner_product(p.begin(), p.end(), Ap.begin(), 0.);
+        if (pAp <= 0.) { break; } // shifted S is not positive definite (should not happen)
+
+        const double alpha = rr/pAp;
+        for (int i = 0; i < _ndim; ++i) {
+            delta[i] += alpha*p[i];
+            r[i] -= alpha*Ap[i];
+        }
+        const double rr_new = std::inner_product(r.begin(), r.end(), r.begin(), 0.);
+        const double beta = rr_new/rr;
+        for (int i = 0; i < _ndim; ++i) {
+            p[i] = r[i] + beta*p[i];
+        }
+        rr = rr_new;
+    }
+    return iter;
+}
+} // namespace nfm
@@ -0,0 +1,254 @@
+#include "nfm/StateBuffer.hpp"
+
+#include "nfm/Checkpoint.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// float -> bfloat16 with round to nearest even (NaN handling is not needed here)
+inline uint16_t toBF16(const double x)
+{
+    const auto f = static_cast<float>(x);
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    u += 0x7FFFu + ((u >> 16u) & 1u);
+    return static_cast<uint16_t>(u >> 16u);
+}
+
+inline double fromBF16(const uint16_t h)
+{
+    const uint32_t u = static_cast<uint32_t>(h) << 16u;
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+// deterministic pseudo-random number in [0, 1) for the given key (splitmix64 finalizer)
+inline double roundingNoise(uint64_t key)
+{
+    key += 0x9E3779B97F4A7C15ull;
+    key = (key ^ (key >> 30u))*0xBF58476D1CE4E5B9ull;
+    key = (key ^ (key >> 27u))*0x94D049BB133111EBull;
+    key ^= key >> 31u;
+    return static_cast<double>(key >> 11u)*(1./9007199254740992.); // 2^-53
+}
+
+// Stochastic rounding of the relative magnitude a in [0, 1] to a level of the companding map
+// a ~ (q/qmax)^2, such that the decoded value is unbiased
+inline int roundLevel(const double a, const int qmax, const double u)
+{
+    const int l = std::min(qmax, static_cast<int>(qmax*sqrt(a)));
+    if (l == qmax) { return qmax; }
+    const double al = (static_cast<double>(l)/qmax)*(static_cast<double>(l)/qmax);
+    const double au = (l + 1.)/qmax*((l + 1.)/qmax);
+    return (u*(au - al) < a - al) ? l + 1 : l;
+}
+
+namespace nfm
+{
+
+StateBuffer::StateBuffer(const size_t n, const StatePrecision prec, const bool nonNegative, const std::string &mapDir):
+        _mapDir(mapDir), _d(MappedAllocator<double>(mapDir)), _f(MappedAllocator<float>(mapDir)), _h(MappedAllocator<uint16_t>(mapDir)),
+        _q(MappedAllocator<uint8_t>(mapDir)), _scales(MappedAllocator<float>(mapDir)), _rounds(MappedAllocator<uint32_t>(mapDir))
+{
+    this->assign(n, prec, nonNegative);
+}
+
+void StateBuffer::assign(const size_t n, const StatePrecision prec, const bool nonNegative)
+{
+    if (n == _size && prec == _prec && nonNegative == _flag_nonNegative) { // keep the storage
+        std::fill(_d.begin(), _d.end(), 0.);
+        std::fill(_f.begin(), _f.end(), 0.f);
+        std::fill(_h.begin(), _h.end(), 0);
+        std::fill(_q.begin(), _q.end(), _flag_nonNegative ? 0 : 127);
+        std::fill(_scales.begin(), _scales.end(), 0.f);
+        std::fill(_rounds.begin(), _rounds.end(), 0u);
+        return;
+    }
+
+    _size = n;
+    _prec = prec;
+    _flag_nonNegative = nonNegative;
+    // free the old storage
+    _d = decltype(_d)(_d.get_allocator());
+    _f = decltype(_f)(_f.get_allocator());
+    _h = decltype(_h)(_h.get_allocator());
+    _q = decltype(_q)(_q.get_allocator());
+    _scales = decltype(_scales)(_scales.get_allocator());
+    _rounds = decltype(_rounds)(_rounds.get_allocator());
+
+    switch (_prec) {
+    case StatePrecision::Double:
+        _d.assign(n, 0.);
+        break;
+    case StatePrecision::Float:
+        _f.assign(n, 0.f);
+        break;
+    case StatePrecision::BF16:
+        _h.assign(n, 0); // bit pattern of +0
+        break;
+    case StatePrecision::Q8:
+        _q.assign(n, _flag_nonNegative ? 0 : 127); // signed values are stored with offset 127
+        _scales.assign((n + blockSize - 1)/blockSize, 0.f);
+        _rounds.assign((n + blockSize - 1)/blockSize, 0u);
+        break;
+    }
+}
+
+size_t StateBuffer::getNBytes() const
+{
+    return _d.size()*sizeof(double) + _f.size()*sizeof(float) + _h.size()*sizeof(uint16_t)
+           + _q.size()*sizeof(uint8_t) + _scales.size()*sizeof(float) + _rounds.size()*sizeof(uint32_t);
+}
+
+double * StateBuffer::loadBlock(const size_t begin, const size_t len, double * tmp)
+{
+    switch (_prec) {
+    case StatePrecision::Double:
+        return _d.data() + begin;
+    case StatePrecision::Float:
+        std::copy(_f.begin() + begin, _f.begin() + begin + len, tmp);
+        break;
+    case StatePrecision::BF16:
+        for (size_t i = 0; i < len; ++i) { tmp[i] = fromBF16(_h[begin + i]); }
+        break;
+    case StatePrecision::Q8: { // inverse of the companding map, see storeBlock()
+        const double scale = _scales[begin/blockSize];
+        const uint8_t * q = _q.data() + begin;
+        if (_flag_nonNegative) {
+            for (size_t i = 0; i < len; ++i) {
+                const double r = q[i]/255.;
+                tmp[i] = scale*r*r;
+            }
+        }
+        else {
+            for (size_t i = 0; i < len; ++i) {
+                const double r = (q[i] - 127.)/127.;
+                tmp[i] = scale*r*fabs(r);
+            }
+        }
+        break;
+    }
+    }
+    return tmp;
+}
+
+void StateBuffer::storeBlock(const size_t begin, const size_t len, const double * blk)
+{
+    switch (_prec) {
+    case StatePrecision::Double:
+        break; // values were changed in place
+    case StatePrecision::Float:
+        for (size_t i = 0; i < len; ++i) { _f[begin + i] = static_cast<float>(blk[i]); }
+        break;
+    case StatePrecision::BF16:
+        for (size_t i = 0; i < len; ++i) { _h[begin + i] = toBF16(blk[i]); }
+        break;
+    case StatePrecision::Q8: {
+        double absmax = 0.;
+        for (size_t i = 0; i < len; ++i) { absmax = std::max(absmax, fabs(blk[i])); }
+        auto scale = static_cast<float>(absmax);
+        if (scale < absmax) { scale = std::nextafter(scale, HUGE_VALF); } // make sure that |x|/scale <= 1
+        _scales[begin/blockSize] = scale;
+
+        // stochastic rounding, with the noise keyed by element index and encoding count of the block
+        const uint64_t round = ++_rounds[begin/blockSize];
+        uint8_t * q = _q.data() + begin;
+        if (scale == 0.f) {
+            std::fill(q, q + len, _flag_nonNegative ? 0 : 127);
+        }
+        else if (_flag_nonNegative) { // non-zero values stay non-zero (lowest level at least)
+            for (size_t i = 0; i < len; ++i) {
+                const double a = std::min(1., std::max(0., blk[i])/scale);
+                const int qi = roundLevel(a, 255, roundingNoise((round << 32u) ^ (begin + i)));
+                q[i] = static_cast<uint8_t>((qi == 0 && a > 0.) ? 1 : qi);
+            }
+        }
+        else {
+            for (size_t i = 0; i < len; ++i) {
+                const int qi = roundLevel(std::min(1., fabs(blk[i])/scale), 127, roundingNoise((round << 32u) ^ (begin + i)));
+                q[i] = static_cast<uint8_t>((blk[i] < 0.) ? 127 - qi : 127 + qi);
+            }
+        }
+        break;
+    }
+    }
+}
+
+void StateBuffer::get(std::vector<double> &out) const
+{
+    out.resize(_size);
+    auto * self = const_cast<StateBuffer *>(this); // loadBlock doesn't change the data
+    for (size_t b0 = 0; b0 < _size; b0 += blockSize) {
+        const size_t len = (_size - b0 < blockSize) ? _size - b0 : blockSize;
+        const double * blk = self->loadBlock(b0, len, out.data() + b0);
+        if (blk != out.data() + b0) { std::copy(blk, blk + len, out.data() + b0); }
+    }
+}
+
+void StateBuffer::set(const std::vector<double> &in)
+{
+    this->assign(in.size(), _prec, _flag_nonNegative);
+    std::vector<double> tmp(blockSize);
+    for (size_t b0 = 0; b0 < _size; b0 += blockSize) {
+        const size_t len = (_size - b0 < blockSize) ? _size - b0 : blockSize;
+        double * blk = this->loadBlock(b0, len, tmp.data());
+        std::copy(in.begin() + b0, in.begin() + b0 + len, blk);
+        this->storeBlock(b0, len, blk);
+    }
+}
+
+void StateBuffer::scale(const double fac)
+{
+    updateBlockwise<1>({this}, 0, _size, [fac](const size_t, const size_t len, const std::array<double *, 1> &blk)
+    {
+        for (size_t i = 0; i < len; ++i) { blk[0][i] *= fac; }
+    });
+}
+
+void StateBuffer::convert(const StatePrecision prec)
+{
+    if (prec == _prec) { return; }
+    StateBuffer conv(_size, prec, _flag_nonNegative, _mapDir);
+    double tmp[blockSize], ctmp[blockSize];
+    for (size_t b0 = 0; b0 < _size; b0 += blockSize) {
+        const size_t len = (_size - b0 < blockSize) ? _size - b0 : blockSize;
+        const double * blk = this->loadBlock(b0, len, tmp);
+        double * cblk = conv.loadBlock(b0, len, ctmp);
+        std::copy(blk, blk + len, cblk);
+        conv.storeBlock(b0, len, cblk);
+    }
+    *this = std::move(conv);
+}
+
+void StateBuffer::write(StateWriter &out) const
+{
+    out.write(static_cast<uint64_t>(_size));
+    out.write(static_cast<uint8_t>(_prec));
+    out.write(static_cast<uint8_t>(_flag_nonNegative ? 1 : 0));
+    out.writeArray(_d.data(), _d.size());
+    out.writeArray(_f.data(), _f.size());
+    out.writeArray(_h.data(), _h.size());
+    out.writeArray(_q.data(), _q.size());
+    out.writeArray(_scales.data(), _scales.size());
+    out.writeArray(_rounds.data(), _rounds.size());
+}
+
+void StateBuffer::read(StateReader &in)
+{
+    const uint64_t n = in.readLength();
+    const auto prec = in.read<uint8_t>();
+    const auto nonNegative = in.read<uint8_t>();
+    if (prec > static_cast<uint8_t>(StatePrecision::Q8) || nonNegative > 1) {
+        throw std::invalid_argument("[StateBuffer::read] Invalid state buffer in checkpoint data.");
+    }
+    this->assign(n, static_cast<StatePrecision>(prec), nonNegative == 1); // sizes the vectors of the representation
+    in.readArray(_d.data(), _d.size());
+    in.readArray(_f.data(), _f.size());
+    in.readArray(_h.data(), _h.size());
+    in.readArray(_q.data(), _q.size());
+    in.readArray(_scales.data(), _scales.size());
+    in.readArray(_rounds.data(), _rounds.size());
+}
+} // namespace nfm
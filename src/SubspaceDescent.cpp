@@ -0,0 +1,87 @@
+#include "nfm/SubspaceDescent.hpp"
+
+#include "nfm/LogManager.hpp"
+
+#include <cmath>
+#include <numeric>
+#include <random>
+
+namespace nfm
+{
+
+// --- Constructor
+
+SubspaceDescent::SubspaceDescent(const int ndim, const int k, const double stepSize):
+        NFM(ndim, true), _k(std::max(1, std::min(ndim, k))), _stepSize(std::max(0., stepSize))
+{
+    // override defaults
+    this->setGradErrStop(false); // the stored gradient is only the subspace projection
+}
+
+// --- Minimization
+
+void SubspaceDescent::_findMin()
+{
+    LogManager::logString("\nBegin SubspaceDescent::findMin() procedure\n");
+
+    const auto n = static_cast<size_t>(_ndim);
+    std::vector<double> dirs(_k*n); // orthonormal directions (row-major k*ndim)
+    std::vector<NoisyValue> dd(static_cast<size_t>(_k)); // directional derivatives
+    std::mt19937_64 rgen(_seed);
+    std::normal_distribution<double> rdist;
+
+    //begin the minimization loop
+    int iter = 0;
+    while (true) {
+        ++iter;
+        if (LogManager::isLoggingOn()) { // else skip string construction
+            LogManager::logString("\nSubspaceDescent::findMin() Step " + std::to_string(iter) + "\n");
+        }
+
+        // draw random directions and orthonormalize them (modified Gram-Schmidt)
+        for (int j = 0; j < _k; ++j) {
+            double * uj = dirs.data() + j*n;
+            double unorm = 0.;
+            while (unorm < 1.e-8) { // redraw in the (unlikely) case of linear dependence
+                for (size_t i = 0; i < n; ++i) { uj[i] = rdist(rgen); }
+                for (int l = 0; l < j; ++l) {
+                    const double * ul = dirs.data() + l*n;
+                    const double proj = std::inner_product(uj, uj + n, ul, 0.);
+                    for (size_t i = 0; i < n; ++i) { uj[i] -= proj*ul[i]; }
+                }
+                unorm = sqrt(std::inner_product(uj, uj + n, uj, 0.));
+            }
+            for (size_t i = 0; i < n; ++i) { uj[i] /= unorm; }
+        }
+
+        // compute current value and directional derivatives
+        _last.f = _gradfun->fdirDeriv(_last.x, dirs, dd);
+
+        // projected gradient, with errors from independent derivatives
+        _grad.zero();
+        for (int j = 0; j < _k; ++j) {
+            const double * uj = dirs.data() + j*n;
+            for (size_t i = 0; i < n; ++i) {
+                _grad.val[i] += dd[j].val*uj[i];
+                _grad.err[i] += dd[j].err*dd[j].err*uj[i]*uj[i];
+            }
+        }
+        for (double &e : _grad.err) { e = sqrt(e); }
+
+        this->_storeLastValue();
+        this->_writeGradientToLog();
+        if (this->_shouldStop()) { break; }
+
+        // step within the subspace
+        for (size_t i = 0; i < n; ++i) {
+            _last.x[i] += _stepSize*_grad.val[i];
+        }
+    }
+
+    if (_useAveraging) { // calculate the old value average as end result
+        this->_averageOldValues(); // perform average and store it in last
+    }
+
+    LogManager::logString("\nEnd SubspaceDescent::findMin() procedure\n");
+}
+} // namespace nfm
@@ -0,0 +1,72 @@
+#include "nfm/ThreadPool.hpp"
+
+#include <stdexcept>
+
+namespace nfm
+{
+
+ThreadPool::ThreadPool(const int nthreads): _nthreads(nthreads)
+{
+    if (nthreads < 1) {
+        throw std::invalid_argument("[ThreadPool] Number of threads must be at least 1.");
+    }
+    _workers.reserve(static_cast<size_t>(nthreads - 1));
+    for (int i = 1; i < nthreads; ++i) {
+        _workers.emplace_back(&ThreadPool::_workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _flag_quit = true;
+    }
+    _cvStart.notify_all();
+    for (auto &worker : _workers) { worker.join(); }
+}
+
+void ThreadPool::_workerLoop(const int ichunk)
+{
+    unsigned long lastGeneration = 0;
+    while (true) {
+        const std::function<void(int)> * job;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cvStart.wait(lock, [&]() { return _flag_quit || _generation != lastGeneration; });
+            if (_flag_quit) { return; }
+            lastGeneration = _generation;
+            job = _job;
+        }
+
+        (*job)(ichunk);
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            --_nbusy;
+        }
+        _cvDone.notify_one();
+    }
+}
+
+void ThreadPool::run(const std::function<void(int)> &job)
+{
+    if (_workers.empty()) { // nothing to distribute
+        job(0);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _job = &job;
+        _nbusy = static_cast<int>(_workers.size());
+        ++_generation;
+    }
+    _cvStart.notify_all();
+
+    job(0); // the caller takes the first chunk
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cvDone.wait(lock, [&]() { return _nbusy == 0; });
+    _job = nullptr;
+}
+} // namespace nfm
@@ -0,0 +1,129 @@
+#include "nfm/TruncatedNewton.hpp"
+
+#include "nfm/LogManager.hpp"
+
+#include <cmath>
+#include <numeric>
+
+namespace nfm
+{
+
+// --- Constructor
+
+TruncatedNewton::TruncatedNewton(const int ndim, const double stepSize):
+        NFM(ndim, true), _stepSize((stepSize > 0.) ? stepSize : 1.) {}
+
+// --- Minimization
+
+void TruncatedNewton::_findMin()
+{
+    LogManager::logString("\nBegin TruncatedNewton::findMin() procedure\n");
+
+    const TargetFunGuard<NoisyFunctionWithHessVec> funGuard(_hfun, dynamic_cast<NoisyFunctionWithHessVec *>(_targetfun));
+    if (_hfun == nullptr) {
+        throw std::invalid_argument("[TruncatedNewton] The target function must be a NoisyFunctionWithHessVec.");
+    }
+
+    std::vector<double> p(_grad.size()); // Newton step
+
+    //begin the minimization loop
+    int iter = 0;
+    while (true) {
+        ++iter;
+        if (LogManager::isLoggingOn()) { // else skip string construction
+            LogManager::logString("\nTruncatedNewton::findMin() Step " + std::to_string(iter) + "\n");
+        }
+
+        // compute current gradient and target value
+        _last.f = _hfun->fgrad(_last.x, _grad);
+        _hfun->setHessVecRefGrad(_last.x, _grad); // reference for the default Hessian-vector products
+        this->_storeLastValue();
+        this->_writeGradientToLog();
+        if (this->_shouldStop()) { break; }
+
+        // approximately solve H * p = g
+        const int ncg = this->_solveNewton(p);
+        if (LogManager::isLoggingOn()) {
+            LogManager::logString("Inner CG iterations: " + std::to_string(ncg) + "\n", LogLevel::VERBOSE);
+        }
+        LogManager::logVector(p, LogLevel::VERBOSE, "Newton step", "p");
+
+        // move along p
+        if (!this->_backtrackStep(p)) {
+            LogManager::logString("\nStopping Reason: Backtracking failed to find a decrease.\n");
+            break;
+        }
+    }
+
+    LogManager::logString("\nEnd TruncatedNewton::findMin() procedure\n");
+}
+
+// --- Internal methods
+
+int TruncatedNewton::_solveNewton(std::vector<double> &p)
+{
+    const std::vector<double> &g = _grad.val;
+    std::vector<double> r(g); // residual
+    std::vector<double> re2(g.size()); // residual variance
+    std::vector<double> d(g); // search direction
+    NoisyGradient Hd(_ndim); // H * d
+
+    for (int i = 0; i < _ndim; ++i) { re2[i] = _grad.err[i]*_grad.err[i]; }
+    std::fill(p.begin(), p.end(), 0.);
+
+    double rr = std::inner_product(r.begin(), r.end(), r.begin(), 0.);
+    const double gnorm = sqrt(rr);
+    const double tol = std::min(_maxForcing, sqrt(gnorm))*gnorm;
+    const int maxNCG = (_maxNCG > 0) ? _maxNCG : _ndim;
+
+    int iter = 0;
+    while (iter < maxNCG) {
+        _hfun->hessVec(_last.x, d, Hd);
+        NoisyValue dHd{0., 0.}; // curvature along d
+        for (int i = 0; i < _ndim; ++i) {
+            dHd.val += d[i]*Hd.val[i];
+            dHd.err += d[i]*d[i]*Hd.err[i]*Hd.err[i];
+        }
+        dHd.err = sqrt(dHd.err);
+        if (dHd <= 0.) { // curvature not significantly positive
+            if (iter == 0) { p = g; } // fall back to steepest descent
+            break;
+        }
+        ++iter;
+
+        const double alpha = rr/dHd.val;
+        for (int i = 0; i < _ndim; ++i) {
+            p[i] += alpha*d[i];
+            r[i] -= alpha*Hd.val[i];
+            re2[i] += alpha*alpha*Hd.err[i]*Hd.err[i];
+        }
+        const double rr_new = std::inner_product(r.begin(), r.end(), r.begin(), 0.);
+        if (sqrt(rr_new) <= tol) { break; } // converged to forcing tolerance
+        if (sqrt(std::accumulate(re2.begin(), re2.end(), 0.)) > _maxNSR*sqrt(rr_new)) { break; } // residual is mostly noise
+
+        const double beta = rr_new/rr;
+        for (int i = 0; i < _ndim; ++i) {
+            d[i] = r[i] + beta*d[i];
+        }
+        rr = rr_new;
+    }
+    return iter;
+}
+
+bool TruncatedNewton::_backtrackStep(const std::vector<double> &p)
+{
+    const double slope = -std::inner_product(_grad.val.begin(), _grad.val.end(), p.begin(), 0.); // directional derivative
+    std::vector<double> xt(_last.x.size());
+    double t = _stepSize;
+    for (int nb = 0; nb <= _maxNBacktrack; ++nb) {
+        for (int i = 0; i < _ndim; ++i) { xt[i] = _last.x[i] + t*p[i]; }
+        const NoisyValue ft = _hfun->f(xt);
+        if ((ft - _last.f) <= _armijo*t*slope) { // not significantly worse than sufficient decrease
+            _last.x.swap(xt);
+            return true;
+        }
+        t *= _backtrack;
+    }
+    return false;
+}
+} // namespace nfm
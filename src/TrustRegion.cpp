@@ -0,0 +1,227 @@
+#include "nfm/TrustRegion.hpp"
+
+#include "nfm/LogManager.hpp"
+
+#include <cmath>
+#include <numeric>
+
+namespace nfm
+{
+
+// --- Constructor
+
+TrustRegion::TrustRegion(const int ndim, const double radius0, const double maxRadius):
+        NFM(ndim, true), _radius0((radius0 > 0.) ? radius0 : 0.1), _maxRadius(std::max(_radius0, maxRadius)) {}
+
+// --- Internal methods
+
+void TrustRegion::_fitModel(const PushBackBuffer<HistoryPoint> &history)
+{
+    const auto n = static_cast<size_t>(_ndim);
+    std::vector<double> s(n), y(n), Bs(n);
+
+    // helper to compute s = x_k - x and y = G_k - G (we store negative gradients)
+    auto computePair = [&](const HistoryPoint &hp)
+    {
+        for (size_t i = 0; i < n; ++i) {
+            s[i] = hp.p.x[i] - _last.x[i];
+            y[i] = _grad.val[i] - hp.g.val[i];
+        }
+        return std::inner_product(s.begin(), s.end(), s.begin(), 0.); // s.s
+    };
+
+    // 1. fit the curvature scale to values and gradient differences
+    double ksum = 0., wsum = 0.;
+    for (size_t k = 0; k < history.size(); ++k) {
+        const HistoryPoint &hp = history[k];
+        const double ss = computePair(hp);
+        if (ss <= 0.) { continue; } // the current position itself
+
+        double Gs = 0., varGs = 0., sy = 0., varsy = 0.;
+        for (size_t i = 0; i < n; ++i) {
+            Gs -= _grad.val[i]*s[i];
+            varGs += s[i]*s[i]*_grad.err[i]*_grad.err[i];
+            sy += s[i]*y[i];
+            varsy += s[i]*s[i]*(hp.g.err[i]*hp.g.err[i] + _grad.err[i]*_grad.err[i]);
+        }
+        const NoisyValue df = hp.p.f - _last.f; // includes error propagation
+
+        // curvature along s from function values, f_k - f = G.s + 0.5 * kf * s.s
+        const double kf = 2.*(df.val - Gs)/ss;
+        const double varkf = 4.*(df.err*df.err + varGs)/(ss*ss);
+        // curvature along s from gradients, s.y = ky * s.s
+        const double ky = sy/ss;
+        const double varky = varsy/(ss*ss);
+
+        const double wf = 1./(varkf + 1.e-30);
+        const double wy = 1./(varky + 1.e-30);
+        ksum += wf*kf + wy*ky;
+        wsum += wf + wy;
+    }
+    double b0 = (wsum > 0.) ? ksum/wsum : 1.;
+    if (b0 <= 0.) { b0 = 1.; } // no useful positive curvature information
+
+    std::fill(_B.begin(), _B.end(), 0.);
+    for (size_t i = 0; i < n; ++i) { _B[i*n + i] = b0; }
+
+    // 2. damped BFGS updates, mixed in according to their signal-to-noise ratio
+    for (size_t k = 0; k < history.size(); ++k) {
+        const HistoryPoint &hp = history[k];
+        if (computePair(hp) <= 0.) { continue; }
+
+        double sy = 0., varsy = 0.;
+        for (size_t i = 0; i < n; ++i) {
+            sy += s[i]*y[i];
+            varsy += s[i]*s[i]*(hp.g.err[i]*hp.g.err[i] + _grad.err[i]*_grad.err[i]);
+        }
+        const double snr = fabs(sy)/(fabs(sy) + sqrt(varsy)); // mixing weight el [0,1]
+        if (!(snr > 0.)) { continue; } // also catches 0/0
+
+        for (size_t i = 0; i < n; ++i) {
+            Bs[i] = std::inner_product(_B.begin() + i*n, _B.begin() + (i + 1)*n, s.begin(), 0.);
+        }
+        const double sBs = std::inner_product(s.begin(), s.end(), Bs.begin(), 0.);
+        if (sy < 0.2*sBs) { // Powell damping keeps B positive definite
+            const double theta = 0.8*sBs/(sBs - sy);
+            for (size_t i = 0; i < n; ++i) { y[i] = theta*y[i] + (1. - theta)*Bs[i]; }
+            sy = std::inner_product(s.begin(), s.end(), y.begin(), 0.);
+        }
+
+        // B <- B + snr * (y y^T / sy - Bs Bs^T / sBs)
+        const double fy = snr/sy;
+        const double fB = snr/sBs;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                _B[i*n + j] += fy*y[i]*y[j] - fB*Bs[i]*Bs[j];
+            }
+        }
+    }
+}
+
+double TrustRegion::_solveSubproblem(const double radius, std::vector<double> &s) const
+{   // Steihaug-Toint truncated CG for min G.s + 0.5 s^T B s, |s| <= radius
+    const auto n = static_cast<size_t>(_ndim);
+    std::vector<double> r = _grad.val; // residual -(G + B s), with s = 0
+    std::vector<double> p = r;
+    std::vector<double> Bp(n);
+    std::fill(s.begin(), s.end(), 0.);
+
+    double rr = std::inner_product(r.begin(), r.end(), r.begin(), 0.);
+    const double tol = 1.e-10*rr;
+
+    // move from s along p onto the boundary
+    auto toBoundary = [&]()
+    {
+        const double a = std::inner_product(p.begin(), p.end(), p.begin(), 0.);
+        const double b = 2.*std::inner_product(s.begin(), s.end(), p.begin(), 0.);
+        const double c = std::inner_product(s.begin(), s.end(), s.begin(), 0.) - radius*radius;
+        const double tau = (-b + sqrt(std::max(0., b*b - 4.*a*c)))/(2.*a);
+        for (size_t i = 0; i < n; ++i) { s[i] += tau*p[i]; }
+    };
+
+    for (size_t it = 0; it < n && rr > tol; ++it) {
+        for (size_t i = 0; i < n; ++i) {
+            Bp[i] = std::inner_product(_B.begin() + i*n, _B.begin() + (i + 1)*n, p.begin(), 0.);
+        }
+        const double pBp = std::inner_product(p.begin(), p.end(), Bp.begin(), 0.);
+        if (pBp <= 0.) { // negative curvature
+            toBoundary();
+            break;
+        }
+        const double alpha = rr/pBp;
+        double snorm2 = 0.;
+        for (size_t i = 0; i < n; ++i) { snorm2 += (s[i] + alpha*p[i])*(s[i] + alpha*p[i]); }
+        if (snorm2 >= radius*radius) {
+            toBoundary();
+            break;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            s[i] += alpha*p[i];
+            r[i] -= alpha*Bp[i];
+        }
+        const double rr_new = std::inner_product(r.begin(), r.end(), r.begin(), 0.);
+        const double beta = rr_new/rr;
+        for (size_t i = 0; i < n; ++i) { p[i] = r[i] + beta*p[i]; }
+        rr = rr_new;
+    }
+
+    // predicted reduction -(G.s + 0.5 s^T B s)
+    double pred = 0.;
+    for (size_t i = 0; i < n; ++i) {
+        const double Bsi = std::inner_product(_B.begin() + i*n, _B.begin() + (i + 1)*n, s.begin(), 0.);
+        pred += s[i]*(_grad.val[i] - 0.5*Bsi);
+    }
+    return pred;
+}
+
+// --- Minimization
+
+void TrustRegion::_findMin()
+{
+    LogManager::logString("\nBegin TrustRegion::findMin() procedure\n");
+
+    const auto n = static_cast<size_t>(_ndim);
+    _B.assign(n*n, 0.);
+    PushBackBuffer<HistoryPoint> history(static_cast<size_t>(_maxNHistory));
+    std::vector<double> s(n);
+    HistoryPoint trial{_last, _grad};
+
+    // initial position
+    _last.f = _gradfun->fgrad(_last.x, _grad);
+    history.push_back({_last, _grad});
+    this->_storeLastValue();
+    this->_writeGradientToLog();
+
+    double radius = _radius0;
+    int iter = 0;
+    while (!this->_shouldStop()) {
+        ++iter;
+        if (LogManager::isLoggingOn()) { // else skip string construction
+            LogManager::logString("\nTrustRegion::findMin() Step " + std::to_string(iter) + "\n");
+        }
+
+        // build and minimize the model
+        this->_fitModel(history);
+        const double pred = this->_solveSubproblem(radius, s);
+        if (!(pred > 0.)) {
+            LogManager::logString("\nStopping Reason: Model predicts no further decrease.\n");
+            break;
+        }
+
+        // evaluate trial point
+        for (size_t i = 0; i < n; ++i) { trial.p.x[i] = _last.x[i] + s[i]; }
+        trial.p.f = _gradfun->fgrad(trial.p.x, trial.g);
+        history.push_back(trial);
+
+        // noisy ratio test
+        const NoisyValue rho = (_last.f - trial.p.f)/pred;
+        if (LogManager::isLoggingOn()) {
+            LogManager::logString("Trust radius: " + std::to_string(radius) + "\n", LogLevel::VERBOSE);
+            LogManager::logNoisyValue(rho, LogLevel::VERBOSE, "Reduction ratio", "rho");
+        }
+        if (rho < _eta1) { // significantly worse than predicted
+            radius *= _fShrink;
+        }
+        else if (rho.val >= _eta1) { // accept
+            const double snorm = sqrt(std::inner_product(s.begin(), s.end(), s.begin(), 0.));
+            _last = trial.p;
+            _grad = trial.g;
+            this->_storeLastValue();
+            this->_writeGradientToLog();
+            if (rho > _eta2 && snorm > 0.9*radius) {
+                radius = std::min(_maxRadius, radius*_fGrow);
+            }
+        }
+        else { // not acceptable, but only within noise
+            radius *= sqrt(_fShrink);
+        }
+
+        if (radius < _minRadius) {
+            LogManager::logString("\nStopping Reason: Trust radius below minimum.\n");
+            break;
+        }
+    }
+
+    LogManager::logString("\nEnd TrustRegion::findMin() procedure\n");
+}
+} // namespace nfm
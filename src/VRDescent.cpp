@@ -0,0 +1,170 @@
+#include "nfm/VRDescent.hpp"
+
+#include "nfm/LogManager.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+// draw bsize distinct term indices into the front of perm (partial Fisher-Yates shuffle)
+inline void sampleBatch(std::vector<int> &perm, const int bsize, std::mt19937_64 &rgen, std::vector<int> &batch)
+{
+    const int nterms = static_cast<int>(perm.size());
+    for (int k = 0; k < bsize; ++k) {
+        std::uniform_int_distribution<int> rdist(k, nterms - 1);
+        std::swap(perm[k], perm[rdist(rgen)]);
+        batch[k] = perm[k];
+    }
+}
+
+namespace nfm
+{
+
+// --- Constructor
+
+VRDescent::VRDescent(const int ndim, const VRMode vrmode, const double stepSize):
+        NFM(ndim, true), _vrmode(vrmode), _stepSize(std::max(0., stepSize)) {}
+
+// --- Internal methods
+
+void VRDescent::_updateTarget(const bool flag_fullGrad)
+{
+    if (flag_fullGrad) {
+        _last.f = _sumfun->fgrad(_last.x, _grad);
+    }
+    else { // gradient estimate was set by caller
+        _last.f = _sumfun->f(_last.x);
+    }
+    this->_storeLastValue();
+    this->_writeGradientToLog();
+}
+
+void VRDescent::_findMinSVRG(std::vector<int> &perm, const int nsteps, const int bsize)
+{
+    std::mt19937_64 rgen(_seed);
+    std::vector<int> batch(static_cast<size_t>(bsize));
+    std::vector<double> xsnap(_last.x.size()); // snapshot position
+    std::vector<double> gx(xsnap.size()), gsnap(xsnap.size()); // minibatch gradients at x and snapshot
+
+    int iter = 0;
+    while (true) {
+        ++iter;
+        if (LogManager::isLoggingOn()) { // else skip string construction
+            LogManager::logString("\nVRDescent::findMin() Epoch " + std::to_string(iter) + "\n");
+        }
+
+        // full gradient at the new snapshot
+        this->_updateTarget(true);
+        if (this->_shouldStop()) { break; } // we are done
+        xsnap = _last.x;
+
+        // inner steps with variance-reduced minibatch gradients
+        for (int s = 0; s < nsteps; ++s) {
+            sampleBatch(perm, bsize, rgen, batch);
+            _sumfun->gradBatch(_last.x, batch, gx);
+            _sumfun->gradBatch(xsnap, batch, gsnap);
+            for (int i = 0; i < _ndim; ++i) {
+                _last.x[i] += _stepSize*(gx[i] - gsnap[i] + _grad.val[i]);
+            }
+        }
+    }
+}
+
+void VRDescent::_findMinSAGA(std::vector<int> &perm, const int nsteps, const int bsize)
+{
+    std::mt19937_64 rgen(_seed);
+    std::vector<int> batch(static_cast<size_t>(bsize));
+    const auto n = static_cast<size_t>(_ndim);
+    const auto nterms = static_cast<size_t>(_sumfun->getNTerms());
+
+    // gradient table, one contiguous row of ndim values per term
+    std::vector<double> table(nterms*n);
+    std::vector<double> gnew(n); // new term gradient
+    std::vector<double> dsum(n); // sum of gradient changes within the minibatch
+    const bool flag_err = _sumfun->hasGradErr();
+    std::vector<double> g2mean(flag_err ? n : 0); // mean of the squared table entries (for the gradient errors)
+
+    // initialize table and its mean at the starting position
+    _grad.zero();
+    for (size_t t = 0; t < nterms; ++t) {
+        double * row = table.data() + t*n;
+        _sumfun->gradTerm(_last.x, static_cast<int>(t), gnew);
+        std::copy(gnew.begin(), gnew.end(), row);
+        for (size_t i = 0; i < n; ++i) { _grad.val[i] += row[i]; }
+        if (flag_err) {
+            for (size_t i = 0; i < n; ++i) { g2mean[i] += row[i]*row[i]; }
+        }
+    }
+    for (double &g : _grad.val) { g /= nterms; }
+    for (double &g2 : g2mean) { g2 /= nterms; }
+
+    int iter = 0;
+    while (true) {
+        ++iter;
+        if (LogManager::isLoggingOn()) { // else skip string construction
+            LogManager::logString("\nVRDescent::findMin() Epoch " + std::to_string(iter) + "\n");
+        }
+
+        // full value, table mean as gradient estimate (errors from the spread of the table)
+        if (flag_err) {
+            for (size_t i = 0; i < n; ++i) {
+                _grad.err[i] = NoisySumFunction::meanErr(_grad.val[i], g2mean[i], static_cast<int>(nterms));
+            }
+        }
+        this->_updateTarget(false);
+        if (this->_shouldStop()) { break; } // we are done
+
+        // inner steps with variance-reduced minibatch gradients
+        for (int s = 0; s < nsteps; ++s) {
+            sampleBatch(perm, bsize, rgen, batch);
+            std::fill(dsum.begin(), dsum.end(), 0.);
+            for (const int t : batch) {
+                double * row = table.data() + t*n;
+                _sumfun->gradTerm(_last.x, t, gnew);
+                if (flag_err) {
+                    for (size_t i = 0; i < n; ++i) { g2mean[i] += (gnew[i]*gnew[i] - row[i]*row[i])/nterms; }
+                }
+                for (size_t i = 0; i < n; ++i) {
+                    dsum[i] += gnew[i] - row[i];
+                    row[i] = gnew[i];
+                }
+            }
+            for (size_t i = 0; i < n; ++i) {
+                _last.x[i] += _stepSize*(dsum[i]/bsize + _grad.val[i]); // step with the old mean
+                _grad.val[i] += dsum[i]/nterms; // keep mean up to date
+            }
+        }
+    }
+}
+
+// --- Minimization
+
+void VRDescent::_findMin()
+{
+    LogManager::logString("\nBegin VRDescent::findMin() procedure\n");
+
+    const TargetFunGuard<NoisySumFunction> funGuard(_sumfun, dynamic_cast<NoisySumFunction *>(_targetfun));
+    if (_sumfun == nullptr) {
+        throw std::invalid_argument("[VRDescent] The target function must be a NoisySumFunction.");
+    }
+
+    const int nterms = _sumfun->getNTerms();
+    const int bsize = std::min(_batchSize, nterms);
+    const int nsteps = (_epochLength > 0) ? _epochLength : std::max(1, nterms/bsize);
+    std::vector<int> perm(static_cast<size_t>(nterms)); // term index permutation for sampling
+    std::iota(perm.begin(), perm.end(), 0);
+
+    if (_vrmode == VRMode::SVRG) {
+        this->_findMinSVRG(perm, nsteps, bsize);
+    }
+    else {
+        this->_findMinSAGA(perm, nsteps, bsize);
+    }
+
+    if (_useAveraging) { // calculate the old value average as end result
+        this->_averageOldValues(); // perform average and store it in last
+    }
+
+    LogManager::logString("\nEnd VRDescent::findMin() procedure\n");
+}
+} // namespace nfm
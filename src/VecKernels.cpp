@@ -0,0 +1,163 @@
+#include "nfm/VecKernels.hpp"
+
+#include "VecKernelsTable.hpp"
+
+#include <atomic>
+
+namespace nfm
+{
+namespace vk
+{
+
+// --- Level selection
+
+SIMDLevel getMaxSIMDLevel()
+{
+#if defined(NFM_VK_AVX2) || defined(NFM_VK_AVX512)
+    static const SIMDLevel maxLevel = []()
+    {
+        __builtin_cpu_init();
+#ifdef NFM_VK_AVX512
+        if (__builtin_cpu_supports("avx512f")) { return SIMDLevel::AVX512; }
+#endif
+#ifdef NFM_VK_AVX2
+        if (__builtin_cpu_supports("avx2")) { return SIMDLevel::AVX2; }
+#endif
+        return SIMDLevel::SSE2;
+    }();
+    return maxLevel;
+#else
+    return SIMDLevel::SSE2;
+#endif
+}
+
+namespace
+{
+const KernelTable * tableOf(const SIMDLevel level)
+{
+    switch (level) {
+#ifdef NFM_VK_AVX512
+    case SIMDLevel::AVX512:
+        return &avx512::table;
+#endif
+#ifdef NFM_VK_AVX2
+    case SIMDLevel::AVX2:
+        return &avx2::table;
+#endif
+    default:
+        break;
+    }
+    return &sse2::table;
+}
+
+struct ActiveTable
+{
+    std::atomic<SIMDLevel> level;
+    std::atomic<const KernelTable *> table;
+
+    ActiveTable(): level(getMaxSIMDLevel()), table(tableOf(level)) {}
+};
+
+ActiveTable &active()
+{
+    static ActiveTable activeTable; // selected on first use
+    return activeTable;
+}
+
+inline const KernelTable &kt() { return *active().table.load(std::memory_order_relaxed); }
+} // namespace
+
+SIMDLevel getSIMDLevel() { return active().level; }
+
+void setSIMDLevel(const SIMDLevel level)
+{
+    const SIMDLevel newLevel = (static_cast<int>(level) < static_cast<int>(getMaxSIMDLevel())) ? level : getMaxSIMDLevel();
+    active().level = newLevel;
+    active().table = tableOf(newLevel);
+}
+
+const char * getSIMDLevelName(const SIMDLevel level)
+{
+    switch (level) {
+    case SIMDLevel::AVX512:
+        return "AVX512";
+    case SIMDLevel::AVX2:
+        return "AVX2";
+    case SIMDLevel::SSE2:
+        break;
+    }
+    return "SSE2";
+}
+
+// --- Kernel dispatch
+
+double dot(const double * a, const double * b, const size_t n) { return kt().dot(a, b, n); }
+
+double sumSqProd(const double * a, const double * b, const size_t n) { return kt().sumSqProd(a, b, n); }
+
+void axpy(double * y, const double * x, const double alpha, const size_t n) { kt().axpy(y, x, alpha, n); }
+
+void square(double * y, const double * x, const double alpha, const size_t n) { kt().square(y, x, alpha, n); }
+
+void ema(double * y, const double * x, const double beta, const size_t n) { kt().ema(y, x, beta, n); }
+
+void adamStep(double * x, double * m, double * v, const double * g, const size_t n,
+              const double beta1, const double beta2, const double afac, const double eps, const bool amsgrad)
+{
+    kt().adamStep(x, m, v, g, n, beta1, beta2, afac, eps, amsgrad);
+}
+
+void adamStepFactored(double * x, double * m, const double * c, const double * g, const size_t n,
+                      const double beta1, const double rowfac, const double afac, const double eps)
+{
+    kt().adamStepFactored(x, m, c, g, n, beta1, rowfac, afac, eps);
+}
+
+void sgdmStep(double * x, double * v, const double * g, const size_t n, const double beta, const double stepSize)
+{
+    kt().sgdmStep(x, v, g, n, beta, stepSize);
+}
+
+void adagStep(double * x, double * v, const double * g, const size_t n, const double stepSize, const double eps)
+{
+    kt().adagStep(x, v, g, n, stepSize, eps);
+}
+
+void adadStep(double * x, double * v, double * w, const double * g, const size_t n, const double beta, const double eps)
+{
+    kt().adadStep(x, v, w, g, n, beta, eps);
+}
+
+void rmspStep(double * x, double * v, const double * g, const size_t n, const double beta, const double stepSize, const double eps)
+{
+    kt().rmspStep(x, v, g, n, beta, stepSize, eps);
+}
+
+void nestStep(double * x, double * v, const double * g, const size_t n, const double beta, const double stepSize)
+{
+    kt().nestStep(x, v, g, n, beta, stepSize);
+}
+
+void lionStep(double * x, double * m, const double * g, const double * gerr, const size_t n,
+              const double beta1, const double beta2, const double stepSize, const double errfac)
+{
+    kt().lionStep(x, m, g, gerr, n, beta1, beta2, stepSize, errfac);
+}
+
+void fireMix(double * v, const double * a, const size_t n, const double alpha, const double c, const double d)
+{
+    kt().fireMix(v, a, n, alpha, c, d);
+}
+
+void fireFreeze(double * x, double * v, const double * a, const size_t n, const bool fullFreeze, const double backstep)
+{
+    kt().fireFreeze(x, v, a, n, fullFreeze, backstep);
+}
+
+void ireneFreeze(double * x, double * v, const double * a, const double * aerr, const size_t n,
+                 const bool fullFreeze, const double backstep, const double sigmaLevel)
+{
+    kt().ireneFreeze(x, v, a, aerr, n, fullFreeze, backstep, sigmaLevel);
+}
+} // namespace vk
+} // namespace nfm
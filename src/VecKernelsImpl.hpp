@@ -0,0 +1,228 @@
+// Kernel implementations, included by the VecKernels_<level>.cpp files.
+// Every file defines NFM_VK_LEVEL (namespace name) before the include and is
+// compiled with the respective instruction set flags (see src/CMakeLists.txt).
+//
+// NOTE: Don't call any inline library functions (like std::max) here, because
+//       their instantiations could be merged by the linker across levels.
+
+#include "VecKernelsTable.hpp"
+
+#include <cmath>
+
+#ifndef NFM_VK_LEVEL
+#error "NFM_VK_LEVEL must be defined before including VecKernelsImpl.hpp"
+#endif
+
+#define NFM_VK_RESTRICT __restrict__
+
+namespace nfm
+{
+namespace vk
+{
+namespace NFM_VK_LEVEL
+{
+
+// sum of partial sums in fixed (pairwise) order
+static double reduceAcc(const double * acc)
+{
+    double tmp[NFM_VK_NACC];
+    for (size_t k = 0; k < NFM_VK_NACC; ++k) { tmp[k] = acc[k]; }
+    for (size_t w = NFM_VK_NACC/2; w > 0; w /= 2) {
+        for (size_t k = 0; k < w; ++k) { tmp[k] += tmp[k + w]; }
+    }
+    return tmp[0];
+}
+
+// reductions use NFM_VK_NACC independent partial sums (same for all levels)
+static double dot(const double * NFM_VK_RESTRICT a, const double * NFM_VK_RESTRICT b, const size_t n)
+{
+    double acc[NFM_VK_NACC] = {};
+    const size_t nb = n - n%NFM_VK_NACC;
+    for (size_t i = 0; i < nb; i += NFM_VK_NACC) {
+        for (size_t k = 0; k < NFM_VK_NACC; ++k) { acc[k] += a[i + k]*b[i + k]; }
+    }
+    for (size_t i = nb; i < n; ++i) { acc[i - nb] += a[i]*b[i]; }
+    return reduceAcc(acc);
+}
+
+static double sumSqProd(const double * NFM_VK_RESTRICT a, const double * NFM_VK_RESTRICT b, const size_t n)
+{
+    double acc[NFM_VK_NACC] = {};
+    const size_t nb = n - n%NFM_VK_NACC;
+    for (size_t i = 0; i < nb; i += NFM_VK_NACC) {
+        for (size_t k = 0; k < NFM_VK_NACC; ++k) {
+            const double p = a[i + k]*b[i + k];
+            acc[k] += p*p;
+        }
+    }
+    for (size_t i = nb; i < n; ++i) {
+        const double p = a[i]*b[i];
+        acc[i - nb] += p*p;
+    }
+    return reduceAcc(acc);
+}
+
+static void axpy(double * NFM_VK_RESTRICT y, const double * NFM_VK_RESTRICT x, const double alpha, const size_t n)
+{
+    for (size_t i = 0; i < n; ++i) { y[i] += alpha*x[i]; }
+}
+
+static void square(double * NFM_VK_RESTRICT y, const double * NFM_VK_RESTRICT x, const double alpha, const size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        const double ax = alpha*x[i];
+        y[i] = ax*ax;
+    }
+}
+
+static void ema(double * NFM_VK_RESTRICT y, const double * NFM_VK_RESTRICT x, const double beta, const size_t n)
+{
+    for (size_t i = 0; i < n; ++i) { y[i] = beta*y[i] + (1. - beta)*x[i]; }
+}
+
+static void adamStep(double * NFM_VK_RESTRICT x, double * NFM_VK_RESTRICT m, double * NFM_VK_RESTRICT v,
+                     const double * NFM_VK_RESTRICT g, const size_t n,
+                     const double beta1, const double beta2, const double afac, const double eps, const bool amsgrad)
+{
+    if (amsgrad) {
+        for (size_t i = 0; i < n; ++i) {
+            m[i] = beta1*m[i] + (1. - beta1)*g[i];
+            const double vi_new = beta2*v[i] + (1. - beta2)*g[i]*g[i];
+            v[i] = (v[i] < vi_new) ? vi_new : v[i];
+            x[i] += afac*m[i]/(sqrt(v[i]) + eps);
+        }
+    }
+    else {
+        for (size_t i = 0; i < n; ++i) {
+            m[i] = beta1*m[i] + (1. - beta1)*g[i];
+            v[i] = beta2*v[i] + (1. - beta2)*g[i]*g[i];
+            x[i] += afac*m[i]/(sqrt(v[i]) + eps);
+        }
+    }
+}
+
+static void adamStepFactored(double * NFM_VK_RESTRICT x, double * NFM_VK_RESTRICT m, const double * NFM_VK_RESTRICT c,
+                             const double * NFM_VK_RESTRICT g, const size_t n,
+                             const double beta1, const double rowfac, const double afac, const double eps)
+{
+    for (size_t i = 0; i < n; ++i) {
+        m[i] = beta1*m[i] + (1. - beta1)*g[i];
+        x[i] += afac*m[i]/(sqrt(rowfac*c[i]) + eps);
+    }
+}
+
+static void sgdmStep(double * NFM_VK_RESTRICT x, double * NFM_VK_RESTRICT v, const double * NFM_VK_RESTRICT g,
+                     const size_t n, const double beta, const double stepSize)
+{
+    for (size_t i = 0; i < n; ++i) {
+        v[i] = beta*v[i] + stepSize*g[i];
+        x[i] += v[i];
+    }
+}
+
+static void adagStep(double * NFM_VK_RESTRICT x, double * NFM_VK_RESTRICT v, const double * NFM_VK_RESTRICT g,
+                     const size_t n, const double stepSize, const double eps)
+{
+    for (size_t i = 0; i < n; ++i) {
+        v[i] += g[i]*g[i];
+        x[i] += stepSize/(sqrt(v[i]) + eps)*g[i];
+    }
+}
+
+static void adadStep(double * NFM_VK_RESTRICT x, double * NFM_VK_RESTRICT v, double * NFM_VK_RESTRICT w,
+                     const double * NFM_VK_RESTRICT g, const size_t n, const double beta, const double eps)
+{
+    for (size_t i = 0; i < n; ++i) {
+        v[i] = beta*v[i] + (1. - beta)*(g[i]*g[i]);
+        const double dx = g[i]*(sqrt(w[i]) + eps)/(sqrt(v[i]) + eps);
+        x[i] += dx;
+        w[i] = beta*w[i] + (1. - beta)*(dx*dx);
+    }
+}
+
+static void rmspStep(double * NFM_VK_RESTRICT x, double * NFM_VK_RESTRICT v, const double * NFM_VK_RESTRICT g,
+                     const size_t n, const double beta, const double stepSize, const double eps)
+{
+    for (size_t i = 0; i < n; ++i) {
+        v[i] = beta*v[i] + (1. - beta)*(g[i]*g[i]);
+        x[i] += stepSize*g[i]/(sqrt(v[i]) + eps);
+    }
+}
+
+static void nestStep(double * NFM_VK_RESTRICT x, double * NFM_VK_RESTRICT v, const double * NFM_VK_RESTRICT g,
+                     const size_t n, const double beta, const double stepSize)
+{
+    for (size_t i = 0; i < n; ++i) {
+        x[i] += beta*beta*v[i] + (1. + beta)*stepSize*g[i];
+        v[i] = beta*v[i] + stepSize*g[i];
+    }
+}
+
+static void lionStep(double * NFM_VK_RESTRICT x, double * NFM_VK_RESTRICT m, const double * NFM_VK_RESTRICT g,
+                     const double * NFM_VK_RESTRICT gerr, const size_t n,
+                     const double beta1, const double beta2, const double stepSize, const double errfac)
+{
+    if (gerr == nullptr) {
+        for (size_t i = 0; i < n; ++i) {
+            const double c = beta1*m[i] + (1. - beta1)*g[i];
+            x[i] += (c > 0.) ? stepSize : ((c < 0.) ? -stepSize : 0.);
+            m[i] = beta2*m[i] + (1. - beta2)*g[i];
+        }
+    }
+    else {
+        for (size_t i = 0; i < n; ++i) { // only move where the sign of c is resolved (noisy comparison)
+            const double c = beta1*m[i] + (1. - beta1)*g[i];
+            const double cerr = errfac*gerr[i];
+            x[i] += (c - cerr > 0.) ? stepSize : ((c + cerr < 0.) ? -stepSize : 0.);
+            m[i] = beta2*m[i] + (1. - beta2)*g[i];
+        }
+    }
+}
+
+static void fireMix(double * NFM_VK_RESTRICT v, const double * NFM_VK_RESTRICT a, const size_t n,
+                    const double alpha, const double c, const double d)
+{
+    for (size_t i = 0; i < n; ++i) { v[i] = (1. - alpha)*v[i] + c*a[i]/d; }
+}
+
+static void fireFreeze(double * NFM_VK_RESTRICT x, double * NFM_VK_RESTRICT v, const double * NFM_VK_RESTRICT a,
+                       const size_t n, const bool fullFreeze, const double backstep)
+{
+    if (fullFreeze) {
+        for (size_t i = 0; i < n; ++i) {
+            x[i] -= backstep*v[i];
+            v[i] = 0.;
+        }
+    }
+    else {
+        for (size_t i = 0; i < n; ++i) {
+            const bool freeze = a[i]*v[i] < 0.;
+            x[i] -= freeze ? backstep*v[i] : 0.;
+            v[i] = freeze ? 0. : v[i];
+        }
+    }
+}
+
+static void ireneFreeze(double * NFM_VK_RESTRICT x, double * NFM_VK_RESTRICT v, const double * NFM_VK_RESTRICT a,
+                        const double * NFM_VK_RESTRICT aerr, const size_t n,
+                        const bool fullFreeze, const double backstep, const double sigmaLevel)
+{
+    if (fullFreeze) {
+        fireFreeze(x, v, a, n, true, backstep);
+        return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        const bool freeze = a[i]*v[i] + (aerr[i]*fabs(v[i]))*sigmaLevel < 0.; // upper bound of noisy a_i*v_i
+        x[i] -= freeze ? backstep*v[i] : 0.;
+        v[i] = freeze ? 0. : v[i];
+    }
+}
+
+extern const KernelTable table{dot, sumSqProd, axpy, square, ema, adamStep, adamStepFactored,
+                               sgdmStep, adagStep, adadStep, rmspStep, nestStep, lionStep,
+                               fireMix, fireFreeze, ireneFreeze};
+} // namespace NFM_VK_LEVEL
+} // namespace vk
+} // namespace nfm
+
+#undef NFM_VK_RESTRICT
@@ -0,0 +1,43 @@
+#ifndef NFM_VECKERNELSTABLE_HPP
+#define NFM_VECKERNELSTABLE_HPP
+
+// Internal header: Function table of one kernel level (see VecKernels.hpp)
+
+#include <cstddef>
+
+// number of partial sums used in reductions (power of 2, covers 512 bit of doubles)
+#define NFM_VK_NACC 8
+
+namespace nfm
+{
+namespace vk
+{
+
+struct KernelTable
+{
+    double (* dot)(const double *, const double *, size_t);
+    double (* sumSqProd)(const double *, const double *, size_t);
+    void (* axpy)(double *, const double *, double, size_t);
+    void (* square)(double *, const double *, double, size_t);
+    void (* ema)(double *, const double *, double, size_t);
+    void (* adamStep)(double *, double *, double *, const double *, size_t, double, double, double, double, bool);
+    void (* adamStepFactored)(double *, double *, const double *, const double *, size_t, double, double, double, double);
+    void (* sgdmStep)(double *, double *, const double *, size_t, double, double);
+    void (* adagStep)(double *, double *, const double *, size_t, double, double);
+    void (* adadStep)(double *, double *, double *, const double *, size_t, double, double);
+    void (* rmspStep)(double *, double *, const double *, size_t, double, double, double);
+    void (* nestStep)(double *, double *, const double *, size_t, double, double);
+    void (* lionStep)(double *, double *, const double *, const double *, size_t, double, double, double, double);
+    void (* fireMix)(double *, const double *, size_t, double, double, double);
+    void (* fireFreeze)(double *, double *, const double *, size_t, bool, double);
+    void (* ireneFreeze)(double *, double *, const double *, const double *, size_t, bool, double, double);
+};
+
+// the tables of all levels (AVX2/AVX512 exist only if NFM_VK_AVX2/NFM_VK_AVX512 are defined)
+namespace sse2 { extern const KernelTable table; }
+namespace avx2 { extern const KernelTable table; }
+namespace avx512 { extern const KernelTable table; }
+} // namespace vk
+} // namespace nfm
+
+#endif
@@ -0,0 +1,5 @@
+// AVX2 kernels, compiled with the AVX2 flags (see src/CMakeLists.txt)
+#ifdef NFM_VK_AVX2
+#define NFM_VK_LEVEL avx2
+#include "VecKernelsImpl.hpp"
+#endif
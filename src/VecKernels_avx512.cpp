@@ -0,0 +1,5 @@
+// AVX512 kernels, compiled with the AVX512 flags (see src/CMakeLists.txt)
+#ifdef NFM_VK_AVX512
+#define NFM_VK_LEVEL avx512
+#include "VecKernelsImpl.hpp"
+#endif
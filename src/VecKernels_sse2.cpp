@@ -0,0 +1,3 @@
+// Baseline kernels (SSE2 on x86-64), compiled without extra instruction set flags
+#define NFM_VK_LEVEL sse2
+#include "VecKernelsImpl.hpp"
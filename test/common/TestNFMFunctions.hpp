@@ -2,7 +2,10 @@
 #define NFM_TESTNFMFUNCTIONS_HPP
 
 #include "nfm/NoisyFunction.hpp"
+#include <algorithm>
+#include <cassert>
 #include <cmath>
+#include <vector>
 
 
 class Parabola: public nfm::NoisyFunction
@@ -81,4 +84,109 @@ public:
     }
 };
 
+class Quad3D: public nfm::NoisyFunctionWithOverlap
+{   // f = 0.5*(x-c)^T A (x-c), with A also serving as overlap matrix
+public:
+    const double A[3][3]{{2., 0.5, 0.}, {0.5, 1., 0.2}, {0., 0.2, 10.}};
+    const double c[3]{1., -1.5, 0.5};
+
+    Quad3D(): NoisyFunctionWithOverlap(3, true) {}
+
+    nfm::NoisyValue f(const std::vector<double> &in) override
+    {
+        double y = 0.;
+        for (int i = 0; i < 3; ++i) {
+            for (int j = 0; j < 3; ++j) { y += 0.5*(in[i] - c[i])*A[i][j]*(in[j] - c[j]); }
+        }
+        return {y, 0.00001};
+    }
+
+    void grad(const std::vector<double> &in, nfm::NoisyGradient &grad) override
+    {
+        for (int i = 0; i < 3; ++i) {
+            double gi = 0.;
+            for (int j = 0; j < 3; ++j) { gi -= A[i][j]*(in[j] - c[j]); }
+            grad.set(i, {gi, 0.000001});
+        }
+    }
+
+    void applyOverlap(const std::vector<double> &v, std::vector<double> &Sv) override
+    {
+        for (int i = 0; i < 3; ++i) {
+            Sv[i] = 0.;
+            for (int j = 0; j < 3; ++j) { Sv[i] += A[i][j]*v[j]; }
+        }
+    }
+};
+
+// Scaled quartic/quadratic f = sum_i a_i*(w4*(x_i - c)^4 + 0.5*w2*(x_i - c)^2) , with a_i in [1, 10),
+// adjustable center c and constant errors (the gradient errors are valid if gerr > 0)
+class ScaledQuartQuad: public nfm::NoisyFunctionWithGradient
+{
+public:
+    const double w4, w2; // weights of the quartic and quadratic terms
+    const double ferr, gerr; // errors of f and of every gradient element
+    double c = 1.; // center, i.e. the position of the minimum
+    int nrepeatedGrad = 0; // number of gradients computed twice in a row at the same position
+    std::vector<double> xgrad; // position of the last gradient
+
+    ScaledQuartQuad(int ndim, double quartW, double quadW, double fErr = 0., double gErr = 0.):
+            nfm::NoisyFunctionWithGradient(ndim, gErr > 0.), w4(quartW), w2(quadW), ferr(fErr), gerr(gErr) {}
+
+    static double a(int i) { return 1. + 9.*(i%97)/97.; }
+
+    nfm::NoisyValue f(const std::vector<double> &x) override
+    {
+        double y = 0.;
+        for (int i = 0; i < _ndim; ++i) {
+            const double d = x[i] - c;
+            y += a(i)*(w4*pow(d, 4) + 0.5*w2*d*d);
+        }
+        return {y, ferr};
+    }
+
+    void grad(const std::vector<double> &x, nfm::NoisyGradient &gradv) override
+    {
+        for (int i = 0; i < _ndim; ++i) {
+            const double d = x[i] - c;
+            gradv.set(i, {-a(i)*(4.*w4*pow(d, 3) + w2*d), gerr});
+        }
+        if (x == xgrad) { ++nrepeatedGrad; }
+        xgrad = x;
+    }
+};
+
+// Scaled quadratic f = 0.5 * sum_i a_i*(x_i - 1)^2 , with a_i in [1, 10)
+class LargeQuad: public ScaledQuartQuad
+{
+public:
+    explicit LargeQuad(int ndim): ScaledQuartQuad(ndim, 0., 1.) {}
+};
+
+
+// Runs the optimizers created by makeOpt() on fun, once as reference via findMin(fun, x0) and once via
+// runVariant(makeOpt) (e.g. interrupted and resumed, or by ask/tell), which returns the optimizer holding
+// the final result. Both runs have to end with bitwise identical results (and iteration counts if checkIter).
+template <class MakeOpt, class RunVariant>
+void checkSameResult(MakeOpt makeOpt, RunVariant runVariant, nfm::NoisyFunction &fun, const std::vector<double> &x0,
+                     bool checkIter = true)
+{
+    auto ref = makeOpt();
+    ref->findMin(fun, x0);
+
+    auto opt = runVariant(makeOpt);
+    assert(!checkIter || opt->getIter() == ref->getIter());
+    assert(opt->getX() == ref->getX());
+    assert(opt->getF() == ref->getF());
+}
+
+
+// maximal distance of the coordinates from the minimum at x_i = c
+inline double maxDistToMin(const std::vector<double> &x, double c = 1.)
+{
+    double maxdist = 0.;
+    for (const double xi : x) { maxdist = std::max(maxdist, fabs(xi - c)); }
+    return maxdist;
+}
+
 #endif
\ No newline at end of file
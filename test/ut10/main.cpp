@@ -0,0 +1,82 @@
+#include <cassert>
+#include <cmath>
+#include <random>
+
+#include "nfm/CMAES.hpp"
+#include "nfm/LogManager.hpp"
+
+#include "TestNFMFunctions.hpp"
+
+// F3D with actual gaussian noise of width sigma
+class NoisyF3D: public F3D
+{
+private:
+    std::mt19937_64 _rgen{1};
+    std::normal_distribution<double> _rd{0., 1.};
+    const double _sigma;
+
+public:
+    int nbatch = 0;
+
+    explicit NoisyF3D(double sigma): _sigma(sigma) {}
+
+    nfm::NoisyValue f(const std::vector<double> &in) override
+    {
+        nfm::NoisyValue y = F3D::f(in);
+        y.val += _sigma*_rd(_rgen);
+        y.err = _sigma;
+        return y;
+    }
+
+    void fbatch(const std::vector<std::vector<double>> &xs, std::vector<nfm::NoisyValue> &fs) override
+    {
+        ++nbatch;
+        F3D::fbatch(xs, fs);
+    }
+};
+
+void assertMin(const nfm::NFM &nfm, const double tol)
+{
+    assert(fabs(nfm.getX(0) - 1.0) < tol);
+    assert(fabs(nfm.getX(1) + 1.5) < tol);
+    assert(fabs(nfm.getX(2) - 0.5) < tol);
+}
+
+int main()
+{
+    using namespace std;
+    using namespace nfm;
+
+    LogManager::setLoggingOff();
+    //LogManager::setLoggingOn(true);
+
+    const std::vector<double> initpos{-2., 1., 0.};
+
+    // full covariance, (almost) noiseless
+    NoisyF3D f3d(0.);
+    CMAES cmaes(f3d.getNDim(), 1.);
+    cmaes.setMaxNIterations(500);
+    cmaes.findMin(f3d, initpos);
+    assertMin(cmaes, 0.1);
+    assert(cmaes.getLambda() == cmaes.getLambda0()); // no noise, no population growth
+
+    // (at least) one batch per generation
+    assert(f3d.nbatch >= cmaes.getIter());
+
+    // separable variant
+    cmaes.setSeparable(true);
+    cmaes.findMin(f3d, initpos);
+    assertMin(cmaes, 0.1);
+
+    // with noise the population should grow
+    NoisyF3D nf3d(0.01);
+    CMAES cmaes2(nf3d.getNDim(), 1.);
+    cmaes2.disableStopping();
+    cmaes2.setMaxNIterations(200);
+    cmaes2.findMin(nf3d, initpos);
+    assertMin(cmaes2, 0.4);
+    assert(cmaes2.getLambda() > cmaes2.getLambda0());
+    assert(cmaes2.getLambda() <= cmaes2.getMaxLambda());
+
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include <cassert>
+#include <cmath>
+
+#include "nfm/TrustRegion.hpp"
+#include "nfm/LogManager.hpp"
+
+#include "TestNFMFunctions.hpp"
+
+
+int main()
+{
+    using namespace std;
+    using namespace nfm;
+
+    LogManager::setLoggingOff();
+    //LogManager::setLoggingOn(true);
+
+    const std::vector<double> initpos{-2., 1., 0.};
+
+    // quartic function
+    F3D f3d;
+    TrustRegion tr(f3d.getNDim());
+    tr.findMin(f3d, initpos);
+
+    assert(fabs(tr.getX(0) - 1.0) < 0.05);
+    assert(fabs(tr.getX(1) + 1.5) < 0.05);
+    assert(fabs(tr.getX(2) - 0.5) < 0.05);
+
+    // quadratic function (where the model is exact)
+    Quad3D quad;
+    tr.setRadius0(1.);
+    tr.findMin(quad, initpos);
+
+    assert(fabs(tr.getX(0) - 1.0) < 0.001);
+    assert(fabs(tr.getX(1) + 1.5) < 0.001);
+    assert(fabs(tr.getX(2) - 0.5) < 0.001);
+
+    // tiny history and a radius limit
+    tr.setMaxNHistory(2);
+    tr.setMaxRadius(0.5);
+    tr.findMin(f3d, initpos);
+
+    assert(fabs(tr.getX(0) - 1.0) < 0.05);
+    assert(fabs(tr.getX(1) + 1.5) < 0.05);
+    assert(fabs(tr.getX(2) - 0.5) < 0.05);
+
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+#include "nfm/LevenbergMarquardt.hpp"
+#include "nfm/ConjGrad.hpp"
+#include "nfm/LogManager.hpp"
+
+#include "TestNFMFunctions.hpp"
+
+// Fit of y = a*exp(-b*t) + c to exact data (a=2, b=0.5, c=1)
+class ExpFit: public nfm::NoisyResidualFunction
+{
+public:
+    std::vector<double> t, y;
+    int nrepeatedRes = 0; // number of residuals computed twice in a row at the same position
+    std::vector<double> xres; // position of the last residuals
+
+    explicit ExpFit(bool flag_jac): nfm::NoisyResidualFunction(3, 20, true, flag_jac)
+    {
+        for (int k = 0; k < _nres; ++k) {
+            t.push_back(0.25*k);
+            y.push_back(2.*exp(-0.5*t.back()) + 1.);
+        }
+    }
+
+    void residuals(const std::vector<double> &x, std::vector<nfm::NoisyValue> &r) override
+    {
+        for (int k = 0; k < _nres; ++k) {
+            r[k].val = x[0]*exp(-x[1]*t[k]) + x[2] - y[k];
+            r[k].err = (k < 10) ? 0.01 : 0.02; // fake data errors
+        }
+        if (x == xres) { ++nrepeatedRes; }
+        xres = x;
+    }
+
+    void jacobian(const std::vector<double> &x, std::vector<double> &J) override
+    {
+        if (!_flag_jac) { // use the finite difference Jacobian
+            nfm::NoisyResidualFunction::jacobian(x, J);
+            return;
+        }
+        for (int k = 0; k < _nres; ++k) {
+            const double e = exp(-x[1]*t[k]);
+            J[k*3] = e;
+            J[k*3 + 1] = -x[0]*t[k]*e;
+            J[k*3 + 2] = 1.;
+        }
+    }
+};
+
+// Throws after the given number of residual evaluations
+class ThrowingFit: public ExpFit
+{
+public:
+    int nleft;
+
+    explicit ThrowingFit(int nres): ExpFit(true), nleft(nres) {}
+
+    void residuals(const std::vector<double> &x, std::vector<nfm::NoisyValue> &r) override
+    {
+        if (--nleft < 0) { throw std::runtime_error("residuals failed"); }
+        ExpFit::residuals(x, r);
+    }
+};
+
+// Exposes the casted target pointer
+class LMProbe: public nfm::LevenbergMarquardt
+{
+public:
+    using nfm::LevenbergMarquardt::LevenbergMarquardt;
+    bool hasResFun() const { return _resfun != nullptr; }
+};
+
+void assertFit(const nfm::NFM &nfm, const double tol)
+{
+    assert(fabs(nfm.getX(0) - 2.0) < tol);
+    assert(fabs(nfm.getX(1) - 0.5) < tol);
+    assert(fabs(nfm.getX(2) - 1.0) < tol);
+}
+
+int main()
+{
+    using namespace std;
+    using namespace nfm;
+
+    LogManager::setLoggingOff();
+    //LogManager::setLoggingOn(true);
+
+    const std::vector<double> initpos{1., 1., 0.};
+
+    // LM requires residual functions
+    F3D f3d;
+    LevenbergMarquardt lm(3);
+    bool thrown = false;
+    try {
+        lm.findMin(f3d, initpos);
+    }
+    catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // analytic Jacobian
+    ExpFit fit(true);
+    lm.findMin(fit, initpos);
+    assertFit(lm, 0.01); // stops when gradient is dominated by (fake) noise
+    assert(lm.getIter() < 20);
+
+    // without the noise stopping criterion
+    lm.setGradErrStop(false);
+    lm.findMin(fit, initpos);
+    assertFit(lm, 1.e-4);
+
+    // finite difference Jacobian, Levenberg damping, no weights
+    ExpFit fitfd(false);
+    lm.setMarquardtScaling(false);
+    lm.setWeights(false);
+    lm.findMin(fitfd, initpos);
+    assertFit(lm, 1.e-4);
+    assert(fitfd.nrepeatedRes == 0); // one residual evaluation per position
+
+    // the target pointers are cleared when the target throws
+    ThrowingFit fitThrow(3);
+    LMProbe lmProbe(3);
+    thrown = false;
+    try { lmProbe.findMin(fitThrow, initpos); }
+    catch (const std::runtime_error &) { thrown = true; }
+    assert(thrown);
+    assert(!lmProbe.isRunning() && !lmProbe.hasResFun());
+
+    // residual functions work with other optimizers as well (but converge slower)
+    const double finit = fit.f(initpos).val;
+    ConjGrad cg(3);
+    cg.setGradErrStop(false);
+    cg.findMin(fit, initpos);
+    assert(cg.getF() < finit);
+    assert(lm.getF() < cg.getF());
+
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include <cassert>
+#include <cmath>
+
+#include "nfm/VRDescent.hpp"
+#include "nfm/LogManager.hpp"
+
+#include "TestNFMFunctions.hpp"
+
+// Least-squares regression f(x) = 1/N sum_i 0.5*(a_i.x - b_i)^2, with exact solution (1, -1.5, 0.5)
+class LinReg: public nfm::NoisySumFunction
+{
+public:
+    std::vector<std::vector<double>> a;
+    std::vector<double> b;
+    int nTermGrads = 0; // count term gradient evaluations
+
+    explicit LinReg(bool flag_gradErr = false): nfm::NoisySumFunction(3, 40, flag_gradErr)
+    {
+        for (int i = 0; i < _nterms; ++i) {
+            a.push_back({1., sin(1.3*i), cos(0.7*i)});
+            b.push_back(a.back()[0] - 1.5*a.back()[1] + 0.5*a.back()[2]);
+        }
+    }
+
+    nfm::NoisyValue fTerm(const std::vector<double> &x, int i) override
+    {
+        const double r = a[i][0]*x[0] + a[i][1]*x[1] + a[i][2]*x[2] - b[i];
+        return nfm::NoisyValue{0.5*r*r, 0.};
+    }
+
+    void gradTerm(const std::vector<double> &x, int i, std::vector<double> &gradi) override
+    {
+        ++nTermGrads;
+        const double r = a[i][0]*x[0] + a[i][1]*x[1] + a[i][2]*x[2] - b[i];
+        for (int j = 0; j < 3; ++j) { gradi[j] = -r*a[i][j]; }
+    }
+};
+
+void assertSolution(const nfm::NFM &nfm, const double tol)
+{
+    assert(fabs(nfm.getX(0) - 1.0) < tol);
+    assert(fabs(nfm.getX(1) + 1.5) < tol);
+    assert(fabs(nfm.getX(2) - 0.5) < tol);
+}
+
+int main()
+{
+    using namespace std;
+    using namespace nfm;
+
+    LogManager::setLoggingOff();
+    //LogManager::setLoggingOn(true);
+
+    const std::vector<double> initpos{0., 0., 0.};
+
+    // VRDescent requires sum functions
+    F3D f3d;
+    VRDescent vrd(3, VRMode::SVRG, 0.1);
+    bool thrown = false;
+    try {
+        vrd.findMin(f3d, initpos);
+    }
+    catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // SVRG
+    LinReg linreg;
+    vrd.setEpsF(1.e-12);
+    vrd.findMin(linreg, initpos);
+    assertSolution(vrd, 1.e-4);
+
+    // SAGA, with minibatches
+    linreg.nTermGrads = 0;
+    vrd.useSAGA();
+    vrd.setBatchSize(4);
+    vrd.findMin(linreg, initpos);
+    assertSolution(vrd, 1.e-4);
+    assert(linreg.nTermGrads == linreg.getNTerms()*vrd.getIter()); // one table init plus one pass per epoch
+
+    // the same seed gives the same result
+    const std::vector<double> x1 = vrd.getX();
+    vrd.findMin(linreg, initpos);
+    assert(vrd.getX() == x1);
+
+    // gradient errors are the standard errors of the mean over the terms
+    LinReg linregErr(true);
+    NoisyGradient g(3);
+    linregErr.grad(initpos, g);
+    std::vector<double> gi(3);
+    for (int j = 0; j < 3; ++j) {
+        double mean = 0., mean2 = 0.;
+        for (int i = 0; i < linregErr.getNTerms(); ++i) {
+            linregErr.gradTerm(initpos, i, gi);
+            mean += gi[j]/linregErr.getNTerms();
+            mean2 += gi[j]*gi[j]/linregErr.getNTerms();
+        }
+        assert(fabs(g.val[j] - mean) < 1.e-12);
+        assert(g.err[j] > 0. && fabs(g.err[j] - sqrt((mean2 - mean*mean)/(linregErr.getNTerms() - 1))) < 1.e-12);
+    }
+
+    // and are set by both modes (SAGA from its gradient table)
+    for (const auto vrmode : {VRMode::SVRG, VRMode::SAGA}) {
+        VRDescent vrdErr(3, vrmode, 0.1);
+        vrdErr.setMaxNIterations(1);
+        vrdErr.findMin(linregErr, initpos);
+        assert(vrdErr.hasGradErr());
+        for (int j = 0; j < 3; ++j) { assert(vrdErr.getGrad().err[j] > 0.); }
+        if (vrmode == VRMode::SVRG) {
+            linregErr.grad(vrdErr.getX(), g);
+            assert(vrdErr.getGrad().err == g.err);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include <cassert>
+#include <cmath>
+
+#include "nfm/TruncatedNewton.hpp"
+#include "nfm/ConjGrad.hpp"
+#include "nfm/LogManager.hpp"
+
+#include "TestNFMFunctions.hpp"
+
+// Extended Rosenbrock function in N dimensions, with minimum in (1, ..., 1)
+// The independent 2D Rosenbrock terms are weighted from 1 to 1000, to make the problem ill-conditioned.
+// If flag_hv, the Hessian-vector product is computed analytically, else by gradient differences.
+// If gradErr > 0, fake gradient (and Hessian-vector) errors of that size are reported.
+class RosenbrockND: public nfm::NoisyFunctionWithHessVec
+{
+public:
+    const bool flag_hv;
+    const double gradErr;
+
+    double w(int i) const { return pow(1000., static_cast<double>(i)/_ndim); }
+
+    RosenbrockND(int ndim, bool flag_hv, double gradErr = 0.):
+            nfm::NoisyFunctionWithHessVec(ndim, gradErr > 0.), flag_hv(flag_hv), gradErr(gradErr) {}
+
+    nfm::NoisyValue f(const std::vector<double> &x) override
+    {
+        double y = 0.;
+        for (int i = 0; i < _ndim - 1; i += 2) { y += w(i)*(100.*pow(x[i + 1] - x[i]*x[i], 2) + pow(1. - x[i], 2)); }
+        return {y, 0.};
+    }
+
+    void grad(const std::vector<double> &x, nfm::NoisyGradient &grad) override
+    {
+        std::fill(grad.val.begin(), grad.val.end(), 0.);
+        for (int i = 0; i < _ndim - 1; i += 2) {
+            const double common = w(i)*200.*(x[i + 1] - x[i]*x[i]);
+            grad.val[i] += common*2.*x[i] + w(i)*2.*(1. - x[i]);
+            grad.val[i + 1] -= common;
+        }
+        std::fill(grad.err.begin(), grad.err.end(), gradErr);
+    }
+
+    void hessVec(const std::vector<double> &x, const std::vector<double> &v, nfm::NoisyGradient &Hv) override
+    {
+        if (!flag_hv) {
+            nfm::NoisyFunctionWithHessVec::hessVec(x, v, Hv);
+            return;
+        }
+        Hv.zero();
+        for (int i = 0; i < _ndim - 1; i += 2) { // the 2x2 Hessian block of term i
+            const double hii = w(i)*(1200.*x[i]*x[i] - 400.*x[i + 1] + 2.);
+            const double hij = -w(i)*400.*x[i];
+            Hv.val[i] += hii*v[i] + hij*v[i + 1];
+            Hv.val[i + 1] += hij*v[i] + w(i)*200.*v[i + 1];
+        }
+        std::fill(Hv.err.begin(), Hv.err.end(), gradErr);
+    }
+};
+
+void assertOnes(const nfm::NFM &nfm, const double tol)
+{
+    for (int i = 0; i < nfm.getNDim(); ++i) {
+        assert(fabs(nfm.getX(i) - 1.) < tol);
+    }
+}
+
+int main()
+{
+    using namespace std;
+    using namespace nfm;
+
+    LogManager::setLoggingOff();
+    //LogManager::setLoggingOn(true);
+
+    const int ndim = 100;
+    std::vector<double> initpos(ndim);
+    for (int i = 0; i < ndim; ++i) { initpos[i] = (i%2 == 0) ? -1.2 + 0.01*i : 1.; }
+
+    // TruncatedNewton requires functions with Hessian-vector products
+    F3D f3d;
+    TruncatedNewton tn(3);
+    bool thrown = false;
+    try {
+        tn.findMin(f3d, {1., 1., 1.});
+    }
+    catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // analytic Hessian-vector products
+    RosenbrockND rbhv(ndim, true);
+    TruncatedNewton tn2(ndim);
+    tn2.setEpsX(1.e-8);
+    tn2.findMin(rbhv, initpos);
+    assertOnes(tn2, 1.e-4);
+    const int tnIter = static_cast<int>(tn2.getIter());
+    assert(tn2.getF() < 1.e-12);
+
+    // gradient differences
+    RosenbrockND rbfd(ndim, false);
+    tn2.findMin(rbfd, initpos);
+    assertOnes(tn2, 1.e-4);
+
+    // the default products difference against the reference gradient set by the optimizer (not a stale cached one)
+    std::vector<double> v(ndim, 0.);
+    v[0] = 1.;
+    NoisyGradient g0(ndim), Hv(ndim), Hv2(ndim);
+    rbfd.grad(initpos, g0);
+    rbfd.hessVec(initpos, v, Hv);
+    g0.val[0] += 1.e-6; // as if the target had changed at the same position
+    rbfd.setHessVecRefGrad(initpos, g0);
+    rbfd.hessVec(initpos, v, Hv2);
+    assert(Hv2.val[0] != Hv.val[0] && Hv2.val[1] == Hv.val[1]);
+
+    // with noise, stops when the gradient is dominated by noise
+    RosenbrockND rbnoisy(ndim, true, 1.e-4);
+    tn2.findMin(rbnoisy, initpos);
+    assertOnes(tn2, 1.e-3);
+
+    // conjugate gradients are still far off after 10 times more iterations
+    ConjGrad cg(ndim, CGMode::CGPR);
+    cg.setStepSize(0.01);
+    cg.disableStopping();
+    cg.setMaxNIterations(10*tnIter);
+    cg.findMin(rbhv, initpos);
+    assert(cg.getF() > 1.e-4);
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <cassert>
+#include <cmath>
+
+#include "nfm/LinearMethod.hpp"
+#include "nfm/LogManager.hpp"
+
+#include "TestNFMFunctions.hpp"
+
+// 2D Rosenbrock function with minimum in (1, 1), providing linear method matrices.
+// For a function with gradient g and Hessian B, the matrices
+//     H = [[f, g^T/2], [g/2, f*I + B/2]] ,  S = [[1, 0], [0, I]]
+// make the linear method equivalent to an (augmented Hessian) Newton method.
+class RosenbrockHS: public nfm::NoisyFunctionWithHSMatrices
+{
+public:
+    int nfHS = 0; // count matrix evaluations
+
+    RosenbrockHS(): nfm::NoisyFunctionWithHSMatrices(2) {}
+
+    nfm::NoisyValue f(const std::vector<double> &x) override
+    {
+        return {100.*pow(x[1] - x[0]*x[0], 2) + pow(1. - x[0], 2), 0.};
+    }
+
+    nfm::NoisyValue fHS(const std::vector<double> &x, std::vector<double> &H, std::vector<double> &S) override
+    {
+        ++nfHS;
+        const nfm::NoisyValue fx = this->f(x);
+        const double g[2] = {-400.*x[0]*(x[1] - x[0]*x[0]) - 2.*(1. - x[0]), 200.*(x[1] - x[0]*x[0])};
+        const double B[2][2] = {{1200.*x[0]*x[0] - 400.*x[1] + 2., -400.*x[0]}, {-400.*x[0], 200.}};
+
+        std::fill(S.begin(), S.end(), 0.);
+        H[0] = fx.val;
+        S[0] = 1.;
+        for (int i = 0; i < 2; ++i) {
+            H[i + 1] = 0.5*g[i];
+            H[(i + 1)*3] = 0.5*g[i];
+            for (int j = 0; j < 2; ++j) { H[(i + 1)*3 + j + 1] = 0.5*B[i][j]; }
+            H[(i + 1)*3 + i + 1] += fx.val;
+            S[(i + 1)*3 + i + 1] = 1.;
+        }
+        return fx;
+    }
+};
+
+int main()
+{
+    using namespace std;
+    using namespace nfm;
+
+    LogManager::setLoggingOff();
+    //LogManager::setLoggingOn(true);
+
+    const std::vector<double> initpos{-1.2, 1.};
+
+    // LinearMethod requires functions with H and S matrices
+    F3D f3d;
+    LinearMethod lm(3);
+    bool thrown = false;
+    try {
+        lm.findMin(f3d, {1., 1., 1.});
+    }
+    catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // Rosenbrock is solved in few iterations
+    RosenbrockHS rbhs;
+    LinearMethod lm2(2);
+    lm2.setEpsX(1.e-10);
+    lm2.findMin(rbhs, initpos);
+    assert(fabs(lm2.getX(0) - 1.) < 1.e-6);
+    assert(fabs(lm2.getX(1) - 1.) < 1.e-6);
+    assert(rbhs.nfHS < 30);
+
+    // the shift adapts quickly, even from a much too large initial value
+    rbhs.nfHS = 0;
+    lm2.setShift0(100.);
+    lm2.findMin(rbhs, initpos);
+    assert(rbhs.nfHS < 30);
+    assert(fabs(lm2.getX(0) - 1.) < 1.e-6);
+    assert(fabs(lm2.getX(1) - 1.) < 1.e-6);
+
+    return 0;
+}
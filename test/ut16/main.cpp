@@ -0,0 +1,59 @@
+#include <cassert>
+#include <cmath>
+
+#include "nfm/Powell.hpp"
+#include "nfm/LogManager.hpp"
+
+#include "TestNFMFunctions.hpp"
+
+// Rotated and scaled quadratic without noise, f = 0.5*(x-c)^T A (x-c)
+class ExactQuad3D: public Quad3D
+{
+public:
+    nfm::NoisyValue f(const std::vector<double> &in) override
+    {
+        return {Quad3D::f(in).val, 0.};
+    }
+};
+
+void assertMinimum(const nfm::NFM &nfm, const double tol)
+{
+    assert(fabs(nfm.getX(0) - 1.0) < tol);
+    assert(fabs(nfm.getX(1) + 1.5) < tol);
+    assert(fabs(nfm.getX(2) - 0.5) < tol);
+}
+
+int main()
+{
+    using namespace std;
+    using namespace nfm;
+
+    LogManager::setLoggingOff();
+    //LogManager::setLoggingOn(true);
+
+    const std::vector<double> initpos{-2., 1., 0.};
+
+    // serial sweeps
+    ExactQuad3D quad;
+    Powell powell(3, 0.5);
+    powell.setEpsX(1.e-8);
+    powell.findMin(quad, initpos);
+    assertMinimum(powell, 1.e-5);
+    const double niter = powell.getIter();
+    assert(niter < 20);
+
+    // noisy function
+    F3D f3d;
+    powell.setEpsX(1.e-5);
+    powell.findMin(f3d, initpos);
+    assertMinimum(powell, 0.1); // flat quartic minimum
+
+    // concurrent line searches (the test functions are thread-safe)
+    powell.setNLineThreads(3);
+    assert(powell.getNLineThreads() == 3 && powell.getNThreads() == 1); // independent of the NFM thread pool
+    powell.setEpsX(1.e-8);
+    powell.findMin(quad, initpos);
+    assertMinimum(powell, 1.e-4);
+
+    return 0;
+}
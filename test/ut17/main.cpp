@@ -0,0 +1,74 @@
+#include <cassert>
+#include <cmath>
+
+#include "nfm/SubspaceDescent.hpp"
+#include "nfm/LogManager.hpp"
+
+#include "TestNFMFunctions.hpp"
+
+// f = 0.5 * sum_i (x_i - 1)^2 , with directional derivatives that never form the full gradient
+class SphereDD: public nfm::NoisyFunctionWithGradient
+{
+public:
+    int ngrad = 0;
+    int ndd = 0;
+
+    explicit SphereDD(int ndim): nfm::NoisyFunctionWithGradient(ndim, false) {}
+
+    nfm::NoisyValue f(const std::vector<double> &x) override
+    {
+        double y = 0.;
+        for (const double xi : x) { y += 0.5*(xi - 1.)*(xi - 1.); }
+        return {y, 0.};
+    }
+
+    void grad(const std::vector<double> &x, nfm::NoisyGradient &gradv) override
+    {
+        ++ngrad;
+        for (int i = 0; i < _ndim; ++i) { gradv.val[i] = 1. - x[i]; }
+    }
+
+    void dirDeriv(const std::vector<double> &x, const std::vector<double> &dirs, std::vector<nfm::NoisyValue> &dd) override
+    {
+        ++ndd;
+        dd.resize(dirs.size()/_ndim);
+        for (size_t j = 0; j < dd.size(); ++j) {
+            dd[j] = {0., 0.};
+            for (int i = 0; i < _ndim; ++i) { dd[j].val += (1. - x[i])*dirs[j*_ndim + i]; }
+        }
+    }
+};
+
+int main()
+{
+    using namespace std;
+    using namespace nfm;
+
+    LogManager::setLoggingOff();
+    //LogManager::setLoggingOn(true);
+
+    // high-dimensional case with custom directional derivatives
+    const int ndim = 200;
+    SphereDD sphere(ndim);
+    SubspaceDescent sd(ndim, 20, 1.);
+    sd.setEpsX(0.);
+    sd.setEpsF(1.e-10);
+    sd.findMin(sphere, std::vector<double>(ndim, 0.));
+    for (int i = 0; i < ndim; ++i) {
+        assert(fabs(sd.getX(i) - 1.) < 1.e-4);
+    }
+    assert(sphere.ngrad == 0);
+    assert(sphere.ndd == static_cast<int>(sd.getIter()));
+
+    // default directional derivatives from projected gradients
+    F3D f3d;
+    SubspaceDescent sd3(3, 2, 0.1);
+    sd3.setMaxNIterations(5000);
+    sd3.setAveraging(true);
+    sd3.findMin(f3d, {-1., -1., 1.});
+    assert(fabs(sd3.getX(0) - 1.) < 0.1);
+    assert(fabs(sd3.getX(1) + 1.5) < 0.1);
+    assert(fabs(sd3.getX(2) - 0.5) < 0.1);
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <cassert>
+#include <cmath>
+
+#include "nfm/AdaHessian.hpp"
+#include "nfm/LogManager.hpp"
+
+#include "TestNFMFunctions.hpp"
+
+// Badly scaled quadratic f = 0.5 * sum_i a_i*(x_i - 1)^2 , with a_i from 1 to 1000,
+// with exact gradients and Hessian-vector products
+class ScaledQuad: public nfm::NoisyFunctionWithHessVec
+{
+public:
+    std::vector<double> a;
+    int nbatch = 0; // count batch calls
+
+    explicit ScaledQuad(int ndim): nfm::NoisyFunctionWithHessVec(ndim, false)
+    {
+        for (int i = 0; i < ndim; ++i) { a.push_back(pow(1000., static_cast<double>(i)/(ndim - 1))); }
+    }
+
+    nfm::NoisyValue f(const std::vector<double> &x) override
+    {
+        double y = 0.;
+        for (int i = 0; i < _ndim; ++i) { y += 0.5*a[i]*(x[i] - 1.)*(x[i] - 1.); }
+        return {y, 0.};
+    }
+
+    void grad(const std::vector<double> &x, nfm::NoisyGradient &gradv) override
+    {
+        for (int i = 0; i < _ndim; ++i) { gradv.val[i] = -a[i]*(x[i] - 1.); }
+    }
+
+    void hessVec(const std::vector<double> & /*x*/, const std::vector<double> &v, nfm::NoisyGradient &Hv) override
+    {
+        for (int i = 0; i < _ndim; ++i) { Hv.val[i] = a[i]*v[i]; }
+    }
+
+    void hessVecBatch(const std::vector<double> &x, const std::vector<std::vector<double>> &vs, std::vector<nfm::NoisyGradient> &Hvs) override
+    {
+        ++nbatch;
+        nfm::NoisyFunctionWithHessVec::hessVecBatch(x, vs, Hvs);
+    }
+};
+
+void assertOnes(const nfm::NFM &nfm, const double tol)
+{
+    for (int i = 0; i < nfm.getNDim(); ++i) {
+        assert(fabs(nfm.getX(i) - 1.) < tol);
+    }
+}
+
+int main()
+{
+    using namespace std;
+    using namespace nfm;
+
+    LogManager::setLoggingOff();
+    //LogManager::setLoggingOn(true);
+
+    // AdaHessian requires functions with Hessian-vector products
+    F3D f3d;
+    AdaHessian ah(3);
+    bool thrown = false;
+    try {
+        ah.findMin(f3d, {1., 1., 1.});
+    }
+    catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // the diagonal Hessian is estimated exactly, so all coordinates converge alike
+    const int ndim = 10;
+    const std::vector<double> initpos(ndim, 0.);
+    ScaledQuad quad(ndim);
+    AdaHessian ah2(ndim, 2, 0.1);
+    ah2.setMaxNIterations(500);
+    ah2.findMin(quad, initpos);
+    assertOnes(ah2, 1.e-3);
+    assert(quad.nbatch == static_cast<int>(ah2.getIter()) - 1); // one batch per step
+
+    // spatial averaging mixes the scales of neighbouring coordinates, but still converges
+    ah2.setBlockSize(2);
+    ah2.findMin(quad, initpos);
+    assertOnes(ah2, 1.e-3);
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "nfm/Adam.hpp"
+#include "nfm/IRENE.hpp"
+#include "nfm/LogManager.hpp"
+#include "nfm/VecKernels.hpp"
+
+#include "TestNFMFunctions.hpp"
+
+using namespace nfm;
+
+// all vectors used by the kernels
+struct KernelData
+{
+    std::vector<double> x, v, w, m, g, gerr;
+    double dot = 0., ssp = 0.;
+
+    explicit KernelData(size_t n)
+    {
+        std::mt19937_64 rgen(1337);
+        std::normal_distribution<double> rdist;
+        for (auto * vec : {&x, &v, &w, &m, &g, &gerr}) {
+            vec->resize(n);
+            for (double &d : *vec) { d = rdist(rgen); }
+        }
+        for (double &d : w) { d = fabs(d); } // w and gerr are non-negative
+        for (double &d : gerr) { d = 0.1*fabs(d); }
+    }
+};
+
+// apply all kernels in sequence
+void runKernels(KernelData &d)
+{
+    const size_t n = d.x.size();
+    d.dot = vk::dot(d.x.data(), d.g.data(), n);
+    d.ssp = vk::sumSqProd(d.v.data(), d.gerr.data(), n);
+    vk::square(d.v.data(), d.g.data(), 1., n);
+    vk::adamStep(d.x.data(), d.m.data(), d.v.data(), d.g.data(), n, 0.9, 0.999, 0.01, 1e-8, false);
+    vk::adamStep(d.x.data(), d.m.data(), d.v.data(), d.g.data(), n, 0.9, 0.999, 0.01, 1e-8, true);
+    vk::adamStepFactored(d.x.data(), d.m.data(), d.v.data(), d.g.data(), n, 0.9, 0.5, 0.01, 1e-8);
+    vk::ema(d.m.data(), d.x.data(), 0.99, n);
+    vk::sgdmStep(d.x.data(), d.m.data(), d.g.data(), n, 0.9, 0.01);
+    vk::adagStep(d.x.data(), d.v.data(), d.g.data(), n, 0.01, 1e-8);
+    vk::adadStep(d.x.data(), d.v.data(), d.w.data(), d.g.data(), n, 0.9, 1e-8);
+    vk::rmspStep(d.x.data(), d.v.data(), d.g.data(), n, 0.9, 0.01, 1e-8);
+    vk::nestStep(d.x.data(), d.m.data(), d.g.data(), n, 0.9, 0.01);
+    vk::lionStep(d.x.data(), d.m.data(), d.g.data(), nullptr, n, 0.9, 0.99, 0.01, 0.);
+    vk::lionStep(d.x.data(), d.m.data(), d.g.data(), d.gerr.data(), n, 0.9, 0.99, 0.01, 1.);
+    vk::axpy(d.m.data(), d.g.data(), -0.5, n);
+    vk::fireMix(d.m.data(), d.g.data(), n, 0.1, 0.3, 2.);
+    vk::ireneFreeze(d.x.data(), d.m.data(), d.g.data(), d.gerr.data(), n, false, 0.05, 1.);
+    vk::fireFreeze(d.x.data(), d.v.data(), d.g.data(), n, false, 0.05);
+    vk::fireFreeze(d.x.data(), d.w.data(), d.g.data(), n, true, 0.);
+}
+
+int main()
+{
+    using namespace std;
+
+    LogManager::setLoggingOff();
+
+    const size_t n = 1003; // not a multiple of any vector width
+    const vk::SIMDLevel maxLevel = vk::getMaxSIMDLevel();
+    assert(vk::getSIMDLevel() == maxLevel); // best level is chosen by default
+
+    // reference values for some kernels, computed naively
+    KernelData ref(n);
+    double refdot = 0., refssp = 0.;
+    for (size_t i = 0; i < n; ++i) {
+        refdot += ref.x[i]*ref.g[i];
+        refssp += pow(ref.v[i]*ref.gerr[i], 2);
+    }
+
+    // run all levels and compare
+    vk::setSIMDLevel(vk::SIMDLevel::SSE2);
+    assert(vk::getSIMDLevel() == vk::SIMDLevel::SSE2);
+    KernelData base(n);
+    runKernels(base);
+    assert(fabs(base.dot - refdot) < 1e-12*n);
+    assert(fabs(base.ssp - refssp) < 1e-12*n);
+
+    for (const auto level : {vk::SIMDLevel::AVX2, vk::SIMDLevel::AVX512}) {
+        vk::setSIMDLevel(level);
+        if (static_cast<int>(level) > static_cast<int>(maxLevel)) { // level not available on this CPU
+            assert(vk::getSIMDLevel() == maxLevel);
+            continue;
+        }
+        assert(vk::getSIMDLevel() == level);
+
+        KernelData data(n);
+        runKernels(data);
+        assert(data.dot == base.dot); // all levels yield bitwise identical results
+        assert(data.ssp == base.ssp);
+        assert(data.x == base.x);
+        assert(data.v == base.v);
+        assert(data.w == base.w);
+        assert(data.m == base.m);
+    }
+
+    // optimizers yield identical results on all levels
+    F3D f3d;
+    const std::vector<double> initpos{-2., 1., 0.};
+    std::vector<double> xadam, xirene;
+    for (const auto level : {vk::SIMDLevel::SSE2, vk::SIMDLevel::AVX2, vk::SIMDLevel::AVX512}) {
+        vk::setSIMDLevel(level);
+
+        Adam adam(f3d.getNDim(), true, 0.1); // settings as in ut6
+        adam.setMaxNConstValues(100);
+        adam.setBeta1(0.1);
+        adam.setBeta2(0.1);
+        adam.findMin(f3d, initpos);
+        assert(fabs(adam.getX(0) - 1.0) < 0.1);
+        assert(fabs(adam.getX(1) + 1.5) < 0.1);
+        assert(fabs(adam.getX(2) - 0.5) < 0.1);
+
+        IRENE irene(f3d.getNDim(), 1.);
+        irene.setSelectiveFreeze();
+        irene.findMin(f3d, initpos);
+        assert(fabs(irene.getX(0) - 1.0) < 0.05);
+        assert(fabs(irene.getX(1) + 1.5) < 0.05);
+        assert(fabs(irene.getX(2) - 0.5) < 0.05);
+
+        if (level == vk::SIMDLevel::SSE2) {
+            xadam = adam.getX();
+            xirene = irene.getX();
+        }
+        else {
+            assert(adam.getX() == xadam);
+            assert(irene.getX() == xirene);
+        }
+    }
+    vk::setSIMDLevel(maxLevel);
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include <cassert>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include "nfm/Adam.hpp"
+#include "nfm/ConjGrad.hpp"
+#include "nfm/FIRE.hpp"
+#include "nfm/LogManager.hpp"
+#include "nfm/ThreadPool.hpp"
+
+#include "TestNFMFunctions.hpp"
+
+// run optimizer with given number of threads and return the result
+template <class Optimizer>
+std::vector<double> runWithThreads(Optimizer &opt, nfm::NoisyFunction &fun, int nthreads)
+{
+    opt.setNThreads(nthreads);
+    opt.findMin(fun, std::vector<double>(fun.getNDim(), 0.));
+    return opt.getX();
+}
+
+int main()
+{
+    using namespace std;
+    using namespace nfm;
+
+    LogManager::setLoggingOff();
+
+    // --- ThreadPool
+    ThreadPool pool(3);
+    assert(pool.getNThreads() == 3);
+
+    // chunks cover the range without gaps
+    size_t b0, e0, b1, e1, b2, e2;
+    ThreadPool::chunkRange(10, 3, 0, b0, e0);
+    ThreadPool::chunkRange(10, 3, 1, b1, e1);
+    ThreadPool::chunkRange(10, 3, 2, b2, e2);
+    assert(b0 == 0 && e0 == b1 && e1 == b2 && e2 == 10);
+    assert(e0 - b0 == 4 && e1 - b1 == 3 && e2 - b2 == 3);
+
+    // parallel loop and reduction
+    std::vector<double> vec(1001);
+    pool.parallelFor(vec.size(), [&](size_t begin, size_t end) { for (size_t i = begin; i < end; ++i) { vec[i] = 1./(i + 1.); }});
+    double sum1 = pool.parallelSum(vec.size(), [&](size_t begin, size_t end) { return std::accumulate(vec.begin() + begin, vec.begin() + end, 0.); });
+    double sum2 = pool.parallelSum(vec.size(), [&](size_t begin, size_t end) { return std::accumulate(vec.begin() + begin, vec.begin() + end, 0.); });
+    assert(sum1 == sum2);
+    assert(fabs(sum1 - std::accumulate(vec.begin(), vec.end(), 0.)) < 1e-12);
+
+    // --- Optimizers with parallel internal loops
+    const int ndim = 5000;
+    LargeQuad lquad(ndim);
+
+    ConjGrad cg(ndim);
+    cg.setParallelThreshold(1000);
+    const std::vector<double> xcg1 = runWithThreads(cg, lquad, 1);
+    const std::vector<double> xcg4a = runWithThreads(cg, lquad, 4);
+    const std::vector<double> xcg4b = runWithThreads(cg, lquad, 4);
+    assert(cg.getNThreads() == 4);
+    assert(xcg4a == xcg4b); // bitwise reproducible
+    assert(maxDistToMin(xcg1) < 1e-3);
+    assert(maxDistToMin(xcg4a) < 1e-3);
+
+    Adam adam(ndim, true, 0.1);
+    adam.setParallelThreshold(1000);
+    adam.setMaxNIterations(200);
+    const std::vector<double> xadam1 = runWithThreads(adam, lquad, 1);
+    const std::vector<double> xadam4 = runWithThreads(adam, lquad, 4);
+    assert(xadam1 == xadam4); // element-wise update and averaging don't depend on chunking
+
+    FIRE fire(ndim, 0.3);
+    fire.setParallelThreshold(1000);
+    fire.setMaxNIterations(500);
+    const std::vector<double> xfire1 = runWithThreads(fire, lquad, 1);
+    const std::vector<double> xfire4a = runWithThreads(fire, lquad, 4);
+    const std::vector<double> xfire4b = runWithThreads(fire, lquad, 4);
+    assert(xfire4a == xfire4b);
+    assert(maxDistToMin(xfire1) < 1e-3);
+    assert(maxDistToMin(xfire4a) < 1e-3);
+
+    // below threshold, the serial path is used
+    fire.setParallelThreshold(ndim + 1);
+    assert(runWithThreads(fire, lquad, 4) == xfire1);
+
+    // copies keep the configuration, but run serially (no shared pool)
+    fire.setParallelThreshold(1000);
+    FIRE fireCopy(fire);
+    assert(fire.getNThreads() == 4 && fireCopy.getNThreads() == 1);
+    assert(fireCopy.getParallelThreshold() == 1000 && fireCopy.getMaxNIterations() == 500);
+    fireCopy.findMin(lquad, std::vector<double>(ndim, 0.));
+    assert(fireCopy.getX() == xfire1);
+    assert(runWithThreads(fire, lquad, 4) == xfire4a);
+
+    return 0;
+}
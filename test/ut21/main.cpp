@@ -0,0 +1,164 @@
+#include <cassert>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+#include "nfm/Adam.hpp"
+#include "nfm/DynamicDescent.hpp"
+#include "nfm/LogManager.hpp"
+
+#include "TestNFMFunctions.hpp"
+
+// Scaled quadratic f = 0.5 * sum_i a_i*(x_i - 1)^2 , where every gradient evaluation
+// provides only a random subset of nsel coordinates (like minibatches of embedding rows)
+class SparseQuad: public nfm::NoisyFunctionWithSparseGradient
+{
+public:
+    const int nsel;
+    std::mt19937_64 rgen;
+
+    SparseQuad(int ndim, int nselect): nfm::NoisyFunctionWithSparseGradient(ndim, false), nsel(nselect) {}
+
+    static double a(int i) { return 1. + (i%10); }
+
+    nfm::NoisyValue f(const std::vector<double> &x) override
+    {
+        double y = 0.;
+        for (int i = 0; i < _ndim; ++i) { y += 0.5*a(i)*(x[i] - 1.)*(x[i] - 1.); }
+        return {y, 0.};
+    }
+
+    void sparseGrad(const std::vector<double> &x, nfm::NoisySparseGradient &sgrad) override
+    {
+        std::uniform_int_distribution<int> rdist(0, _ndim/nsel - 1);
+        const int offset = rdist(rgen); // select every (ndim/nsel)-th coordinate, starting from offset
+        for (int i = offset; i < _ndim; i += _ndim/nsel) { sgrad.add(i, -a(i)*(x[i] - 1.)); }
+    }
+};
+
+int main()
+{
+    using namespace std;
+    using namespace nfm;
+
+    LogManager::setLoggingOff();
+
+    const int ndim = 1000;
+    const int niter = 2000;
+    const std::vector<double> x0(ndim, 0.);
+    SparseQuad squad(ndim, 100);
+
+    // dense gradient is provided as well
+    NoisyGradient g(ndim);
+    squad.grad(x0, g);
+    int nnz = 0;
+    for (const double gi : g.val) { nnz += (gi != 0.) ? 1 : 0; }
+    assert(nnz == 100);
+
+    // --- DynamicDescent: lazy AdaGrad and RMSProp equal the dense versions
+    for (const auto ddmode : {DDMode::ADAG, DDMode::RMSP}) {
+        DynamicDescent dd(ndim, ddmode, false, (ddmode == DDMode::ADAG) ? 0.1 : 0.02);
+        dd.disableStopping();
+        dd.setMaxNIterations(niter);
+
+        squad.rgen.seed(1337);
+        dd.findMin(squad, x0);
+        const std::vector<double> xdense = dd.getX();
+
+        squad.rgen.seed(1337);
+        dd.setLazyUpdates(true);
+        dd.findMin(squad, x0);
+        assert(dd.usesLazyUpdates());
+        for (int i = 0; i < ndim; ++i) {
+            assert(fabs(dd.getX(i) - xdense[i]) < 1e-10);
+        }
+        assert(maxDistToMin(dd.getX()) < 0.05);
+    }
+
+    // lazy SGDM
+    DynamicDescent sgdm(ndim, DDMode::SGDM, false, 0.01);
+    sgdm.disableStopping();
+    sgdm.setMaxNIterations(niter);
+    sgdm.setLazyUpdates(true);
+    squad.rgen.seed(1337);
+    sgdm.findMin(squad, x0);
+    assert(maxDistToMin(sgdm.getX()) < 0.05);
+    assert(fabs(sgdm.getF() - squad.f(sgdm.getX()).val) < 1e-12); // final value is consistent
+
+    // unsupported modes / targets
+    sgdm.useNesterov();
+    bool thrown = false;
+    try { sgdm.findMin(squad, x0); }
+    catch (const std::invalid_argument &) { thrown = true; }
+    assert(thrown);
+
+    F3D f3d;
+    DynamicDescent dd3(f3d.getNDim());
+    dd3.setLazyUpdates(true);
+    thrown = false;
+    try { dd3.findMin(f3d); }
+    catch (const std::invalid_argument &) { thrown = true; }
+    assert(thrown);
+
+    // --- Lazy Adam (with averaging)
+    Adam adam(ndim, true, 0.1);
+    adam.disableStopping();
+    adam.setMaxNIterations(niter);
+    adam.setLazyUpdates(true);
+    squad.rgen.seed(1337);
+    adam.findMin(squad, x0);
+    assert(maxDistToMin(adam.getX()) < 0.05);
+
+    // without averaging and with AMSGrad
+    adam.setAveraging(false);
+    adam.setAMSGrad(true);
+    squad.rgen.seed(1337);
+    adam.findMin(squad, x0);
+    assert(maxDistToMin(adam.getX()) < 0.05);
+
+    // --- Lazy bookkeeping: x isn't copied into the old value list on every step and deltaX,
+    // computed from the touched coordinates only, equals the change of the full position
+    std::vector<double> xprev;
+    int nprobed = 0;
+    auto probe = [&](NFM &nfm, NoisyFunction &) {
+        assert(nfm.getOldValues().back().x.empty());
+        if (!xprev.empty()) {
+            double dx2 = 0.;
+            for (int i = 0; i < ndim; ++i) { dx2 += (nfm.getX(i) - xprev[i])*(nfm.getX(i) - xprev[i]); }
+            assert(fabs(nfm.getDeltaX() - sqrt(dx2)) < 1e-12);
+            ++nprobed;
+        }
+        xprev = nfm.getX();
+        return false;
+    };
+
+    adam.setPolicy(probe);
+    squad.rgen.seed(1337);
+    adam.findMin(squad, x0);
+    assert(nprobed == niter);
+
+    for (const auto ddmode : {DDMode::SGDM, DDMode::ADAG, DDMode::RMSP}) {
+        DynamicDescent dd(ndim, ddmode, false, (ddmode == DDMode::ADAG) ? 0.1 : 0.01);
+        dd.disableStopping();
+        dd.setMaxNIterations(niter);
+        dd.setLazyUpdates(true);
+        dd.setPolicy(probe);
+        xprev.clear();
+        nprobed = 0;
+        squad.rgen.seed(1337);
+        dd.findMin(squad, x0);
+        assert(nprobed == niter);
+    }
+
+    // with averaging, the positions are kept
+    DynamicDescent ddavg(ndim, DDMode::ADAG, true, 0.1);
+    ddavg.disableStopping();
+    ddavg.setMaxNIterations(niter);
+    ddavg.setLazyUpdates(true);
+    squad.rgen.seed(1337);
+    ddavg.findMin(squad, x0);
+    assert(ddavg.getOldValues().back().getNDim() == ndim);
+    assert(maxDistToMin(ddavg.getX()) < 0.05);
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include "nfm/Adam.hpp"
+#include "nfm/DynamicDescent.hpp"
+#include "nfm/IRENE.hpp"
+#include "nfm/LogManager.hpp"
+#include "nfm/StateBuffer.hpp"
+
+#include "TestNFMFunctions.hpp"
+
+int main()
+{
+    using namespace std;
+    using namespace nfm;
+
+    LogManager::setLoggingOff();
+
+    const auto precs = {StatePrecision::Double, StatePrecision::Float, StatePrecision::BF16, StatePrecision::Q8};
+
+    // --- StateBuffer
+    const size_t n = 1000; // last block is partial
+    std::vector<double> vals(n), out;
+    for (size_t i = 0; i < n; ++i) { vals[i] = sin(0.1*i)*exp(-0.005*i); }
+    vals[300] = 0.;
+
+    for (const auto prec : precs) {
+        StateBuffer sbuf(n, prec), sbufnn(n, prec, true);
+        assert(sbuf.size() == n);
+        assert(sbuf.getPrecision() == prec);
+        sbuf.get(out);
+        for (const double o : out) { assert(o == 0.); }
+
+        sbuf.set(vals);
+        sbuf.get(out);
+        const double tol = (prec == StatePrecision::Double) ? 0. : (prec == StatePrecision::Float) ? 1e-7 : 4e-3;
+        for (size_t i = 0; i < n; ++i) {
+            if (prec == StatePrecision::Q8) { // error of (stochastically rounded) companded values is below 2*sqrt(|x|*absmax)/127 (absmax <= 1 here)
+                assert(fabs(out[i] - vals[i]) <= 2e-2*sqrt(fabs(vals[i])) + 1e-4);
+            }
+            else {
+                assert(fabs(out[i] - vals[i]) <= tol*fabs(vals[i]));
+            }
+            assert((out[i] == 0.) == (vals[i] == 0.) || prec == StatePrecision::Q8); // Q8 may round tiny values to 0
+        }
+
+        // non-negative buffers don't round small values to 0
+        std::vector<double> sq(n);
+        for (size_t i = 0; i < n; ++i) { sq[i] = vals[i]*vals[i]; }
+        sbufnn.set(sq);
+        sbufnn.get(out);
+        for (size_t i = 0; i < n; ++i) {
+            assert(out[i] >= 0.);
+            assert((out[i] > 0.) == (sq[i] > 0.));
+        }
+
+        // block-wise update over split index ranges covers every element once
+        updateBlockwise<2>({&sbuf, &sbufnn}, 0, 500, [](size_t, size_t len, const std::array<double *, 2> &b) { for (size_t i = 0; i < len; ++i) { b[0][i] = 1.; b[1][i] += 1.; }});
+        updateBlockwise<2>({&sbuf, &sbufnn}, 500, n, [](size_t, size_t len, const std::array<double *, 2> &b) { for (size_t i = 0; i < len; ++i) { b[0][i] = 1.; b[1][i] += 1.; }});
+        sbuf.get(out);
+        for (const double o : out) { assert(o == 1.); }
+    }
+
+    // memory usage
+    assert(StateBuffer(n, StatePrecision::Double).getNBytes() == 8*n);
+    assert(StateBuffer(n, StatePrecision::Float).getNBytes() == 4*n);
+    assert(StateBuffer(n, StatePrecision::BF16).getNBytes() == 2*n);
+    assert(StateBuffer(n, StatePrecision::Q8).getNBytes() == n + 4*4 + 4*4);
+
+    // Q8: repeated decay of small values is not lost to rounding, while the block maximum stays 1
+    StateBuffer mom(n, StatePrecision::Q8), mom2(n, StatePrecision::Q8, true);
+    std::vector<double> init(n, 0.5);
+    init[0] = 1.;
+    mom.set(init);
+    mom2.set(init);
+    for (int it = 0; it < 10000; ++it) {
+        updateBlockwise<2>({&mom, &mom2}, 0, n, [](size_t, size_t len, const std::array<double *, 2> &b)
+        {
+            for (size_t i = 1; i < len; ++i) {
+                b[0][i] *= 0.9; // like momentum
+                b[1][i] *= 0.999; // like second moment
+            }
+            b[0][0] = 1.; // keep the scale
+            b[1][0] = 1.;
+        });
+    }
+    mom.get(out);
+    for (size_t i = 1; i < n; ++i) {
+        if (i%StateBuffer::blockSize != 0) { assert(out[i] == 0.); } // decayed to 0 (exact 0.5*0.9^10000)
+    }
+    mom2.get(out);
+    for (size_t i = 1; i < n; ++i) {
+        if (i%StateBuffer::blockSize != 0) { assert(out[i] > 0. && out[i] < 1e-3); } // exact 0.5*0.999^10000 = 2.3e-5
+    }
+
+    // --- Optimizers converge with compressed state
+    const int ndim = 1000;
+    LargeQuad lquad(ndim);
+    const std::vector<double> x0(ndim, 0.);
+
+    for (const auto prec : precs) {
+        Adam adam(ndim, false, 0.01);
+        adam.setStatePrecision(prec);
+        assert(adam.getStatePrecision() == prec);
+        adam.disableStopping();
+        adam.setMaxNIterations(2000);
+        adam.findMin(lquad, x0);
+        assert(maxDistToMin(adam.getX()) < 0.01);
+
+        adam.setAveraging(true);
+        adam.setBeta2(0.99); // shorter averaging window
+        adam.findMin(lquad, x0);
+        assert(maxDistToMin(adam.getX()) < 0.01);
+
+        for (const auto ddmode : {DDMode::SGDM, DDMode::ADAD, DDMode::RMSP, DDMode::NEST}) {
+            DynamicDescent dd(ndim, ddmode, false, (ddmode == DDMode::RMSP) ? 0.001 : 0.01);
+            dd.setStatePrecision(prec);
+            dd.disableStopping();
+            dd.setMaxNIterations(2000);
+            dd.findMin(lquad, x0);
+            assert(maxDistToMin(dd.getX()) < 0.01);
+        }
+
+        IRENE irene(ndim, 0.3);
+        irene.setBeta(0.5);
+        irene.setStatePrecision(prec);
+        irene.setMaxNIterations(500);
+        irene.findMin(lquad, x0);
+        assert(maxDistToMin(irene.getX()) < 1e-3);
+    }
+
+    return 0;
+}
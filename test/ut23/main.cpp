@@ -0,0 +1,98 @@
+#include <cassert>
+#include <cmath>
+#include <random>
+
+#include "nfm/Lion.hpp"
+#include "nfm/LogManager.hpp"
+
+#include "TestNFMFunctions.hpp"
+
+// f = sum_{i < nact} (x_i - 1)^2 , i.e. the remaining coordinates are flat,
+// with gaussian noise of width sigma on the gradient (and provided gradient errors)
+class NoisyPartialQuad: public nfm::NoisyFunctionWithGradient
+{
+private:
+    std::mt19937_64 _rgen{1};
+    std::normal_distribution<double> _rd{0., 1.};
+    const int _nact;
+    const double _sigma;
+
+public:
+    NoisyPartialQuad(int ndim, int nact, double sigma): nfm::NoisyFunctionWithGradient(ndim, true), _nact(nact), _sigma(sigma) {}
+
+    nfm::NoisyValue f(const std::vector<double> &x) override
+    {
+        double y = 0.;
+        for (int i = 0; i < _nact; ++i) { y += (x[i] - 1.)*(x[i] - 1.); }
+        return {y + _sigma*_rd(_rgen), _sigma};
+    }
+
+    void grad(const std::vector<double> &x, nfm::NoisyGradient &grad) override
+    {
+        for (int i = 0; i < _ndim; ++i) {
+            const double g = (i < _nact) ? -2.*(x[i] - 1.) : 0.;
+            grad.set(i, {g + _sigma*_rd(_rgen), _sigma});
+        }
+    }
+};
+
+// mean absolute displacement of the flat coordinates (starting at 0)
+double flatDrift(const std::vector<double> &x, int nact)
+{
+    double drift = 0.;
+    for (size_t i = nact; i < x.size(); ++i) { drift += fabs(x[i]); }
+    return drift/(x.size() - nact);
+}
+
+int main()
+{
+    using namespace std;
+    using namespace nfm;
+
+    LogManager::setLoggingOff();
+
+    // --- noiseless F3D (gradient errors are tiny)
+    F3D f3d;
+    Lion lion(f3d.getNDim(), true, 0.01);
+    assert(lion.usesAveraging());
+    assert(lion.usesNoisyFreeze());
+    lion.setMaxNConstValues(50);
+    lion.setMaxNIterations(1000);
+    lion.setX(0, -2.);
+    lion.setX(1, 1.);
+    lion.setX(2, 0.);
+    NoisyIOPair opt = lion.findMin(f3d);
+    assert(fabs(opt.x[0] - 1.0) < 0.1);
+    assert(fabs(opt.x[1] + 1.5) < 0.1);
+    assert(fabs(opt.x[2] - 0.5) < 0.1);
+
+    // --- noisy gradients with flat directions
+    const int ndim = 100, nact = 50;
+    const std::vector<double> x0(ndim, 0.);
+    NoisyPartialQuad npq(ndim, nact, 0.2);
+
+    Lion lion2(ndim, true, 0.002);
+    lion2.disableStopping();
+    lion2.setMaxNIterations(2000);
+    lion2.setMaxNConstValues(100); // length of the averaging window
+
+    lion2.setNoisyFreeze(false);
+    lion2.findMin(npq, x0);
+    const double driftRaw = flatDrift(lion2.getX(), nact);
+
+    NoisyValue::setSigmaLevel(2.); // freeze more reliably
+    lion2.setNoisyFreeze(true);
+    lion2.findMin(npq, x0);
+    const double driftFrozen = flatDrift(lion2.getX(), nact);
+    for (int i = 0; i < nact; ++i) { assert(fabs(lion2.getX(i) - 1.) < 0.05); }
+    assert(driftFrozen < 0.5*driftRaw); // unresolved coordinates mostly stay put
+
+    // with 8-bit quantized momentum
+    lion2.setStatePrecision(StatePrecision::Q8);
+    lion2.findMin(npq, x0);
+    for (int i = 0; i < nact; ++i) { assert(fabs(lion2.getX(i) - 1.) < 0.05); }
+    assert(flatDrift(lion2.getX(), nact) < 0.5*driftRaw);
+    NoisyValue::setSigmaLevel(); // reset to default
+
+    return 0;
+}
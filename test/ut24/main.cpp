@@ -0,0 +1,125 @@
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "nfm/Adam.hpp"
+#include "nfm/LogManager.hpp"
+#include "nfm/ParamLayout.hpp"
+
+#include "TestNFMFunctions.hpp"
+
+// A "model" with a rows x cols weight matrix W followed by a bias vector b of length rows:
+// f = 0.5 * sum_rc p_r*q_c*(W_rc - 1)^2 + 0.5 * sum_r (b_r - 1)^2 , i.e. rank-1 curvature for W
+class MatrixQuad: public nfm::NoisyFunctionWithGradient
+{
+public:
+    const int rows, cols;
+
+    MatrixQuad(int nrows, int ncols): nfm::NoisyFunctionWithGradient(nrows*ncols + nrows, false), rows(nrows), cols(ncols) {}
+
+    static double p(int r) { return 1. + r%3; }
+    static double q(int c) { return 1. + 0.5*(c%4); }
+
+    nfm::NoisyValue f(const std::vector<double> &x) override
+    {
+        double y = 0.;
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < cols; ++c) { y += 0.5*p(r)*q(c)*pow(x[r*cols + c] - 1., 2); }
+            y += 0.5*pow(x[rows*cols + r] - 1., 2);
+        }
+        return {y, 0.};
+    }
+
+    void grad(const std::vector<double> &x, nfm::NoisyGradient &grad) override
+    {
+        for (int r = 0; r < rows; ++r) {
+            for (int c = 0; c < cols; ++c) { grad.val[r*cols + c] = -p(r)*q(c)*(x[r*cols + c] - 1.); }
+            grad.val[rows*cols + r] = -(x[rows*cols + r] - 1.);
+        }
+    }
+};
+
+template <class F>
+bool throws(F &&fn)
+{
+    try { fn(); }
+    catch (const std::invalid_argument &) { return true; }
+    return false;
+}
+
+int main()
+{
+    using namespace std;
+    using namespace nfm;
+
+    LogManager::setLoggingOff();
+
+    const int rows = 30, cols = 40;
+    MatrixQuad mquad(rows, cols);
+    const int ndim = mquad.getNDim();
+
+    // --- ParamLayout
+    ParamLayout layout;
+    layout.addMatrix(rows, cols);
+    layout.addVector(rows);
+    assert(layout.getSize() == ndim);
+    assert(layout.getNBlocks() == 2);
+    assert(layout.getBlock(1).offset == rows*cols);
+    assert(layout.getBlock(0).isMatrix() && !layout.getBlock(1).isMatrix());
+    assert(layout.getNMatrixElements() == rows*cols);
+    assert(throws([&]() { layout.addMatrix(0, 2); }));
+    assert(throws([&]() { layout.addVector(-1); }));
+
+    Adam adam(ndim, false, 0.01);
+    assert(adam.getParamLayout().getNBlocks() == 1); // default is one vector
+    assert(throws([&]() { adam.setParamLayout(ParamLayout(ndim + 1)); }));
+    adam.setParamLayout(layout);
+    assert(adam.getParamLayout().getNBlocks() == 2);
+
+    const std::vector<double> x0(ndim, 0.);
+    adam.disableStopping();
+
+    // without matrix blocks, factoring changes nothing
+    Adam adamv(ndim, false, 0.01);
+    adamv.disableStopping();
+    adamv.setMaxNIterations(100);
+    adamv.findMin(mquad, x0);
+    const std::vector<double> xfull = adamv.getX();
+    adamv.setFactoredSecondMoment(true);
+    adamv.findMin(mquad, x0);
+    assert(adamv.getX() == xfull);
+
+    // for rank-1 squared gradients (as in x0), factored and full second moments are equal
+    adam.setEpsilon(0.); // else the first step breaks the rank-1 structure slightly
+    adam.setMaxNIterations(3);
+    adam.findMin(mquad, x0);
+    const std::vector<double> xfull1 = adam.getX();
+    adam.setFactoredSecondMoment(true);
+    assert(adam.usesFactoredSecondMoment());
+    adam.findMin(mquad, x0);
+    for (int i = 0; i < ndim; ++i) { assert(fabs(adam.getX(i) - xfull1[i]) < 1e-12); }
+
+    // convergence, also with averaging and parallel execution
+    adam.setEpsilon(1.e-8);
+    adam.setMaxNIterations(2000);
+    adam.findMin(mquad, x0);
+    assert(maxDistToMin(adam.getX()) < 0.01);
+    const std::vector<double> xfact = adam.getX();
+
+    adam.setNThreads(3);
+    adam.setParallelThreshold(100);
+    adam.findMin(mquad, x0);
+    assert(adam.getX() == xfact); // element-wise update, independent of chunking
+
+    adam.setAveraging(true);
+    adam.setBeta2(0.99);
+    adam.findMin(mquad, x0);
+    assert(maxDistToMin(adam.getX()) < 0.01);
+
+    // unsupported combinations
+    adam.setAMSGrad(true);
+    assert(throws([&]() { adam.findMin(mquad, x0); }));
+
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <cassert>
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "nfm/Adam.hpp"
+#include "nfm/DynamicDescent.hpp"
+#include "nfm/LogManager.hpp"
+#include "nfm/MappedAllocator.hpp"
+#include "nfm/StateBuffer.hpp"
+
+#include "TestNFMFunctions.hpp"
+
+// number of mapped (deleted) state files of this process (-1 if unknown)
+int countMappedStateFiles()
+{
+#ifdef __linux__
+    std::ifstream maps("/proc/self/maps");
+    std::string line;
+    int count = 0;
+    while (std::getline(maps, line)) { count += (line.find("nfm_state") != std::string::npos) ? 1 : 0; }
+    return count;
+#else
+    return -1;
+#endif
+}
+
+int main()
+{
+    using namespace std;
+    using namespace nfm;
+
+    LogManager::setLoggingOff();
+
+    const std::string mapDir = ".";
+
+    // --- MappedAllocator
+    {
+        std::vector<double, MappedAllocator<double>> small(10, 1., MappedAllocator<double>(mapDir)); // heap (too small)
+        std::vector<double, MappedAllocator<double>> large(100000, 2., MappedAllocator<double>(mapDir));
+        assert(small[9] == 1. && large[99999] == 2.);
+        const int nfiles = countMappedStateFiles();
+        assert(nfiles == 1 || nfiles == -1);
+    }
+    assert(countMappedStateFiles() <= 0); // unmapped again
+
+    // --- StateBuffer
+    const size_t n = 50000;
+    std::vector<double> vals(n), out;
+    for (size_t i = 0; i < n; ++i) { vals[i] = sin(0.01*i); }
+    for (const auto prec : {StatePrecision::Double, StatePrecision::Q8}) {
+        StateBuffer sbuf(n, prec, false, mapDir), sbufRef(n, prec);
+        assert(sbuf.isMapped() && !sbufRef.isMapped());
+        sbuf.set(vals);
+        sbufRef.set(vals);
+        sbuf.get(out);
+        std::vector<double> outRef;
+        sbufRef.get(outRef);
+        assert(out == outRef);
+    }
+
+    // --- Optimizers with memory-mapped state give identical results
+    const int ndim = 20000;
+    LargeQuad lquad(ndim);
+    const std::vector<double> x0(ndim, 0.);
+
+    Adam adam(ndim, true, 0.01);
+    adam.setMaxNIterations(200);
+    adam.findMin(lquad, x0);
+    const std::vector<double> xadam = adam.getX();
+    adam.setStateMemoryMapping(mapDir);
+    assert(adam.getStateMemoryMapping() == mapDir);
+    adam.findMin(lquad, x0);
+    assert(adam.getX() == xadam);
+
+    DynamicDescent dd(ndim, DDMode::ADAD);
+    dd.setMaxNIterations(200);
+    dd.setStatePrecision(StatePrecision::BF16);
+    dd.findMin(lquad, x0);
+    const std::vector<double> xdd = dd.getX();
+    dd.setStateMemoryMapping(mapDir);
+    dd.findMin(lquad, x0);
+    assert(dd.getX() == xdd);
+
+    return 0;
+}
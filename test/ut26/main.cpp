@@ -0,0 +1,183 @@
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "nfm/Adam.hpp"
+#include "nfm/ConjGrad.hpp"
+#include "nfm/DynamicDescent.hpp"
+#include "nfm/FIRE.hpp"
+#include "nfm/IRENE.hpp"
+#include "nfm/Lion.hpp"
+#include "nfm/LogManager.hpp"
+
+#include "TestNFMFunctions.hpp"
+
+const char * const CKPT_PATH = "ut26_checkpoint.bin";
+const char * const CKPT_PATH2 = "ut26_checkpoint2.bin";
+
+long fileSize(const char * path)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    return static_cast<long>(file.tellg());
+}
+
+// Checks that an optimizer interrupted after nstop iterations (by policy) and continued by a new one
+// from the last checkpoint (written every nevery iterations) ends like the uninterrupted run.
+template <class MakeOpt>
+void checkResume(MakeOpt makeOpt, nfm::NoisyFunction &fun, const std::vector<double> &x0, int nstop, int nevery)
+{
+    using namespace nfm;
+
+    checkSameResult(makeOpt, [&](MakeOpt mk)
+    {
+        std::remove(CKPT_PATH);
+        auto opt1 = mk();
+        opt1->setCheckpointing(CKPT_PATH, nevery);
+        opt1->setPolicy([nstop](NFM &nfm, NoisyFunction &) { return nfm.getIter() >= nstop; });
+        opt1->findMin(fun, x0);
+        assert(opt1->getIter() < opt1->getMaxNIterations()); // was interrupted
+        assert(std::ifstream(CKPT_PATH).good()); // checkpoint was written
+
+        auto opt2 = mk();
+        opt2->loadCheckpoint(CKPT_PATH);
+        opt2->findMin(fun); // continue
+        return opt2;
+    }, fun, x0);
+}
+
+int main()
+{
+    using namespace std;
+    using namespace nfm;
+
+    LogManager::setLoggingOff();
+
+    const int ndim = 300; // more than one state buffer block
+    ScaledQuartQuad lquart(ndim, 1., 0., 1.e-4, 1.e-3); // scaled quartic with constant errors
+    const vector<double> x0(ndim, 0.);
+
+    // --- Adam (with averaging, also with 8-bit states)
+    for (const auto prec : {StatePrecision::Double, StatePrecision::Q8}) {
+        checkResume([prec]()
+                    {
+                        unique_ptr<Adam> adam(new Adam(ndim, true, 0.01));
+                        adam->disableStopping();
+                        adam->setMaxNIterations(100);
+                        adam->setStatePrecision(prec);
+                        return adam;
+                    }, lquart, x0, 45, 10);
+    }
+
+    // --- Loaded states are converted to the configured precision
+    for (const auto prec : {StatePrecision::Double, StatePrecision::Q8}) {
+        auto makeAdam = [](StatePrecision statePrec, const char * path)
+        {
+            unique_ptr<Adam> adam(new Adam(ndim, true, 0.01));
+            adam->disableStopping();
+            adam->setStatePrecision(statePrec);
+            adam->setCheckpointing(path, 10);
+            return adam;
+        };
+        std::remove(CKPT_PATH);
+        auto adam1 = makeAdam((prec == StatePrecision::Q8) ? StatePrecision::Double : StatePrecision::Q8, CKPT_PATH);
+        adam1->setMaxNIterations(40);
+        adam1->findMin(lquart, x0);
+        const long size1 = fileSize(CKPT_PATH);
+
+        std::remove(CKPT_PATH2);
+        auto adam2 = makeAdam(prec, CKPT_PATH2);
+        adam2->setMaxNIterations(40);
+        adam2->findMin(lquart, x0);
+        const long size2 = fileSize(CKPT_PATH2);
+        assert(size2 != size1);
+
+        auto adam3 = makeAdam(prec, CKPT_PATH2); // continues the checkpoint of adam1
+        adam3->setMaxNIterations(100);
+        adam3->loadCheckpoint(CKPT_PATH);
+        adam3->findMin(lquart);
+        assert(adam3->getIter() > adam1->getIter() && adam3->getF() < adam1->getF());
+        assert(fileSize(CKPT_PATH2) == size2); // written with the configured precision
+    }
+    std::remove(CKPT_PATH2);
+
+    // --- DynamicDescent (AdaDelta, with averaging over a wrapped old value list)
+    checkResume([]()
+                {
+                    unique_ptr<DynamicDescent> dd(new DynamicDescent(ndim, DDMode::ADAD, true, 0.01));
+                    dd->disableStopping();
+                    dd->setMaxNConstValues(7);
+                    dd->setMaxNIterations(100);
+                    return dd;
+                }, lquart, x0, 45, 10);
+
+    // --- Lion
+    checkResume([]()
+                {
+                    unique_ptr<Lion> lion(new Lion(ndim, true, 0.01));
+                    lion->disableStopping();
+                    lion->setMaxNConstValues(10);
+                    lion->setMaxNIterations(100);
+                    return lion;
+                }, lquart, x0, 45, 10);
+
+    // --- FIRE (2.0) and IRENE
+    checkResume([]()
+                {
+                    unique_ptr<FIRE> fire(new FIRE(ndim, 0.5));
+                    fire->useFIRE2();
+                    fire->disableStopping();
+                    fire->setMaxNIterations(100);
+                    return fire;
+                }, lquart, x0, 45, 10);
+
+    checkResume([]()
+                {
+                    unique_ptr<IRENE> irene(new IRENE(ndim, 0.5));
+                    irene->setBeta(0.5);
+                    irene->disableStopping();
+                    irene->setMaxNIterations(100);
+                    return irene;
+                }, lquart, x0, 45, 10);
+
+    // --- ConjGrad (Polak-Ribiere)
+    checkResume([]()
+                {
+                    unique_ptr<ConjGrad> cg(new ConjGrad(ndim, CGMode::CGPR));
+                    cg->setMaxNIterations(20);
+                    return cg;
+                }, lquart, x0, 5, 3);
+
+    // --- Mismatching checkpoints and unsupported modes
+    F3D f3d;
+    FIRE fire(ndim, 0.5);
+    bool thrown = false;
+    try { fire.loadCheckpoint(CKPT_PATH); } // contains ConjGrad state
+    catch (const invalid_argument &) { thrown = true; }
+    assert(thrown);
+
+    Adam adam(3, false, 0.01);
+    thrown = false;
+    try { adam.loadCheckpoint(CKPT_PATH); } // wrong dimension
+    catch (const invalid_argument &) { thrown = true; }
+    assert(thrown);
+
+    thrown = false;
+    try { adam.loadCheckpoint("ut26_does_not_exist.bin"); }
+    catch (const invalid_argument &) { thrown = true; }
+    assert(thrown);
+
+    adam.setLazyUpdates(true);
+    adam.setCheckpointing(CKPT_PATH, 10);
+    thrown = false;
+    try { adam.findMin(f3d); }
+    catch (const invalid_argument &) { thrown = true; }
+    assert(thrown);
+    adam.setCheckpointing("", 0); // disable
+    assert(adam.getCheckpointInterval() == 0);
+
+    std::remove(CKPT_PATH);
+    return 0;
+}
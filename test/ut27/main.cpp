@@ -0,0 +1,150 @@
+#include <cassert>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "nfm/Adam.hpp"
+#include "nfm/ConjGrad.hpp"
+#include "nfm/DynamicDescent.hpp"
+#include "nfm/FIRE.hpp"
+#include "nfm/LogManager.hpp"
+
+#include "TestNFMFunctions.hpp"
+
+int main()
+{
+    using namespace std;
+    using namespace nfm;
+
+    LogManager::setLoggingOff();
+
+    const int ndim = 300;
+    ScaledQuartQuad squad(ndim, 0., 1.); // scaled quadratic with adjustable center
+    const vector<double> x0(ndim, 0.);
+
+    // --- StateBuffer storage reuse and scaling
+    StateBuffer buf(ndim);
+    vector<double> vals(ndim, 2.);
+    buf.set(vals);
+    const double * data = buf.loadBlock(0, StateBuffer::blockSize, nullptr);
+    buf.scale(0.5);
+    buf.get(vals);
+    assert(vals[0] == 1. && vals[ndim - 1] == 1.);
+    buf.assign(ndim, StatePrecision::Double);
+    assert(buf.loadBlock(0, StateBuffer::blockSize, nullptr) == data); // storage was kept
+    buf.get(vals);
+    assert(vals[0] == 0. && vals[ndim - 1] == 0.);
+
+    // --- Adam: Two continued runs equal one uninterrupted run
+    auto makeAdam = []()
+    {
+        unique_ptr<Adam> adam(new Adam(ndim, false, 0.01));
+        adam->disableStopping();
+        adam->setMaxNIterations(100);
+        return adam;
+    };
+    unique_ptr<Adam> adamPtr;
+    checkSameResult(makeAdam, [&](decltype(makeAdam) mk)
+    {
+        adamPtr = mk();
+        adamPtr->setMaxNIterations(50);
+        adamPtr->setContinuation(true);
+        assert(adamPtr->usesContinuation() && adamPtr->getContinuationDecay() == 1.);
+        adamPtr->findMin(squad, x0); // nothing to continue yet
+        adamPtr->findMin(squad);
+        assert(adamPtr->getIter() == 51); // iteration count starts anew
+        return adamPtr.get();
+    }, squad, x0, false);
+    Adam &adam = *adamPtr;
+
+    // decay 0 is a cold start
+    Adam adamCold(ndim, false, 0.01);
+    adamCold.disableStopping();
+    adamCold.setMaxNIterations(50);
+    adamCold.findMin(squad, adam.getX());
+    adam.setContinuation(true, 0.);
+    adam.findMin(squad);
+    assert(adam.getX() == adamCold.getX());
+
+    // partial decay, on a changed target
+    adam.setContinuation(true, 0.5);
+    squad.c = 1.1;
+    adam.setMaxNIterations(1000);
+    adam.findMin(squad);
+    assert(maxDistToMin(adam.getX(), squad.c) < 1.e-3);
+    squad.c = 1.;
+
+    // --- DynamicDescent (SGDM): Two continued runs equal one uninterrupted run
+    auto makeDD = []()
+    {
+        unique_ptr<DynamicDescent> dd(new DynamicDescent(ndim, DDMode::SGDM, false, 0.01));
+        dd->disableStopping();
+        dd->setMaxNIterations(100);
+        return dd;
+    };
+    unique_ptr<DynamicDescent> ddPtr;
+    checkSameResult(makeDD, [&](decltype(makeDD) mk)
+    {
+        ddPtr = mk();
+        ddPtr->setMaxNIterations(50);
+        ddPtr->setContinuation(true);
+        ddPtr->findMin(squad, x0);
+        ddPtr->findMin(squad);
+        return ddPtr.get();
+    }, squad, x0, false);
+    DynamicDescent &dd = *ddPtr;
+
+    // mode change: state doesn't fit, so we start cold
+    dd.useRMSProp();
+    dd.findMin(squad);
+    assert(maxDistToMin(dd.getX(), squad.c) < 0.1);
+
+    // --- FIRE: Warm start after a small change of the target is faster than a cold start
+    FIRE fire(ndim, 0.3);
+    fire.setMaxNIterations(300);
+    fire.findMin(squad, x0);
+    const vector<double> xfire = fire.getX();
+
+    squad.c = 1.01;
+    FIRE fireCold(ndim, 0.3);
+    fireCold.setMaxNIterations(20);
+    fireCold.findMin(squad, xfire);
+
+    fire.setMaxNIterations(20);
+    fire.setContinuation(true, 0.);
+    fire.findMin(squad); // decay 0, equal to cold start
+    assert(fire.getX() == fireCold.getX());
+
+    fire.setContinuation(false);
+    fire.setMaxNIterations(300);
+    squad.c = 1.;
+    fire.findMin(squad, x0);
+    squad.c = 1.01;
+    fire.setMaxNIterations(20);
+    fire.setContinuation(true, 0.5); // keep dt, decay velocity
+    fire.findMin(squad);
+    assert(maxDistToMin(fire.getX(), squad.c) < maxDistToMin(fireCold.getX(), squad.c));
+    squad.c = 1.;
+
+    // --- ConjGrad: continue on a changed target
+    ConjGrad cg(ndim);
+    cg.setContinuation(true);
+    cg.findMin(squad, x0);
+    assert(maxDistToMin(cg.getX(), squad.c) < 1.e-3);
+    squad.c = 1.1;
+    squad.nrepeatedGrad = 0;
+    cg.findMin(squad);
+    assert(maxDistToMin(cg.getX(), squad.c) < 1.e-3);
+    assert(squad.nrepeatedGrad == 0); // the refreshed gradient starts the first step
+
+    // --- Unsupported mode
+    Adam adamLazy(ndim, false, 0.01);
+    adamLazy.setLazyUpdates(true);
+    adamLazy.setContinuation(true);
+    bool thrown = false;
+    try { adamLazy.findMin(squad, x0); }
+    catch (const invalid_argument &) { thrown = true; }
+    assert(thrown);
+
+    return 0;
+}
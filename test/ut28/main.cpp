@@ -0,0 +1,226 @@
+#include <cassert>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "nfm/Adam.hpp"
+#include "nfm/ConjGrad.hpp"
+#include "nfm/DynamicDescent.hpp"
+#include "nfm/FIRE.hpp"
+#include "nfm/IRENE.hpp"
+#include "nfm/LineSearch.hpp"
+#include "nfm/Lion.hpp"
+#include "nfm/LogManager.hpp"
+
+#include "TestNFMFunctions.hpp"
+
+// Answer a request of an ask/tell optimizer
+void serve(nfm::NFM &opt, const nfm::EvalRequest &req, nfm::NoisyFunctionWithGradient &fun, nfm::NoisyGradient &grad)
+{
+    if (!req.needsGrad) { opt.tell(fun.f(req.x)); }
+    else if (req.needsValue) {
+        const nfm::NoisyValue f = fun.fgrad(req.x, grad);
+        opt.tell(f, grad);
+    }
+    else {
+        fun.grad(req.x, grad);
+        opt.tell(grad);
+    }
+}
+
+// Compare ask/tell with findMin, for the optimizers created by makeOpt()
+template <class MakeOpt>
+void checkAskTell(MakeOpt makeOpt, nfm::NoisyFunctionWithGradient &fun, const std::vector<double> &x0)
+{
+    using namespace nfm;
+
+    checkSameResult(makeOpt, [&](MakeOpt mk)
+    {
+        auto opt = mk();
+        assert(opt->supportsAskTell());
+        opt->setX(x0);
+        opt->begin(fun.hasGradErr());
+        assert(opt->isRunning());
+        EvalRequest req;
+        NoisyGradient grad(fun.getNDim());
+        int nevals = 0;
+        while (opt->ask(req)) {
+            serve(*opt, req, fun, grad);
+            ++nevals;
+        }
+        assert(!opt->isRunning());
+        assert(nevals >= opt->getIter());
+        return opt;
+    }, fun, x0);
+}
+
+int main()
+{
+    using namespace std;
+    using namespace nfm;
+
+    LogManager::setLoggingOff();
+
+    const int ndim = 20;
+    ScaledQuartQuad qq(ndim, 1., 1., 1.e-6, 1.e-5); // scaled quartic+quadratic with constant errors
+    const vector<double> x0(ndim, 0.);
+
+    // --- Ask/tell gives the same results as findMin
+    auto makeAdam = []()
+    {
+        unique_ptr<Adam> adam(new Adam(ndim, true, 0.05));
+        adam->setMaxNIterations(200);
+        return adam;
+    };
+    auto makeDD = []()
+    {
+        unique_ptr<DynamicDescent> dd(new DynamicDescent(ndim, DDMode::RMSP, true, 0.01));
+        dd->setMaxNIterations(150);
+        return dd;
+    };
+    auto makeLion = []()
+    {
+        unique_ptr<Lion> lion(new Lion(ndim, true, 0.01));
+        lion->setMaxNIterations(150);
+        return lion;
+    };
+    auto makeFIRE = []()
+    {
+        unique_ptr<FIRE> fire(new FIRE(ndim, 0.1));
+        fire->useFIRE2();
+        fire->setMDIntegrator(md::Integrator::ForestRuth); // several force updates per step
+        fire->setMaxNIterations(100);
+        return fire;
+    };
+    auto makeIRENE = []()
+    {
+        unique_ptr<IRENE> irene(new IRENE(ndim, 0.1));
+        irene->setBeta(0.5);
+        irene->setMaxNIterations(150);
+        return irene;
+    };
+    auto makeCG = []()
+    {
+        unique_ptr<ConjGrad> cg(new ConjGrad(ndim, CGMode::CGPR));
+        cg->setBackStep(0.1); // also evaluate left of the start
+        cg->setMaxNIterations(30);
+        return cg;
+    };
+    checkAskTell(makeAdam, qq, x0);
+    checkAskTell(makeDD, qq, x0);
+    checkAskTell(makeLion, qq, x0);
+    checkAskTell(makeFIRE, qq, x0);
+    checkAskTell(makeIRENE, qq, x0);
+    checkAskTell(makeCG, qq, x0);
+
+    // --- Several optimizers with evaluations in flight at the same time
+    vector<unique_ptr<NFM>> opts, refs;
+    opts.emplace_back(makeAdam());
+    opts.emplace_back(makeFIRE());
+    opts.emplace_back(makeCG());
+    for (auto &opt : opts) {
+        opt->setX(x0);
+        opt->begin(true);
+    }
+    vector<EvalRequest> reqs(opts.size());
+    NoisyGradient grad(ndim);
+    bool anyRunning = true;
+    while (anyRunning) {
+        vector<bool> pending(opts.size());
+        for (size_t i = 0; i < opts.size(); ++i) { pending[i] = opts[i]->ask(reqs[i]); } // collect all requests
+        anyRunning = false;
+        for (size_t i = opts.size(); i-- > 0;) { // and answer them in a different order
+            if (pending[i]) {
+                serve(*opts[i], reqs[i], qq, grad);
+                anyRunning = true;
+            }
+        }
+    }
+    refs.emplace_back(makeAdam());
+    refs.emplace_back(makeFIRE());
+    refs.emplace_back(makeCG());
+    for (size_t i = 0; i < refs.size(); ++i) {
+        refs[i]->findMin(qq, x0);
+        assert(opts[i]->getX() == refs[i]->getX());
+        assert(opts[i]->getF() == refs[i]->getF());
+    }
+
+    // --- LineSearch object visits the same points as multiLineMin
+    MLMParams params = defaultMLMParams();
+    params.stepLeft = 0.1;
+    NoisyIOPair p0(ndim);
+    p0.x = x0;
+    p0.f = qq.f(p0.x);
+    NoisyGradient dir(ndim);
+    qq.grad(p0.x, dir);
+    const NoisyIOPair pmin = multiLineMin(qq, p0, dir.val, params);
+
+    LineSearch lsearch(p0.f, params);
+    double t;
+    vector<double> xt(ndim);
+    while (lsearch.nextPoint(t)) {
+        for (int i = 0; i < ndim; ++i) { xt[i] = p0.x[i] + t*dir.val[i]; }
+        lsearch.report(qq.f(xt));
+    }
+    assert(lsearch.isDone() && lsearch.isSuccess());
+    assert(lsearch.getResult().f == pmin.f);
+    for (int i = 0; i < ndim; ++i) { assert(p0.x[i] + lsearch.getResult().x*dir.val[i] == pmin.x[i]); }
+
+    // --- The user policy stops in ask/tell mode like in findMin
+    EvalRequest req;
+    for (auto &makeOpt : vector<function<unique_ptr<NFM>()>>{makeAdam, makeCG}) {
+        auto ref = makeOpt();
+        auto opt = makeOpt();
+        for (auto * o : {ref.get(), opt.get()}) { o->setPolicy([](NFM &nfm, NoisyFunction &) { return nfm.getIter() >= 5; }); }
+        ref->findMin(qq, x0);
+        assert(ref->getIter() < 10);
+        opt->setX(x0);
+        opt->begin(true);
+        while (opt->ask(req)) { serve(*opt, req, qq, grad); }
+        assert(opt->getIter() == ref->getIter());
+        assert(opt->getX() == ref->getX());
+    }
+
+    // the policy can't evaluate the target in ask/tell mode
+    auto adamEval = makeAdam();
+    adamEval->setPolicy([](NFM &nfm, NoisyFunction &fun) { return fun.f(nfm.getX()).val < 0.; });
+    adamEval->setX(x0);
+    adamEval->begin(true);
+    bool thrown = false;
+    try {
+        while (adamEval->ask(req)) { serve(*adamEval, req, qq, grad); }
+    }
+    catch (const invalid_argument &) { thrown = true; }
+    assert(thrown);
+
+    // --- Errors
+    Adam adam(ndim);
+    thrown = false;
+    try { adam.tell(NoisyValue{1., 0.}); } // nothing was requested
+    catch (const invalid_argument &) { thrown = true; }
+    assert(thrown);
+
+    assert(!adam.ask(req)); // not begun
+    adam.begin();
+    assert(adam.ask(req) && req.needsValue && req.needsGrad && req.x.size() == static_cast<size_t>(ndim));
+    thrown = false;
+    try { adam.tell(NoisyValue{1., 0.}); } // gradient is missing
+    catch (const invalid_argument &) { thrown = true; }
+    assert(thrown && adam.isRunning()); // the request is still pending
+
+    thrown = false;
+    try { adam.findMin(qq); } // already running
+    catch (const invalid_argument &) { thrown = true; }
+    assert(thrown);
+
+    Adam adamLazy(ndim);
+    adamLazy.setLazyUpdates(true);
+    assert(!adamLazy.supportsAskTell());
+    thrown = false;
+    try { adamLazy.begin(); }
+    catch (const invalid_argument &) { thrown = true; }
+    assert(thrown);
+
+    return 0;
+}
@@ -0,0 +1,158 @@
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "nfm/FunProjection1D.hpp"
+#include "nfm/LineSearch.hpp"
+#include "nfm/LogManager.hpp"
+
+#include "TestNFMFunctions.hpp"
+
+// 1D function (x - c)^2 + (x - c)^4 with adjustable center c
+class ShiftedWell: public nfm::NoisyFunction
+{
+public:
+    double c;
+
+    explicit ShiftedWell(double center): nfm::NoisyFunction(1), c(center) {}
+
+    nfm::NoisyValue f(const std::vector<double> &in) override
+    {
+        const double dx = in[0] - c;
+        return {dx*dx + dx*dx*dx*dx, 1.e-8};
+    }
+};
+
+// Drives all searches at once: In every round, collect the next point of every unfinished search,
+// then evaluate them (in reverse order, as if results arrived asynchronously) and report back.
+template <class SearchT, class EvalT>
+int driveConcurrently(std::vector<std::unique_ptr<SearchT>> &searches, EvalT evalAt)
+{
+    int nrounds = 0;
+    while (true) {
+        std::vector<std::pair<size_t, double>> pending;
+        double x;
+        for (size_t i = 0; i < searches.size(); ++i) {
+            if (searches[i]->nextPoint(x)) { pending.emplace_back(i, x); }
+        }
+        if (pending.empty()) { return nrounds; }
+        for (auto it = pending.rbegin(); it != pending.rend(); ++it) {
+            searches[it->first]->report(evalAt(it->first, it->second));
+        }
+        ++nrounds;
+    }
+}
+
+nfm::NoisyBracket prepareBracket(nfm::NoisyFunction &fun, const double ax, const double cx)
+{
+    nfm::NoisyBracket bracket{{ax, {}}, {0.5*(ax + cx), {}}, {cx, {}}};
+    std::vector<double> xvec(1);
+    for (nfm::NoisyIOPair1D * p : {&bracket.a, &bracket.b, &bracket.c}) {
+        xvec[0] = p->x;
+        p->f = fun(xvec);
+    }
+    return bracket;
+}
+
+int main()
+{
+    using namespace std;
+    using namespace nfm;
+
+    LogManager::setLoggingOff();
+
+    const int nsearch = 8;
+    vector<unique_ptr<ShiftedWell>> funs;
+    for (int i = 0; i < nsearch; ++i) { funs.emplace_back(new ShiftedWell(0.5*i - 1.)); }
+    auto evalAt = [&funs](size_t i, double x) { return (*funs[i])(vector<double>{x}); };
+
+    // --- Bracketing: concurrent searches equal the blocking findBracket
+    vector<NoisyBracket> brackets;
+    vector<unique_ptr<BracketSearch>> bsearches;
+    for (int i = 0; i < nsearch; ++i) {
+        brackets.push_back(prepareBracket(*funs[i], -2., -1.5)); // the minimum is on the right
+        bsearches.emplace_back(new BracketSearch(brackets.back(), 20));
+    }
+    assert(driveConcurrently(bsearches, evalAt) > 0);
+
+    for (int i = 0; i < nsearch; ++i) {
+        const bool success = findBracket(*funs[i], brackets[i], 20);
+        assert(bsearches[i]->isDone());
+        assert(bsearches[i]->isSuccess() == success);
+        assert(bsearches[i]->getBracket().a.x == brackets[i].a.x);
+        assert(bsearches[i]->getBracket().b.x == brackets[i].b.x);
+        assert(bsearches[i]->getBracket().c.x == brackets[i].c.x);
+        assert(success);
+    }
+
+    // --- Brent: concurrent searches equal the blocking brentMin
+    vector<unique_ptr<BrentSearch>> msearches;
+    for (int i = 0; i < nsearch; ++i) { msearches.emplace_back(new BrentSearch(brackets[i], 50)); }
+    driveConcurrently(msearches, evalAt);
+
+    for (int i = 0; i < nsearch; ++i) {
+        const NoisyIOPair1D res = brentMin(*funs[i], brackets[i], 50);
+        assert(msearches[i]->isDone());
+        assert(msearches[i]->getResult().x == res.x);
+        assert(msearches[i]->getResult().f.val == res.f.val);
+        assert(fabs(res.x - funs[i]->c) < 1.e-3);
+    }
+
+    // --- Multi-dim line search: concurrent searches along different directions equal multiLineMin
+    F3D f3d;
+    const vector<double> x0{1., 2., 3.};
+    NoisyIOPair p0(3);
+    p0.x = x0;
+    p0.f = f3d.f(x0);
+    vector<vector<double>> dirs{{-1., 0., 0.}, {0., -1., 0.}, {0., 0., -1.}, {-0.5, -1., -1.5}};
+    vector<unique_ptr<FunProjection1D>> projs;
+    vector<unique_ptr<LineSearch>> lsearches;
+    for (const auto &dir : dirs) {
+        projs.emplace_back(new FunProjection1D(&f3d, x0, dir));
+        lsearches.emplace_back(new LineSearch(p0.f));
+    }
+    driveConcurrently(lsearches, [&projs](size_t i, double t) { return (*projs[i])(t); });
+
+    for (size_t i = 0; i < dirs.size(); ++i) {
+        const NoisyIOPair res = multiLineMin(f3d, p0, dirs[i]);
+        assert(lsearches[i]->isDone());
+        assert(lsearches[i]->getResult().f.val == res.f.val);
+        if (lsearches[i]->isSuccess()) {
+            vector<double> x(3);
+            projs[i]->getVecFromX(lsearches[i]->getResult().x, x);
+            assert(x == res.x);
+        }
+        else {
+            assert(res.x == x0);
+        }
+    }
+    assert(lsearches[3]->isSuccess() && lsearches[3]->getResult().f < p0.f);
+
+    // --- Reporting to finished searches throws
+    bool thrown = false;
+    try { bsearches[0]->report({0., 0.}); }
+    catch (const invalid_argument &) { thrown = true; }
+    assert(thrown);
+
+    thrown = false;
+    try { msearches[0]->report({0., 0.}); }
+    catch (const invalid_argument &) { thrown = true; }
+    assert(thrown);
+
+    thrown = false;
+    try { lsearches[0]->report({0., 0.}); }
+    catch (const invalid_argument &) { thrown = true; }
+    assert(thrown);
+
+    // invalid line search steps
+    thrown = false;
+    MLMParams params = defaultMLMParams();
+    params.stepRight = 0.;
+    try { LineSearch ls(p0.f, params); }
+    catch (const invalid_argument &) { thrown = true; }
+    assert(thrown);
+
+    return 0;
+}
@@ -0,0 +1,179 @@
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+#include "nfm/ConjGrad.hpp"
+#include "nfm/DynamicDescent.hpp"
+#include "nfm/LogManager.hpp"
+#include "nfm/MultiStart.hpp"
+
+// Tilted double well f = sum_i (x_i^2 - 1)^2 + 0.3*x_i , global minimum at x_i ~ -1.04
+// (local minima at x_i ~ 0.96), with optional noise (from an own random generator)
+class TiltedWell: public nfm::NoisyFunctionWithGradient
+{
+private:
+    std::mt19937_64 _rgen{1337};
+    std::normal_distribution<double> _rdist;
+    const double _sigma;
+
+public:
+    explicit TiltedWell(int ndim, double sigma = 0.): nfm::NoisyFunctionWithGradient(ndim, sigma > 0.), _sigma(sigma) {}
+
+    nfm::NoisyValue f(const std::vector<double> &x) override
+    {
+        double y = 0.;
+        for (int i = 0; i < _ndim; ++i) { y += (x[i]*x[i] - 1.)*(x[i]*x[i] - 1.) + 0.3*x[i]; }
+        if (_sigma > 0.) { y += _sigma*_rdist(_rgen); }
+        return {y, _sigma};
+    }
+
+    void grad(const std::vector<double> &x, nfm::NoisyGradient &gradv) override
+    {
+        for (int i = 0; i < _ndim; ++i) {
+            gradv.val[i] = -(4.*x[i]*(x[i]*x[i] - 1.) + 0.3);
+            if (_sigma > 0.) {
+                gradv.val[i] += _sigma*_rdist(_rgen);
+                gradv.err[i] = _sigma;
+            }
+        }
+    }
+};
+
+bool sameResults(const std::vector<nfm::MultiStartResult> &res1, const std::vector<nfm::MultiStartResult> &res2)
+{
+    if (res1.size() != res2.size()) { return false; }
+    for (size_t i = 0; i < res1.size(); ++i) {
+        if (res1[i].istart != res2[i].istart || res1[i].last.x != res2[i].last.x
+            || res1[i].last.f.val != res2[i].last.f.val || res1[i].niter != res2[i].niter) { return false; }
+    }
+    return true;
+}
+
+int main()
+{
+    using namespace std;
+    using namespace nfm;
+
+    LogManager::setLoggingOff();
+
+    // --- Sobol points
+    assert(sobolPoint(3, 1) == vector<double>({0.5, 0.5, 0.5}));
+    assert(sobolPoint(2, 2) == vector<double>({0.75, 0.25}));
+    assert(sobolPoint(2, 3) == vector<double>({0.25, 0.75}));
+
+    // the first 64 points are stratified in every dimension ...
+    vector<set<int>> cells(maxSobolDim);
+    set<int> cells2d;
+    for (int n = 0; n < 64; ++n) {
+        const vector<double> x = sobolPoint(maxSobolDim, n);
+        for (int i = 0; i < maxSobolDim; ++i) {
+            assert(x[i] >= 0. && x[i] < 1.);
+            cells[i].insert(static_cast<int>(64*x[i]));
+        }
+        cells2d.insert(8*static_cast<int>(8*x[0]) + static_cast<int>(8*x[1])); // ... and 8x8 squares in 2D
+    }
+    for (const auto &c : cells) { assert(c.size() == 64); }
+    assert(cells2d.size() == 64);
+
+    // --- Halton points
+    assert(haltonPoint(3, 1) == vector<double>({0.5, 1./3., 0.2}));
+    assert(haltonPoint(1, 5)[0] == 0.625); // 5 = 101 (base 2)
+    assert(haltonPoint(30, 7).size() == 30);
+
+    // --- Starting points within bounds
+    const int ndim = 2;
+    const vector<double> lbounds{-2., -1.5}, ubounds{2., 2.5};
+    auto makeCG = [ndim]()
+    {
+        unique_ptr<ConjGrad> cg(new ConjGrad(ndim, CGMode::CGPR));
+        cg->setMaxNIterations(50);
+        return unique_ptr<NFM>(std::move(cg));
+    };
+
+    MultiStart ms(lbounds, ubounds, makeCG);
+    assert(ms.getNDim() == ndim && ms.getNStarts() == 16 && ms.getStartSequence() == StartSequence::Sobol);
+    ms.setNStarts(20);
+    const auto x0s = ms.getStartingPoints();
+    assert(x0s.size() == 20);
+    assert(x0s[0] == vector<double>({0., 0.5})); // box center
+    for (const auto &x0 : x0s) {
+        for (int i = 0; i < ndim; ++i) { assert(x0[i] >= lbounds[i] && x0[i] < ubounds[i]); }
+    }
+    ms.setStartSequence(StartSequence::Halton);
+    assert(ms.getStartingPoints()[0] == vector<double>({0., -1.5 + (1./3.)*4.}));
+    ms.setStartSequence(StartSequence::Sobol);
+
+    // --- All runs, sorted by value, reproducible with threads
+    TiltedWell twell(ndim);
+    const auto results = ms.findMin(twell);
+    assert(results.size() == 20);
+    set<int> istarts;
+    for (size_t i = 0; i < results.size(); ++i) {
+        assert(results[i].flag_run && !results[i].flag_stopped);
+        assert(results[i].x0 == x0s[results[i].istart]);
+        if (i > 0) { assert(results[i - 1].last.f.val <= results[i].last.f.val); }
+        istarts.insert(results[i].istart);
+    }
+    assert(istarts.size() == 20);
+    assert(fabs(results[0].last.x[0] + 1.04) < 0.01 && fabs(results[0].last.x[1] + 1.04) < 0.01); // global minimum
+    assert(results.back().last.f.val > results[0].last.f.val + 0.5); // some runs end in local minima
+
+    ms.setNThreads(4);
+    assert(ms.getNThreads() == 4);
+    assert(sameResults(ms.findMin(twell), results));
+
+    // --- Noisy targets, one per run (the results don't depend on the thread count)
+    MultiStart msNoisy(lbounds, ubounds, [ndim]()
+    {
+        unique_ptr<DynamicDescent> dd(new DynamicDescent(ndim, DDMode::RMSP, true, 0.05));
+        dd->setMaxNIterations(100);
+        return unique_ptr<NFM>(std::move(dd));
+    });
+    msNoisy.setNStarts(8);
+    auto makeNoisy = [ndim]() { return unique_ptr<NoisyFunction>(new TiltedWell(ndim, 0.01)); };
+    const auto resNoisy = msNoisy.findMin(makeNoisy);
+    msNoisy.setNThreads(3);
+    assert(sameResults(msNoisy.findMin(makeNoisy), resNoisy));
+    assert(fabs(resNoisy[0].last.x[0] + 1.04) < 0.1 && fabs(resNoisy[0].last.x[1] + 1.04) < 0.1);
+
+    // --- Early stopping
+    ms.setNThreads(1);
+    ms.setTargetValue(10.); // every finished run is below
+    assert(ms.hasTargetValue() && ms.getTargetValue() == 10.);
+    const auto resStop = ms.findMin(twell);
+    assert(resStop.size() == 20);
+    assert(resStop[0].flag_run && resStop[0].istart == 0);
+    for (size_t i = 1; i < resStop.size(); ++i) { assert(!resStop[i].flag_run && resStop[i].istart == static_cast<int>(i)); }
+
+    ms.setNThreads(4);
+    const auto resStopPar = ms.findMin(twell);
+    assert(resStopPar[0].flag_run && !resStopPar.back().flag_run);
+
+    ms.setTargetValue(-10.); // never reached
+    assert(sameResults(ms.findMin(twell), results));
+    ms.clearTargetValue();
+    assert(!ms.hasTargetValue());
+
+    // --- Errors
+    bool thrown = false;
+    try { MultiStart msBad({0., 1.}, {1., 1.}, makeCG); } // empty interval
+    catch (const invalid_argument &) { thrown = true; }
+    assert(thrown);
+
+    thrown = false;
+    try { MultiStart msBad(vector<double>(30, 0.), vector<double>(30, 1.), makeCG); msBad.getStartingPoints(); }
+    catch (const invalid_argument &) { thrown = true; } // too many dimensions for Sobol
+    assert(thrown);
+
+    thrown = false;
+    MultiStart msWrongDim({0., 0., 0.}, {1., 1., 1.}, makeCG); // the optimizers are 2D
+    try { msWrongDim.findMin(twell); }
+    catch (const invalid_argument &) { thrown = true; } // thrown in run, rethrown by findMin
+    assert(thrown);
+
+    return 0;
+}
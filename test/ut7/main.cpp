@@ -7,6 +7,31 @@
 
 #include "TestNFMFunctions.hpp"
 
+// F3D counting the calls of fgrad
+class CountingF3D: public F3D
+{
+public:
+    int nfgrad = 0;
+
+    nfm::NoisyValue fgrad(const std::vector<double> &in, nfm::NoisyGradient &grad) override
+    {
+        ++nfgrad;
+        return F3D::fgrad(in, grad);
+    }
+};
+
+// number of fgrad calls of a FIRE run with nsteps MD steps and integrator mdi
+int countFGrad(nfm::md::Integrator mdi, int nsteps, const std::vector<double> &initpos)
+{
+    CountingF3D cf3d;
+    nfm::FIRE fire(cf3d.getNDim(), 0.1);
+    fire.setMDIntegrator(mdi);
+    fire.disableStopping();
+    fire.setMaxNIterations(nsteps);
+    fire.findMin(cf3d, initpos);
+    return cf3d.nfgrad;
+}
+
 int main()
 {
     using namespace std;
@@ -101,6 +126,58 @@ int main()
     assert(irene.getX(2) == fire2.getX(2));
     assert(irene.getX() == fire2.getX());
 
+    // --- Test further integrators
+
+    for (const auto mdi : {md::Integrator::EulerSI, md::Integrator::ForestRuth}) {
+        FIRE fire3(f3d.getNDim(), 1.);
+        fire3.setMDIntegrator(mdi);
+        fire3.findMin(f3d, initpos);
+
+        assert(fabs(fire3.getX(0) - 1.0) < 0.05);
+        assert(fabs(fire3.getX(1) + 1.5) < 0.05);
+        assert(fabs(fire3.getX(2) - 0.5) < 0.05);
+    }
+
+    // every MD step takes one target evaluation per force update
+    for (const auto mdi : {md::Integrator::EulerE, md::Integrator::EulerSI, md::Integrator::VerletV, md::Integrator::ForestRuth}) {
+        const int nupdates = (mdi == md::Integrator::ForestRuth) ? 3 : 1;
+        const int n10 = countFGrad(mdi, 10, initpos);
+        assert(countFGrad(mdi, 20, initpos) - n10 == 10*nupdates);
+        assert(n10 == 1 + 10*nupdates); // plus the initial force
+    }
+
+    // --- Test FIRE 2.0 (with recommended settings)
+
+    FIRE fire4(f3d.getNDim(), 1.);
+    fire4.useFIRE2();
+    fire4.setMDIntegrator(md::Integrator::EulerSI);
+    fire4.setAlpha0(0.25);
+    fire4.setNWait(20);
+    fire4.findMin(f3d, initpos);
+
+    assert(fabs(fire4.getX(0) - 1.0) < 0.05);
+    assert(fabs(fire4.getX(1) + 1.5) < 0.05);
+    assert(fabs(fire4.getX(2) - 0.5) < 0.05);
+
+    IRENE irene2(f3d.getNDim(), 1.);
+    irene2.useFIRE2();
+    irene2.setMDIntegrator(md::Integrator::EulerSI);
+    irene2.setAlpha0(0.25);
+    irene2.setNWait(20);
+    irene2.findMin(f3d, initpos);
+
+    assert(fabs(irene2.getX(0) - 1.0) < 0.05);
+    assert(fabs(irene2.getX(1) + 1.5) < 0.05);
+    assert(fabs(irene2.getX(2) - 0.5) < 0.05);
+
+    // FIRE 2.0 without initial delay
+    fire4.setInitialDelay(false);
+    fire4.findMin(f3d, initpos);
+
+    assert(fabs(fire4.getX(0) - 1.0) < 0.05);
+    assert(fabs(fire4.getX(1) + 1.5) < 0.05);
+    assert(fabs(fire4.getX(2) - 0.5) < 0.05);
+
 
     return 0;
 }
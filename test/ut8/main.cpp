@@ -0,0 +1,58 @@
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+#include "nfm/SR.hpp"
+#include "nfm/LogManager.hpp"
+
+#include "TestNFMFunctions.hpp"
+
+
+int main()
+{
+    using namespace std;
+    using namespace nfm;
+
+    LogManager::setLoggingOff();
+    //LogManager::setLoggingOn(true);
+
+    const std::vector<double> initpos{-2., 1., 0.};
+
+    // SR requires the overlap interface
+    F3D f3d;
+    SR sr(f3d.getNDim());
+    bool thrown = false;
+    try {
+        sr.findMin(f3d, initpos);
+    }
+    catch (const std::invalid_argument &) {
+        thrown = true;
+    }
+    assert(thrown);
+    assert(!sr.isRunning());
+
+    // with S equal to the Hessian, SR with full step is Newton-like
+    Quad3D quad;
+    sr.setStepSize(1.);
+    sr.findMin(quad, initpos);
+
+    assert(sr.getIter() < 10);
+    assert(fabs(sr.getX(0) - 1.0) < 0.001);
+    assert(fabs(sr.getX(1) + 1.5) < 0.001);
+    assert(fabs(sr.getX(2) - 0.5) < 0.001);
+
+    // larger, decaying diagonal shift and a single CG iteration per step
+    sr.setStepSize(0.5);
+    sr.setDiagShift(1.);
+    sr.setShiftDecay(0.5);
+    sr.setMinDiagShift(1.e-4);
+    sr.setMaxNCG(1);
+    sr.setMaxNIterations(500);
+    sr.findMin(quad, initpos);
+
+    assert(fabs(sr.getX(0) - 1.0) < 0.01);
+    assert(fabs(sr.getX(1) + 1.5) < 0.01);
+    assert(fabs(sr.getX(2) - 0.5) < 0.01);
+
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include <cassert>
+#include <cmath>
+
+#include "nfm/NelderMead.hpp"
+#include "nfm/LogManager.hpp"
+
+#include "TestNFMFunctions.hpp"
+
+// F3D which counts the number of (batch) evaluation calls
+class CountingF3D: public F3D
+{
+public:
+    int nf = 0;
+    int nbatch = 0;
+
+    nfm::NoisyValue f(const std::vector<double> &in) override
+    {
+        ++nf;
+        return F3D::f(in);
+    }
+
+    void fbatch(const std::vector<std::vector<double>> &xs, std::vector<nfm::NoisyValue> &fs) override
+    {
+        ++nbatch;
+        F3D::fbatch(xs, fs);
+    }
+};
+
+int main()
+{
+    using namespace std;
+    using namespace nfm;
+
+    LogManager::setLoggingOff();
+    //LogManager::setLoggingOn(true);
+
+    CountingF3D f3d;
+    const std::vector<double> initpos{-2., 1., 0.};
+
+    // default (batched) Nelder-Mead
+    NelderMead nm(f3d.getNDim(), 0.5);
+    nm.setMaxNIterations(2000);
+    nm.findMin(f3d, initpos);
+
+    assert(fabs(nm.getX(0) - 1.0) < 0.1);
+    assert(fabs(nm.getX(1) + 1.5) < 0.1);
+    assert(fabs(nm.getX(2) - 0.5) < 0.1);
+
+    // one batch for init, one per iteration plus the shrinks
+    assert(f3d.nbatch >= nm.getIter());
+    assert(f3d.nbatch <= 2*nm.getIter());
+    const int nf_batch = f3d.nf;
+
+    // serial variant evaluates less points
+    f3d.nf = 0;
+    f3d.nbatch = 0;
+    nm.setBatch(false);
+    nm.findMin(f3d, initpos);
+
+    assert(fabs(nm.getX(0) - 1.0) < 0.1);
+    assert(fabs(nm.getX(1) + 1.5) < 0.1);
+    assert(fabs(nm.getX(2) - 0.5) < 0.1);
+    assert(f3d.nf < nf_batch);
+
+    // adaptive parameters without re-evaluation of best vertex
+    nm.setBatch(true);
+    nm.setReevalBest(false);
+    nm.useAdaptiveParams();
+    nm.findMin(f3d, initpos);
+
+    assert(fabs(nm.getX(0) - 1.0) < 0.1);
+    assert(fabs(nm.getX(1) + 1.5) < 0.1);
+    assert(fabs(nm.getX(2) - 0.5) < 0.1);
+
+    return 0;
+}